@@ -37,6 +37,13 @@ void gorc::client::application::startup(event_bus &eventbus, content_manager &co
 
     register_verbs();
 
+    if(!input_cog_cache.empty()) {
+        cog_cache = std::make_unique<cog::script_cache>(input_cog_cache,
+                                                        components.verbs,
+                                                        components.constants);
+        components.services.add(*cog_cache);
+    }
+
     views.set_layer(view_layer::clear_screen, clear_view);
 
     // HACK: Set current episode to The Force Within.
@@ -89,6 +96,7 @@ void gorc::client::application::create_options(options &opts)
 {
     opts.insert(make_value_option("episode", input_episodename));
     opts.insert(make_value_option("level", input_levelname));
+    opts.insert(make_value_option("cog-cache", input_cog_cache));
 
     opts.emplace_constraint<required_option>(std::vector<std::string>{"episode", "level"});
     return;
@@ -6,6 +6,7 @@
 #include "presenter_mapper.hpp"
 #include "clear_screen_view.hpp"
 #include "places/action/action_view.hpp"
+#include "jk/cog/compiler/script_cache.hpp"
 #include "jk/vfs/jk_virtual_file_system.hpp"
 #include "game/level_state.hpp"
 #include "utility/service_registry.hpp"
@@ -34,6 +35,7 @@ private:
 public:
     std::string input_episodename;
     std::string input_levelname;
+    std::string input_cog_cache;
 
     jk_virtual_file_system& virtual_filesystem;
 
@@ -44,6 +46,7 @@ public:
     std::unique_ptr<action::action_view> action_view;
 
     game::level_state components;
+    std::unique_ptr<cog::script_cache> cog_cache;
 
     application(service_registry const &services);
     ~application();
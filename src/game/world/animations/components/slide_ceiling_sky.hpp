@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ecs/component_storage.hpp"
 #include "math/vector.hpp"
 #include "utility/uid.hpp"
 
@@ -12,6 +13,7 @@ namespace components {
 class slide_ceiling_sky {
 public:
     uid(573406198);
+    using component_storage = dense_component_storage;
 
     vector<2> speed;
 
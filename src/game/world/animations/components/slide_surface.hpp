@@ -1,6 +1,7 @@
 #pragma once
 
 #include "content/id.hpp"
+#include "ecs/component_storage.hpp"
 #include "math/vector.hpp"
 #include "utility/uid.hpp"
 
@@ -13,6 +14,7 @@ namespace components {
 class slide_surface {
 public:
     uid(3489289859);
+    using component_storage = dense_component_storage;
 
     surface_id surface;
     vector<3> direction;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "content/id.hpp"
+#include "ecs/component_storage.hpp"
 #include "utility/uid.hpp"
 
 namespace gorc {
@@ -12,6 +13,7 @@ namespace components {
 class surface_animation {
 public:
     uid(3376422445);
+    using component_storage = dense_component_storage;
 
     surface_id surface;
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "content/id.hpp"
+#include "ecs/component_storage.hpp"
 #include "libold/content/flags/anim_flag.hpp"
 #include "utility/flag_set.hpp"
 #include "utility/uid.hpp"
@@ -14,6 +15,7 @@ namespace components {
 class surface_light {
 public:
     uid(3679965837);
+    using component_storage = dense_component_storage;
 
     surface_id surface;
     float start_light, end_light, change_time, anim_time;
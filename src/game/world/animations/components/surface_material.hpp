@@ -1,6 +1,7 @@
 #pragma once
 
 #include "content/id.hpp"
+#include "ecs/component_storage.hpp"
 #include "libold/content/flags/anim_flag.hpp"
 #include "utility/flag_set.hpp"
 #include "utility/uid.hpp"
@@ -17,6 +18,7 @@ namespace components {
 class surface_material {
 public:
     uid(3174651231);
+    using component_storage = dense_component_storage;
 
     surface_id surface;
     double framerate;
@@ -4,6 +4,7 @@
 #include "jk/content/inventory.hpp"
 #include "player_bin.hpp"
 #include "utility/uid.hpp"
+#include "ecs/component_storage.hpp"
 
 namespace gorc {
 namespace game {
@@ -21,6 +22,7 @@ private:
 
 public:
     uid(58475947);
+    using component_storage = unique_component_storage;
 
     bool switching_weapons = false;
     int next_weapon;
@@ -3,6 +3,7 @@
 #include "key_mix_level_state.hpp"
 #include "content/id.hpp"
 #include "utility/uid.hpp"
+#include "ecs/component_storage.hpp"
 
 namespace gorc {
 namespace game {
@@ -12,6 +13,7 @@ namespace keys {
 class key_mix {
 public:
     uid(1237354);
+    using component_storage = unique_component_storage;
 
     key_mix_level_state high, low, body;
 
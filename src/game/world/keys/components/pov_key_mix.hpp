@@ -2,6 +2,7 @@
 
 #include "key_mix.hpp"
 #include "utility/uid.hpp"
+#include "ecs/component_storage.hpp"
 
 namespace gorc {
 namespace game {
@@ -11,6 +12,7 @@ namespace keys {
 class pov_key_mix : public key_mix {
 public:
     uid(54723968);
+    using component_storage = unique_component_storage;
 
     pov_key_mix();
 };
@@ -52,13 +52,15 @@ gorc::maybe<gorc::game::world::keys::key_mix const *>
                                                           bool is_pov) const
 {
     if(is_pov) {
-        for(auto &mix : levelModel->ecs.find_component<pov_key_mix>(tid)) {
-            return mix.second;
+        auto mix = levelModel->ecs.maybe_get_unique_component<pov_key_mix>(tid);
+        if(mix.has_value()) {
+            return mix.get_value();
         }
     }
     else {
-        for(auto &mix : levelModel->ecs.find_component<key_mix>(tid)) {
-            return mix.second;
+        auto mix = levelModel->ecs.maybe_get_unique_component<key_mix>(tid);
+        if(mix.has_value()) {
+            return mix.get_value();
         }
     }
 
@@ -202,14 +204,17 @@ void gorc::game::world::keys::key_presenter::update(const gorc::time& time) {
 
     // update animation frames
     for(auto &key : levelModel->ecs.all_components<key_state>()) {
+        thing_id mix_id = key.second->mix_id;
         if(key.second->is_pov_mix) {
-            for(auto &mix : levelModel->ecs.find_component<pov_key_mix>(key.second->mix_id)) {
-                update_key(mix.first, key.first, *key.second, *mix.second, dt);
+            auto mix = levelModel->ecs.maybe_get_unique_component<pov_key_mix>(mix_id);
+            if(mix.has_value()) {
+                update_key(mix_id, key.first, *key.second, *mix.get_value(), dt);
             }
         }
         else {
-            for(auto &mix : levelModel->ecs.find_component<key_mix>(key.second->mix_id)) {
-                update_key(mix.first, key.first, *key.second, *mix.second, dt);
+            auto mix = levelModel->ecs.maybe_get_unique_component<key_mix>(mix_id);
+            if(mix.has_value()) {
+                update_key(mix_id, key.first, *key.second, *mix.get_value(), dt);
             }
         }
     }
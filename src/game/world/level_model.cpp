@@ -6,7 +6,7 @@
 gorc::game::world::level_model::level_model(gorc::content_manager& content, service_registry const &svc,
         asset_ref<gorc::content::assets::level> level)
     : level(level), header(level->header), adjoins(level->adjoins), sectors(level->sectors),
-      services(&svc), ecs(services), script_model(services),
+      services(&svc), ecs(services), sector_things(ecs, sectors.size()), script_model(services),
       value_mapping(content, script_model, level) {
 
     services.add<cog::default_value_mapping>(value_mapping);
@@ -24,8 +24,9 @@ gorc::game::world::level_model::level_model(gorc::content_manager& content, serv
 }
 
 gorc::game::world::components::thing& gorc::game::world::level_model::get_thing(thing_id id) {
-    for(auto& t : ecs.find_component<components::thing>(id)) {
-        return *t.second;
+    auto thing = ecs.maybe_get_unique_component<components::thing>(id);
+    if(thing.has_value()) {
+        return *thing.get_value();
     }
 
     LOG_ERROR(format("get_thing: thing %d does not exist") % static_cast<int>(id));
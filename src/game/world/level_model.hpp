@@ -6,6 +6,7 @@
 #include "ecs/entity_component_system.hpp"
 #include "components/thing.hpp"
 #include "surface.hpp"
+#include "sector_thing_index.hpp"
 #include "jk/cog/vm/executor.hpp"
 #include "game/world/sounds/sound_model.hpp"
 #include "game/world/camera/camera_model.hpp"
@@ -26,6 +27,7 @@ public:
 
     service_registry services;
     entity_component_system<thing_id> ecs;
+    sector_thing_index sector_things;
 
     cog::executor script_model;
     sounds::sound_model sound_model;
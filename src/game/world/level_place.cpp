@@ -1,7 +1,8 @@
 #include "level_place.hpp"
 
 gorc::game::world::level_place::level_place(std::shared_ptr<content_manager> contentmanager,
-                                            asset_ref<content::assets::level> level)
-    : contentmanager(contentmanager), level(level) {
+                                            asset_ref<content::assets::level> level,
+                                            size_t physics_worker_count)
+    : contentmanager(contentmanager), level(level), physics_worker_count(physics_worker_count) {
     return;
 }
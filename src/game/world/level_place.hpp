@@ -2,6 +2,7 @@
 
 #include "libold/content/assets/level.hpp"
 #include "content/content_manager.hpp"
+#include <cstddef>
 #include <memory>
 
 namespace gorc {
@@ -13,8 +14,13 @@ public:
     std::shared_ptr<content_manager> contentmanager;
     asset_ref<content::assets::level> level;
 
+    // Worker threads which step physics alongside the updating thread. Zero steps every
+    // physics group serially.
+    size_t physics_worker_count;
+
     level_place(std::shared_ptr<content_manager> contentmanager,
-                asset_ref<content::assets::level> level);
+                asset_ref<content::assets::level> level,
+                size_t physics_worker_count = 0);
 };
 
 }
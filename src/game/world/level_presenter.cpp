@@ -40,6 +40,7 @@
 gorc::game::world::level_presenter::level_presenter(level_state& components, const level_place& place)
     : components(components), place(place), contentmanager(place.contentmanager) {
     physics_presenter = std::make_unique<physics::physics_presenter>(*this);
+    physics_presenter->set_worker_count(place.physics_worker_count);
     animation_presenter = std::make_unique<animations::animation_presenter>();
     sound_presenter = std::make_unique<sounds::sound_presenter>(*place.contentmanager);
     key_presenter = std::make_unique<keys::key_presenter>(*place.contentmanager);
@@ -181,57 +182,67 @@ void gorc::game::world::level_presenter::update(const gorc::time& time) {
 
 void gorc::game::world::level_presenter::update_thing_sector(thing_id tid, components::thing& thing,
         const vector<3>& oldThingPosition) {
+    update_thing_sector(tid, thing, oldThingPosition, update_path_sector_scratch,
+            [this](cog::message_type msg, cog::value sender, cog::value source) {
+                model->send_to_linked(msg, sender, source);
+            });
+    model->sector_things.set_sector(tid, thing.sector);
+}
+
+void gorc::game::world::level_presenter::update_thing_sector(thing_id tid, components::thing& thing,
+        const vector<3>& oldThingPosition, std::vector<std::tuple<sector_id, surface_id>>& path_scratch,
+        const linked_message_sink& send) {
     physics::segment segment(oldThingPosition, thing.position);
-    physics::segment_adjoin_path(segment, *model, at_id(model->sectors, thing.sector), update_path_sector_scratch);
+    physics::segment_adjoin_path(segment, *model, at_id(model->sectors, thing.sector), path_scratch);
 
-    if(std::get<0>(update_path_sector_scratch.back()) == thing.sector) {
+    if(std::get<0>(path_scratch.back()) == thing.sector) {
         // thing hasn't moved to a different sector.
         return;
     }
 
     // Fire messages along path.
-    surface_id first_adjoin = std::get<1>(update_path_sector_scratch.front());
+    surface_id first_adjoin = std::get<1>(path_scratch.front());
     if(at_id(model->surfaces, first_adjoin).flags & flags::surface_flag::CogLinked) {
-        model->send_to_linked(cog::message_type::crossed,
-                              /* sender */ first_adjoin,
-                              /* source */ tid);
+        send(cog::message_type::crossed,
+             /* sender */ first_adjoin,
+             /* source */ tid);
     }
 
-    for(unsigned int i = 1; i < update_path_sector_scratch.size() - 1; ++i) {
+    for(unsigned int i = 1; i < path_scratch.size() - 1; ++i) {
         if(at_id(model->sectors, thing.sector).flags & flags::sector_flag::CogLinked) {
-            model->send_to_linked(cog::message_type::exited,
-                                  /* sender */ thing.sector,
-                                  /* source */ tid);
+            send(cog::message_type::exited,
+                 /* sender */ thing.sector,
+                 /* source */ tid);
         }
 
-        sector_id sec_id = std::get<0>(update_path_sector_scratch[i]);
+        sector_id sec_id = std::get<0>(path_scratch[i]);
         thing.sector = sec_id;
         if(at_id(model->sectors, sec_id).flags & flags::sector_flag::CogLinked) {
-            model->send_to_linked(cog::message_type::entered,
-                                  /* sender */ sec_id,
-                                  /* source */ tid);
+            send(cog::message_type::entered,
+                 /* sender */ sec_id,
+                 /* source */ tid);
         }
 
-        surface_id surf_id = std::get<1>(update_path_sector_scratch[i]);
+        surface_id surf_id = std::get<1>(path_scratch[i]);
         if(at_id(model->surfaces, surf_id).flags & flags::surface_flag::CogLinked) {
-            model->send_to_linked(cog::message_type::crossed,
-                                  /* sender */ surf_id,
-                                  /* source */ tid);
+            send(cog::message_type::crossed,
+                 /* sender */ surf_id,
+                 /* source */ tid);
         }
     }
 
     if(at_id(model->sectors, thing.sector).flags & flags::sector_flag::CogLinked) {
-        model->send_to_linked(cog::message_type::exited,
-                              /* sender */ thing.sector,
-                              /* source */ tid);
+        send(cog::message_type::exited,
+             /* sender */ thing.sector,
+             /* source */ tid);
     }
 
-    sector_id last_sector = std::get<0>(update_path_sector_scratch.back());
+    sector_id last_sector = std::get<0>(path_scratch.back());
     thing.sector = last_sector;
     if(at_id(model->sectors, last_sector).flags & flags::sector_flag::CogLinked) {
-        model->send_to_linked(cog::message_type::entered,
-                              /* sender */ last_sector,
-                              /* source */ tid);
+        send(cog::message_type::entered,
+             /* sender */ last_sector,
+             /* source */ tid);
     }
 }
 
@@ -260,6 +271,7 @@ void gorc::game::world::level_presenter::respawn() {
 
     components::thing& cameraThing = model->get_thing(model->local_player_thing_id);
     cameraThing.sector = model->spawn_points[model->current_spawn_point]->sector;
+    model->sector_things.set_sector(model->local_player_thing_id, cameraThing.sector);
     cameraThing.position = model->spawn_points[model->current_spawn_point]->position;
     cameraThing.attach_flags = flag_set<flags::attach_flag>();
     cameraThing.vel = make_zero_vector<3, float>();
@@ -569,13 +581,12 @@ void gorc::game::world::level_presenter::clear_sector_flags(sector_id sid, flag_
 }
 
 gorc::thing_id gorc::game::world::level_presenter::first_thing_in_sector(sector_id sid) {
-    for(auto& thing : model->ecs.all_components<components::thing>()) {
-        if(thing.second->sector == sid) {
-            return thing.first;
-        }
+    auto const& things = model->sector_things.things_in_sector(sid);
+    if(things.empty()) {
+        return invalid_id;
     }
 
-    return invalid_id;
+    return things.front();
 }
 
 gorc::flag_set<gorc::flags::sector_flag> gorc::game::world::level_presenter::get_sector_flags(sector_id sid) {
@@ -583,15 +594,7 @@ gorc::flag_set<gorc::flags::sector_flag> gorc::game::world::level_presenter::get
 }
 
 gorc::thing_id gorc::game::world::level_presenter::next_thing_in_sector(thing_id tid) {
-    sector_id sid = model->get_thing(tid).sector;
-
-    for(auto& thing : model->ecs.all_components<components::thing>()) {
-        if(thing.second->sector == sid && static_cast<int>(thing.first) > static_cast<int>(tid)) {
-            return thing.first;
-        }
-    }
-
-    return invalid_id;
+    return model->sector_things.next_thing_in_sector(tid);
 }
 
 void gorc::game::world::level_presenter::sector_sound(sector_id sid, sound_id sound, float volume) {
@@ -706,6 +709,7 @@ gorc::thing_id gorc::game::world::level_presenter::create_thing(const content::a
 
     new_thing.object_data.thing_id = static_cast<int>(new_thing_id);
     new_thing.sector = sector_num;
+    model->sector_things.set_sector(new_thing_id, sector_num);
     new_thing.position = pos;
     new_thing.orient = orient;
 
@@ -778,11 +782,20 @@ void gorc::game::world::level_presenter::adjust_thing_pos(thing_id tid, const ve
     update_thing_sector(tid, thing, old_pos);
 }
 
+void gorc::game::world::level_presenter::adjust_thing_pos(thing_id tid, const vector<3>& new_pos,
+        std::vector<std::tuple<sector_id, surface_id>>& path_scratch, const linked_message_sink& send) {
+    auto& thing = model->get_thing(tid);
+    auto old_pos = thing.position;
+    thing.position = new_pos;
+    update_thing_sector(tid, thing, old_pos, path_scratch, send);
+}
+
 void gorc::game::world::level_presenter::set_thing_pos(thing_id tid, const vector<3>& new_pos, const quaternion<float>& new_orient, sector_id new_sector) {
     components::thing& thing = model->get_thing(tid);
     thing.position = new_pos;
     thing.orient = new_orient;
     thing.sector = new_sector;
+    model->sector_things.set_sector(tid, new_sector);
 }
 
 void gorc::game::world::level_presenter::attach_thing_to_thing(thing_id tid, thing_id base_id) {
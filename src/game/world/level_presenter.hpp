@@ -15,7 +15,10 @@
 #include "components/thing.hpp"
 #include "content/id.hpp"
 #include "jk/cog/script/verb_table.hpp"
+#include "jk/cog/script/message_type.hpp"
+#include "jk/cog/script/value.hpp"
 
+#include <functional>
 #include <memory>
 #include <stack>
 #include <set>
@@ -37,6 +40,10 @@ namespace sounds { class sound_presenter; }
 class level_model;
 
 class level_presenter : public gorc::place::presenter {
+public:
+    // Receives cog messages as (message, sender, source)
+    using linked_message_sink = std::function<void(cog::message_type, cog::value, cog::value)>;
+
 private:
     // Scratch space
     std::vector<std::tuple<sector_id, surface_id>> update_path_sector_scratch;
@@ -48,6 +55,8 @@ private:
     void initialize_world();
 
     void update_thing_sector(thing_id, components::thing& thing, const vector<3>& oldThingPosition);
+    void update_thing_sector(thing_id, components::thing& thing, const vector<3>& oldThingPosition,
+            std::vector<std::tuple<sector_id, surface_id>>& path_scratch, const linked_message_sink& send);
 
 public:
     std::shared_ptr<content_manager> contentmanager;
@@ -163,6 +172,12 @@ public:
     bool is_thing_moving(thing_id);
 
     void adjust_thing_pos(thing_id, const vector<3>& new_pos);
+
+    // Moves a thing, passing the cog messages for crossed adjoins and sectors to send instead of
+    // sending them. Things in separate physics groups may be moved concurrently, given separate
+    // path scratch space.
+    void adjust_thing_pos(thing_id, const vector<3>& new_pos,
+            std::vector<std::tuple<sector_id, surface_id>>& path_scratch, const linked_message_sink& send);
     void set_thing_pos(thing_id, const vector<3>& new_pos, const quaternion<float>& new_orient, sector_id new_sector);
     vector<3> get_thing_lvec(thing_id);
 
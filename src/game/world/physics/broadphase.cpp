@@ -0,0 +1,223 @@
+#include "broadphase.hpp"
+#include "game/world/level_model.hpp"
+#include "game/constants.hpp"
+#include "ecs/generational_entity_generator.hpp"
+#include "math/util.hpp"
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+using namespace gorc::game::world::physics;
+
+namespace {
+    // Upper bound on the distance a path thing moves along its path during a step.
+    float path_motion_length(gorc::game::world::components::thing const &thing, double dt) {
+        using namespace gorc;
+
+        if(thing.move != flags::move_type::Path || thing.path_moving_paused) {
+            return 0.0f;
+        }
+
+        if(thing.path_moving) {
+            // Each substep moves at most rate_factor * path_move_speed per second.
+            return static_cast<float>(rate_factor * dt) * thing.path_move_speed;
+        }
+        else if(thing.rotatepivot_moving && thing.path_move_speed > 0.0f) {
+            // The thing turns about the goal frame position by at most the sum of the frame's
+            // euler angles, scaled by dt / path_move_speed.
+            vector<3> frame_pos, frame_orient;
+            std::tie(frame_pos, frame_orient) = thing.frames[thing.goal_frame];
+
+            float angle = std::fabs(get<0>(frame_orient)) +
+                          std::fabs(get<1>(frame_orient)) +
+                          std::fabs(get<2>(frame_orient));
+            return length(thing.position - frame_pos) *
+                   to_radians(angle) * static_cast<float>(dt) / thing.path_move_speed;
+        }
+
+        return 0.0f;
+    }
+}
+
+void broadphase::reset(level_model const &model) {
+    things.clear();
+    occupied_slots.clear();
+    thing_groups.clear();
+
+    sector_things.clear();
+    sector_things.resize(model.sectors.size());
+    sector_visited.assign(model.sectors.size(), 0);
+    sector_parent.assign(model.sectors.size(), 0);
+    current_visit = 0;
+}
+
+void broadphase::calculate_influence(level_model const &model, thing_influence &influence) {
+    // Flood fill adjoined sectors overlapping the swept AABB.
+    ++current_visit;
+
+    open_set.clear();
+    open_set.push_back(influence.sector);
+
+    while(!open_set.empty()) {
+        sector_id sid = open_set.back();
+        open_set.pop_back();
+
+        const auto& sector = at_id(model.sectors, sid);
+        auto &visited = sector_visited[static_cast<int>(sid)];
+
+        if(visited == current_visit || !influence.swept_aabb.overlaps(sector.collide_box)) {
+            // Thing does not influence sector.
+            continue;
+        }
+
+        // Thing influences sector.
+        visited = current_visit;
+        influence.sectors.push_back(sid);
+        sector_things[static_cast<int>(sid)].push_back(influence.tid);
+
+        // Add adjoining sectors to open set.
+        for(int i = sector.first_surface; i < sector.first_surface + sector.surface_count; ++i) {
+            const auto& surf = model.surfaces[i];
+            if(surf.adjoin >= 0) {
+                open_set.push_back(surf.adjoined_sector);
+            }
+        }
+    }
+}
+
+void broadphase::remove_influence(thing_influence &influence) {
+    for(auto sid : influence.sectors) {
+        auto &influenced = sector_things[static_cast<int>(sid)];
+        auto it = std::find(influenced.begin(), influenced.end(), influence.tid);
+        if(it != influenced.end()) {
+            *it = influenced.back();
+            influenced.pop_back();
+        }
+    }
+
+    influence.sectors.clear();
+}
+
+int broadphase::find_sector_root(int sector) {
+    while(sector_parent[sector] != sector) {
+        // Path halving
+        sector_parent[sector] = sector_parent[sector_parent[sector]];
+        sector = sector_parent[sector];
+    }
+
+    return sector;
+}
+
+void broadphase::calculate_groups() {
+    // Things influencing a common sector are grouped together.
+    for(auto slot : occupied_slots) {
+        for(auto sid : things[slot].sectors) {
+            sector_parent[static_cast<int>(sid)] = static_cast<int>(sid);
+        }
+    }
+
+    for(auto slot : occupied_slots) {
+        auto const &sectors = things[slot].sectors;
+        if(sectors.empty()) {
+            continue;
+        }
+
+        int root = find_sector_root(static_cast<int>(sectors.front()));
+        for(auto sid : sectors) {
+            int sector_root = find_sector_root(static_cast<int>(sid));
+            if(sector_root != root) {
+                // Keep the lowest sector as the root, so that group ids are stable
+                sector_parent[std::max(root, sector_root)] = std::min(root, sector_root);
+                root = std::min(root, sector_root);
+            }
+        }
+    }
+
+    thing_groups.clear();
+    for(auto slot : occupied_slots) {
+        auto const &influence = things[slot];
+        if(!influence.sectors.empty()) {
+            thing_groups.emplace_back(find_sector_root(static_cast<int>(influence.sectors.front())),
+                                      influence.tid);
+        }
+    }
+
+    std::sort(thing_groups.begin(), thing_groups.end());
+}
+
+void broadphase::update(level_model &model, double dt) {
+    ++current_update;
+
+    // Calculate influence AABBs and update overlapping sectors of things that moved.
+    for(const auto& thing_pair : model.ecs.all_components<components::thing>()) {
+        const auto& thing = *thing_pair.second;
+        thing_id tid = thing_pair.first;
+
+        // Path things never set vel, so their path motion is included separately.
+        float thing_sweep = length(thing.vel) * static_cast<float>(dt) + path_motion_length(thing, dt);
+        auto thing_off_v = make_vector(1.0f, 1.0f, 1.0f) * (thing.move_size + thing_sweep);
+        auto thing_aabb = make_box(thing.position - thing_off_v, thing.position + thing_off_v);
+
+        size_t slot = entity_slot(tid);
+        if(slot >= things.size()) {
+            things.resize(slot + 1);
+        }
+
+        auto &influence = things[slot];
+        if(!influence.tid.is_valid()) {
+            occupied_slots.push_back(slot);
+        }
+        else if(influence.tid == tid && influence.sector == thing.sector && influence.swept_aabb == thing_aabb) {
+            // Influence is unchanged.
+            influence.seen_update = current_update;
+            continue;
+        }
+
+        remove_influence(influence);
+
+        influence.tid = tid;
+        influence.sector = thing.sector;
+        influence.swept_aabb = thing_aabb;
+        influence.seen_update = current_update;
+        calculate_influence(model, influence);
+    }
+
+    // Remove destroyed things.
+    for(size_t i = 0; i < occupied_slots.size(); ) {
+        auto &influence = things[occupied_slots[i]];
+        if(influence.seen_update == current_update) {
+            ++i;
+            continue;
+        }
+
+        remove_influence(influence);
+        influence.tid = invalid_id;
+
+        occupied_slots[i] = occupied_slots.back();
+        occupied_slots.pop_back();
+    }
+
+    calculate_groups();
+}
+
+broadphase::sector_list const& broadphase::influenced_sectors(thing_id tid) const {
+    size_t slot = entity_slot(tid);
+    if(slot >= things.size() || things[slot].tid != tid) {
+        return empty_sectors;
+    }
+
+    return things[slot].sectors;
+}
+
+std::vector<gorc::thing_id> const& broadphase::influenced_things(sector_id sid) const {
+    int index = static_cast<int>(sid);
+    if(index < 0 || static_cast<size_t>(index) >= sector_things.size()) {
+        return empty_things;
+    }
+
+    return sector_things[index];
+}
+
+broadphase::thing_group_list const& broadphase::groups() const {
+    return thing_groups;
+}
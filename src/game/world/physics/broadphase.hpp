@@ -0,0 +1,73 @@
+#pragma once
+
+#include "math/box.hpp"
+#include "content/id.hpp"
+#include "utility/small_vector.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace gorc {
+namespace game {
+namespace world {
+
+class level_model;
+
+namespace physics {
+
+// Tracks the sectors influenced by each thing's swept AABB, and partitions things into
+// groups which cannot touch each other during a step. Influence is only recomputed for
+// things whose swept AABB or sector changed since the previous update.
+class broadphase {
+public:
+    using sector_list = small_vector<sector_id, 4>;
+
+    // Thing groups are listed as (group, thing) pairs, sorted by group
+    using thing_group_list = std::vector<std::pair<int, thing_id>>;
+
+private:
+    class thing_influence {
+    public:
+        thing_id tid;
+        sector_id sector;
+        box<3> swept_aabb;
+        sector_list sectors;
+        uint32_t seen_update = 0;
+    };
+
+    // Indexed by entity slot
+    std::vector<thing_influence> things;
+    std::vector<size_t> occupied_slots;
+
+    // Indexed by sector
+    std::vector<std::vector<thing_id>> sector_things;
+    std::vector<uint32_t> sector_visited;
+    std::vector<int> sector_parent;
+
+    uint32_t current_update = 0;
+    uint32_t current_visit = 0;
+    std::vector<sector_id> open_set;
+    thing_group_list thing_groups;
+
+    sector_list const empty_sectors;
+    std::vector<thing_id> const empty_things;
+
+    void calculate_influence(level_model const &model, thing_influence &influence);
+    void remove_influence(thing_influence &influence);
+    void calculate_groups();
+
+    int find_sector_root(int sector);
+
+public:
+    void reset(level_model const &model);
+    void update(level_model &model, double dt);
+
+    sector_list const& influenced_sectors(thing_id tid) const;
+    std::vector<thing_id> const& influenced_things(sector_id sid) const;
+    thing_group_list const& groups() const;
+};
+
+}
+}
+}
+}
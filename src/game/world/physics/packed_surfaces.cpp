@@ -0,0 +1,370 @@
+#include "packed_surfaces.hpp"
+#include "game/world/level_model.hpp"
+#include "math/util.hpp"
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace gorc::game::world::physics;
+
+void packed_surfaces::clear() {
+    sectors.clear();
+
+    surface_ids.clear();
+    normal_x.clear();
+    normal_y.clear();
+    normal_z.clear();
+    point_x.clear();
+    point_y.clear();
+    point_z.clear();
+    first_edge.clear();
+    edge_count.clear();
+
+    start_x.clear();
+    start_y.clear();
+    start_z.clear();
+    end_x.clear();
+    end_y.clear();
+    end_z.clear();
+    edge_normal_x.clear();
+    edge_normal_y.clear();
+    edge_normal_z.clear();
+}
+
+void packed_surfaces::reset(level_model const &model) {
+    clear();
+
+    for(auto const &sector : model.sectors) {
+        add_sector();
+        for(int i = sector.first_surface; i < sector.first_surface + sector.surface_count; ++i) {
+            add_surface(*model.level, model.surfaces[i], surface_id(i));
+        }
+    }
+}
+
+void packed_surfaces::add_sector() {
+    sectors.emplace_back();
+    sectors.back().first_surface = surface_ids.size();
+}
+
+void packed_surfaces::add_surface(surface_id id, vector<3> const &normal,
+                                  std::vector<vector<3>> const &polygon) {
+    auto &sector = sectors.back();
+    if(sector.surface_count % lane_count == 0) {
+        // Start a new block of invalid surfaces.
+        for(size_t i = 0; i < lane_count; ++i) {
+            surface_ids.push_back(-1);
+            normal_x.push_back(0.0f);
+            normal_y.push_back(0.0f);
+            normal_z.push_back(0.0f);
+            point_x.push_back(0.0f);
+            point_y.push_back(0.0f);
+            point_z.push_back(0.0f);
+            first_edge.push_back(0);
+            edge_count.push_back(0);
+        }
+    }
+
+    size_t surface = sector.first_surface + sector.surface_count++;
+
+    surface_ids[surface] = static_cast<int>(id);
+    normal_x[surface] = get<0>(normal);
+    normal_y[surface] = get<1>(normal);
+    normal_z[surface] = get<2>(normal);
+
+    if(!polygon.empty()) {
+        point_x[surface] = get<0>(polygon.front());
+        point_y[surface] = get<1>(polygon.front());
+        point_z[surface] = get<2>(polygon.front());
+    }
+
+    size_t edge = start_x.size();
+    first_edge[surface] = edge;
+
+    for(size_t i = polygon.size() - 1UL, j = 0UL; j < polygon.size(); i = j++) {
+        auto const &p0 = polygon[i];
+        auto const &p1 = polygon[j];
+        auto edge_normal = cross(normal, p1 - p0);
+
+        start_x.push_back(get<0>(p0));
+        start_y.push_back(get<1>(p0));
+        start_z.push_back(get<2>(p0));
+        end_x.push_back(get<0>(p1));
+        end_y.push_back(get<1>(p1));
+        end_z.push_back(get<2>(p1));
+        edge_normal_x.push_back(get<0>(edge_normal));
+        edge_normal_y.push_back(get<1>(edge_normal));
+        edge_normal_z.push_back(get<2>(edge_normal));
+    }
+
+    // Repeated edges do not change either test.
+    while(!polygon.empty() && (start_x.size() - edge) % lane_count != 0) {
+        start_x.push_back(start_x[edge]);
+        start_y.push_back(start_y[edge]);
+        start_z.push_back(start_z[edge]);
+        end_x.push_back(end_x[edge]);
+        end_y.push_back(end_y[edge]);
+        end_z.push_back(end_z[edge]);
+        edge_normal_x.push_back(edge_normal_x[edge]);
+        edge_normal_y.push_back(edge_normal_y[edge]);
+        edge_normal_z.push_back(edge_normal_z[edge]);
+    }
+
+    edge_count[surface] = start_x.size() - edge;
+}
+
+// Portable kernels. These repeat the reference operations one edge or surface at a time.
+class packed_surfaces::scalar_kernels {
+public:
+    static int reject_planes(packed_surfaces const &ps, size_t first, vector<3> const &origin,
+                             float max_dist, float *plane_dist) {
+        int rejected = 0;
+        for(size_t lane = 0; lane < lane_count; ++lane) {
+            size_t i = first + lane;
+            auto nrm = make_vector(ps.normal_x[i], ps.normal_y[i], ps.normal_z[i]);
+            auto p = make_vector(ps.point_x[i], ps.point_y[i], ps.point_z[i]);
+            plane_dist[lane] = dot(nrm, origin - p);
+            if(plane_dist[lane] < 0.0f || plane_dist[lane] > max_dist) {
+                rejected |= 1 << lane;
+            }
+        }
+
+        return rejected;
+    }
+
+    static bool point_inside_surface(packed_surfaces const &ps, size_t surface,
+                                     vector<3> const &point) {
+        size_t first = ps.first_edge[surface];
+        size_t last = first + ps.edge_count[surface];
+
+        for(size_t i = first; i < last; ++i) {
+            auto p0 = make_vector(ps.start_x[i], ps.start_y[i], ps.start_z[i]);
+            auto edge_normal = make_vector(ps.edge_normal_x[i], ps.edge_normal_y[i],
+                                           ps.edge_normal_z[i]);
+            if(dot(edge_normal, point - p0) < 0.0f) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static vector<3> closest_point_on_edges(packed_surfaces const &ps, size_t surface,
+                                            vector<3> const &origin) {
+        size_t first = ps.first_edge[surface];
+        size_t last = first + ps.edge_count[surface];
+
+        float closest_dist = std::numeric_limits<float>::max();
+        vector<3> closest_point = make_zero_vector<3, float>();
+
+        for(size_t i = first; i < last; ++i) {
+            auto vp0 = make_vector(ps.start_x[i], ps.start_y[i], ps.start_z[i]);
+            auto vp1 = make_vector(ps.end_x[i], ps.end_y[i], ps.end_z[i]);
+            auto lv = vp1 - vp0;
+            auto pv = origin - vp0;
+
+            vector<3> candidate_point;
+            auto alpha = dot(lv, pv) / length_squared(lv);
+            if(alpha < 0.0f) {
+                candidate_point = vp0;
+            }
+            else if(alpha > 1.0f) {
+                candidate_point = vp1;
+            }
+            else {
+                candidate_point = lerp(vp0, vp1, alpha);
+            }
+
+            auto cp_dist = length(candidate_point - origin);
+            if(cp_dist < closest_dist) {
+                closest_point = candidate_point;
+                closest_dist = cp_dist;
+            }
+        }
+
+        return closest_point;
+    }
+};
+
+#if defined(__SSE2__)
+// Tests four surfaces or edges at a time, with the operations of the scalar kernels.
+class packed_surfaces::sse2_kernels {
+public:
+    static int reject_planes(packed_surfaces const &ps, size_t first, vector<3> const &origin,
+                             float max_dist, float *plane_dist) {
+        __m128 vx = _mm_sub_ps(_mm_set1_ps(get<0>(origin)), _mm_loadu_ps(&ps.point_x[first]));
+        __m128 vy = _mm_sub_ps(_mm_set1_ps(get<1>(origin)), _mm_loadu_ps(&ps.point_y[first]));
+        __m128 vz = _mm_sub_ps(_mm_set1_ps(get<2>(origin)), _mm_loadu_ps(&ps.point_z[first]));
+
+        __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&ps.normal_x[first]), vx),
+                                            _mm_mul_ps(_mm_loadu_ps(&ps.normal_y[first]), vy)),
+                                 _mm_mul_ps(_mm_loadu_ps(&ps.normal_z[first]), vz));
+        _mm_storeu_ps(plane_dist, dist);
+
+        return _mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(dist, _mm_setzero_ps()),
+                                         _mm_cmpgt_ps(dist, _mm_set1_ps(max_dist))));
+    }
+
+    static bool point_inside_surface(packed_surfaces const &ps, size_t surface,
+                                     vector<3> const &point) {
+        size_t first = ps.first_edge[surface];
+        size_t last = first + ps.edge_count[surface];
+
+        __m128 px = _mm_set1_ps(get<0>(point));
+        __m128 py = _mm_set1_ps(get<1>(point));
+        __m128 pz = _mm_set1_ps(get<2>(point));
+        __m128 zero = _mm_setzero_ps();
+
+        for(size_t i = first; i < last; i += lane_count) {
+            __m128 vx = _mm_sub_ps(px, _mm_loadu_ps(&ps.start_x[i]));
+            __m128 vy = _mm_sub_ps(py, _mm_loadu_ps(&ps.start_y[i]));
+            __m128 vz = _mm_sub_ps(pz, _mm_loadu_ps(&ps.start_z[i]));
+
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&ps.edge_normal_x[i]), vx),
+                                                _mm_mul_ps(_mm_loadu_ps(&ps.edge_normal_y[i]), vy)),
+                                     _mm_mul_ps(_mm_loadu_ps(&ps.edge_normal_z[i]), vz));
+
+            if(_mm_movemask_ps(_mm_cmplt_ps(dist, zero)) != 0) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static vector<3> closest_point_on_edges(packed_surfaces const &ps, size_t surface,
+                                            vector<3> const &origin) {
+        size_t first = ps.first_edge[surface];
+        size_t last = first + ps.edge_count[surface];
+
+        float closest_dist = std::numeric_limits<float>::max();
+        vector<3> closest_point = make_zero_vector<3, float>();
+
+        __m128 ox = _mm_set1_ps(get<0>(origin));
+        __m128 oy = _mm_set1_ps(get<1>(origin));
+        __m128 oz = _mm_set1_ps(get<2>(origin));
+        __m128 zero = _mm_setzero_ps();
+        __m128 one = _mm_set1_ps(1.0f);
+
+        alignas(16) float cand_x[lane_count];
+        alignas(16) float cand_y[lane_count];
+        alignas(16) float cand_z[lane_count];
+        alignas(16) float cand_dist[lane_count];
+
+        for(size_t i = first; i < last; i += lane_count) {
+            __m128 sx = _mm_loadu_ps(&ps.start_x[i]);
+            __m128 sy = _mm_loadu_ps(&ps.start_y[i]);
+            __m128 sz = _mm_loadu_ps(&ps.start_z[i]);
+            __m128 ex = _mm_loadu_ps(&ps.end_x[i]);
+            __m128 ey = _mm_loadu_ps(&ps.end_y[i]);
+            __m128 ez = _mm_loadu_ps(&ps.end_z[i]);
+
+            __m128 lx = _mm_sub_ps(ex, sx);
+            __m128 ly = _mm_sub_ps(ey, sy);
+            __m128 lz = _mm_sub_ps(ez, sz);
+            __m128 vx = _mm_sub_ps(ox, sx);
+            __m128 vy = _mm_sub_ps(oy, sy);
+            __m128 vz = _mm_sub_ps(oz, sz);
+
+            __m128 lv_dot_pv = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, vx), _mm_mul_ps(ly, vy)),
+                                          _mm_mul_ps(lz, vz));
+            __m128 lv_len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, lx), _mm_mul_ps(ly, ly)),
+                                        _mm_mul_ps(lz, lz));
+            __m128 alpha = _mm_div_ps(lv_dot_pv, lv_len2);
+            __m128 beta = _mm_sub_ps(one, alpha);
+
+            // Clamp to the edge end points.
+            __m128 before_start = _mm_cmplt_ps(alpha, zero);
+            __m128 after_end = _mm_andnot_ps(before_start, _mm_cmpgt_ps(alpha, one));
+            __m128 inside = _mm_andnot_ps(_mm_or_ps(before_start, after_end),
+                                          _mm_castsi128_ps(_mm_set1_epi32(-1)));
+
+            auto select = [&](__m128 s, __m128 e) {
+                __m128 lerped = _mm_add_ps(_mm_mul_ps(beta, s), _mm_mul_ps(alpha, e));
+                return _mm_or_ps(_mm_or_ps(_mm_and_ps(before_start, s), _mm_and_ps(after_end, e)),
+                                 _mm_and_ps(inside, lerped));
+            };
+
+            __m128 cx = select(sx, ex);
+            __m128 cy = select(sy, ey);
+            __m128 cz = select(sz, ez);
+
+            __m128 dx = _mm_sub_ps(cx, ox);
+            __m128 dy = _mm_sub_ps(cy, oy);
+            __m128 dz = _mm_sub_ps(cz, oz);
+            __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                                                 _mm_mul_ps(dz, dz)));
+
+            _mm_store_ps(cand_x, cx);
+            _mm_store_ps(cand_y, cy);
+            _mm_store_ps(cand_z, cz);
+            _mm_store_ps(cand_dist, dist);
+
+            // Keep the first closest edge, as the reference does.
+            for(size_t lane = 0; lane < lane_count; ++lane) {
+                if(cand_dist[lane] < closest_dist) {
+                    closest_point = make_vector(cand_x[lane], cand_y[lane], cand_z[lane]);
+                    closest_dist = cand_dist[lane];
+                }
+            }
+        }
+
+        return closest_point;
+    }
+};
+#endif
+
+template <typename KernelsT>
+void packed_surfaces::find_closest_points(size_t sector,
+                                          vector<3> const &origin,
+                                          float max_dist,
+                                          closest_point_list &points) const {
+    auto const &packed = sectors[sector];
+    size_t last = packed.first_surface + packed.surface_count;
+
+    float plane_dist[lane_count];
+
+    for(size_t first = packed.first_surface; first < last; first += lane_count) {
+        int rejected = KernelsT::reject_planes(*this, first, origin, max_dist, plane_dist);
+
+        for(size_t lane = 0; lane < lane_count; ++lane) {
+            size_t surface = first + lane;
+            if((rejected & (1 << lane)) || surface_ids[surface] < 0) {
+                continue;
+            }
+
+            auto nrm = make_vector(normal_x[surface], normal_y[surface], normal_z[surface]);
+            auto p = make_vector(point_x[surface], point_y[surface], point_z[surface]);
+            auto pp = ((origin - p) - nrm * plane_dist[lane]) + p;
+
+            surface_id id(surface_ids[surface]);
+            if(KernelsT::point_inside_surface(*this, surface, pp)) {
+                points.emplace_back(id, pp);
+            }
+            else {
+                points.emplace_back(id, KernelsT::closest_point_on_edges(*this, surface, origin));
+            }
+        }
+    }
+}
+
+void packed_surfaces::closest_points(size_t sector,
+                                     vector<3> const &origin,
+                                     float max_dist,
+                                     closest_point_list &points) const {
+#if defined(__SSE2__)
+    find_closest_points<sse2_kernels>(sector, origin, max_dist, points);
+#else
+    find_closest_points<scalar_kernels>(sector, origin, max_dist, points);
+#endif
+}
+
+void packed_surfaces::scalar_closest_points(size_t sector,
+                                            vector<3> const &origin,
+                                            float max_dist,
+                                            closest_point_list &points) const {
+    find_closest_points<scalar_kernels>(sector, origin, max_dist, points);
+}
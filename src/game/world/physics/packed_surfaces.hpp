@@ -0,0 +1,99 @@
+#pragma once
+
+#include "math/vector.hpp"
+#include "content/id.hpp"
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+namespace gorc {
+namespace game {
+namespace world {
+
+class level_model;
+
+namespace physics {
+
+// Surfaces of each sector packed as structures of arrays, so that a sphere can be tested
+// against every surface of a sector a few surfaces at a time. Produces the same points as
+// bounded_closest_point_on_surface, which remains the reference implementation.
+class packed_surfaces {
+public:
+    // Number of surfaces or edges tested at once
+    static constexpr size_t lane_count = 4;
+
+    using closest_point_list = std::vector<std::tuple<surface_id, vector<3>>>;
+
+private:
+    class packed_sector {
+    public:
+        size_t first_surface = 0;
+        size_t surface_count = 0;
+    };
+
+    std::vector<packed_sector> sectors;
+
+    // Surface planes. Each sector is padded to a multiple of the lane count with invalid
+    // surfaces.
+    std::vector<int> surface_ids;
+    std::vector<float> normal_x, normal_y, normal_z;
+    std::vector<float> point_x, point_y, point_z;
+    std::vector<size_t> first_edge;
+    std::vector<size_t> edge_count;
+
+    // Surface edges, in winding order starting with the closing edge. Each surface is padded
+    // to a multiple of the lane count by repeating its first edge.
+    std::vector<float> start_x, start_y, start_z;
+    std::vector<float> end_x, end_y, end_z;
+    std::vector<float> edge_normal_x, edge_normal_y, edge_normal_z;
+
+    std::vector<vector<3>> polygon_scratch;
+
+    void add_surface(surface_id id, vector<3> const &normal,
+                     std::vector<vector<3>> const &polygon);
+
+    // Sphere test kernels. The SSE2 kernels are only defined where SSE2 is available.
+    class scalar_kernels;
+    class sse2_kernels;
+
+    template <typename KernelsT>
+    void find_closest_points(size_t sector,
+                             vector<3> const &origin,
+                             float max_dist,
+                             closest_point_list &points) const;
+
+public:
+    void clear();
+    void reset(level_model const &model);
+
+    // Surfaces added after this call belong to a new sector
+    void add_sector();
+
+    template <typename VertexProvider, typename EdgeProvider>
+    void add_surface(VertexProvider const &level, EdgeProvider const &surface, surface_id id) {
+        polygon_scratch.clear();
+        for(auto const &vx : surface.vertices) {
+            polygon_scratch.push_back(level.vertices[std::get<0>(vx)]);
+        }
+
+        add_surface(id, surface.normal, polygon_scratch);
+    }
+
+    // Appends the closest point on each surface of the sector which lies in front of the
+    // surface plane, within max_dist of the plane. Surfaces are listed in sector order.
+    void closest_points(size_t sector,
+                        vector<3> const &origin,
+                        float max_dist,
+                        closest_point_list &points) const;
+
+    // Same as closest_points, using only the portable scalar kernels
+    void scalar_closest_points(size_t sector,
+                               vector<3> const &origin,
+                               float max_dist,
+                               closest_point_list &points) const;
+};
+
+}
+}
+}
+}
@@ -10,18 +10,28 @@
 #include "game/world/events/touched_thing.hpp"
 #include "game/world/events/touched_surface.hpp"
 #include "query.hpp"
+#include <algorithm>
 
 using namespace gorc::game::world::physics;
 
 physics_presenter::physics_presenter(level_presenter& presenter)
-    : presenter(presenter), model(nullptr), physics_anim_node_visitor(*this, physics_thing_resting_manifolds, physics_touched_thing_pairs),
-      segment_query_anim_node_visitor(*this) {
+    : presenter(presenter), model(nullptr), segment_query_anim_node_visitor(*this) {
+    physics_step_contexts.push_back(std::make_unique<physics_step_context>(*this));
     return;
 }
 
 void physics_presenter::start(level_model& model, event_bus& eb) {
     this->model = &model;
     this->eventbus = &eb;
+    physics_broadphase.reset(model);
+    physics_packed_surfaces.reset(model);
+}
+
+void physics_presenter::set_worker_count(size_t count) {
+    physics_workers.set_worker_count(count);
+    while(physics_step_contexts.size() < physics_workers.thread_count()) {
+        physics_step_contexts.push_back(std::make_unique<physics_step_context>(*this));
+    }
 }
 
 bool physics_presenter::surface_needs_collision_response(thing_id moving_thing_id, surface_id sid) {
@@ -77,7 +87,17 @@ physics_presenter::physics_node_visitor::physics_node_visitor(physics_presenter&
 void physics_presenter::physics_node_visitor::visit_mesh(asset_ref<content::assets::model> model, int mesh_id, int) {
     const auto& mesh = model->geosets.front().meshes[mesh_id];
 
-    for(const auto& face : mesh.faces) {
+    // Only faces near the sphere can touch it. Faces are tested in mesh order.
+    auto sphere_extent = make_fill_vector<3>(sphere.radius);
+    auto sphere_bounds = make_box(sphere.position - sphere_extent, sphere.position + sphere_extent);
+
+    candidate_faces.clear();
+    mesh.bvh.visit([&](box<3> const &bounds) { return physics::transform_bounds(bounds, current_matrix).overlaps(sphere_bounds); },
+            [&](int face_index) { candidate_faces.push_back(face_index); });
+    std::sort(candidate_faces.begin(), candidate_faces.end());
+
+    for(int face_index : candidate_faces) {
+        const auto& face = mesh.faces[face_index];
         auto maybe_face_nearest_point = physics::bounded_closest_point_on_surface(sphere.position, mesh, face, current_matrix, sphere.radius);
 
         maybe_if(maybe_face_nearest_point, [&](vector<3> const &face_nearest_point) {
@@ -98,157 +118,52 @@ void physics_presenter::physics_node_visitor::visit_mesh(asset_ref<content::asse
     };
 }
 
-void physics_presenter::physics_calculate_broadphase(double dt) {
-    physics_broadphase_thing_influence.clear();
-    physics_broadphase_sector_things.clear();
-
-    // Calculate influence AABBs and record overlapping sectors.
-    for(const auto& thing_pair : model->ecs.all_components<components::thing>()) {
-        const auto& thing = *thing_pair.second;
-        thing_id tid = thing_pair.first;
-
-        auto thing_off_v = make_vector(1.0f, 1.0f, 1.0f) * (thing.move_size + length(thing.vel) * static_cast<float>(dt));
-        auto thing_aabb = make_box(thing.position - thing_off_v, thing.position + thing_off_v);
-
-        physics_thing_closed_set.clear();
-        physics_thing_open_set.clear();
-
-        physics_thing_open_set.push_back(thing.sector);
-
-        while(!physics_thing_open_set.empty()) {
-            sector_id sid = physics_thing_open_set.back();
-            physics_thing_open_set.pop_back();
-
-            const auto& sector = at_id(model->sectors, sid);
-
-            if(physics_thing_closed_set.find(sid) != physics_thing_closed_set.end()
-                    || !thing_aabb.overlaps(sector.collide_box)) {
-                // Thing does not influence sector.
-                continue;
-            }
-
-            // Thing influences sector. Move to closed set.
-            physics_thing_closed_set.emplace(sid);
-            physics_broadphase_sector_things.emplace(sid, tid);
-            physics_broadphase_thing_influence.emplace(tid, sid);
-
-            // Add adjoining sectors to open set.
-            for(int i = sector.first_surface; i < sector.first_surface + sector.surface_count; ++i) {
-                const auto& surf = model->surfaces[i];
-                if(surf.adjoin >= 0) {
-                    physics_thing_open_set.push_back(surf.adjoined_sector);
-                }
-            }
-        }
-    }
-
-    // Compute and merge sector groups
-    physics_broadphase_sector_group.clear();
-
-    // Group sectors together
-    int current_influence_group = 0;
-    for(auto it_begin = physics_broadphase_thing_influence.begin();
-        it_begin != physics_broadphase_thing_influence.end(); ) {
-        // Find range end
-        auto it_end = it_begin;
-        while((it_end != physics_broadphase_thing_influence.end()) &&
-              (it_end->first == it_begin->first)) {
-            ++it_end;
-        }
-
-        physics_broadphase_groups_to_merge.clear();
-        bool used_current_influence_group = false;
-        int min_id_to_merge = current_influence_group;
-        for(const auto &influenced_sector : make_range(it_begin, it_end)) {
-            auto sector_group_it = physics_broadphase_sector_group.find(influenced_sector.second);
-            if(sector_group_it == physics_broadphase_sector_group.end()) {
-                // Sector is not currently in a group.
-                physics_broadphase_sector_group.emplace(influenced_sector.second,
-                                                        current_influence_group);
-                used_current_influence_group = true;
-            }
-            else {
-                // Sector is currently in a group.
-                physics_broadphase_groups_to_merge.emplace(sector_group_it->second);
-                min_id_to_merge = std::min(sector_group_it->second, min_id_to_merge);
-            }
-        }
-
-        if(used_current_influence_group) {
-            physics_broadphase_groups_to_merge.emplace(current_influence_group++);
-        }
-
-        // Merge groups
-        for(auto &grouped_sector : physics_broadphase_sector_group) {
-            if(physics_broadphase_groups_to_merge.count(grouped_sector.second)) {
-                grouped_sector.second = min_id_to_merge;
-            }
-        }
-
-        it_begin = it_end;
-    }
-
-    // Remap sector groups to thing groups
-    physics_broadphase_thing_groups.clear();
-
-    for(auto it_begin = physics_broadphase_thing_influence.begin();
-        it_begin != physics_broadphase_thing_influence.end(); ) {
-        auto it_end = it_begin;
-        while((it_end != physics_broadphase_thing_influence.end()) &&
-              (it_end->first == it_begin->first)) {
-            ++it_end;
-        }
-
-        int thing_group_id = physics_broadphase_sector_group.find(it_begin->second)->second;
-        physics_broadphase_thing_groups.emplace(thing_group_id, it_begin->first);
-
-        it_begin = it_end;
-    }
-
+physics_presenter::physics_step_context::physics_step_context(physics_presenter& presenter)
+    : anim_node_visitor(presenter, resting_manifolds, touched_thing_pairs) {
     return;
 }
 
-void physics_presenter::physics_find_sector_resting_manifolds(const physics::sphere& sphere, sector_id, const vector<3>&,
-        thing_id current_thing_id) {
+void physics_presenter::physics_find_sector_resting_manifolds(physics_step_context& context, const physics::sphere& sphere, sector_id,
+        const vector<3>&, thing_id current_thing_id) {
     // Get list of sectors within thing influence.
-    auto thing_influence_range = physics_broadphase_thing_influence.equal_range(current_thing_id);
-    for(auto it = std::get<0>(thing_influence_range); it != std::get<1>(thing_influence_range); ++it) {
-        const auto& sector = at_id(model->sectors, it->second);
-
-        for(int i = sector.first_surface; i < sector.first_surface + sector.surface_count; ++i) {
-            const auto& surface = model->surfaces[i];
-
-            if(!surface_needs_collision_response(current_thing_id, surface_id(i))) {
+    for(auto influenced_sector_id : physics_broadphase.influenced_sectors(current_thing_id)) {
+        // Test the sphere against every surface of the sector at once.
+        context.surface_points.clear();
+        physics_packed_surfaces.closest_points(static_cast<int>(influenced_sector_id), sphere.position, sphere.radius,
+                context.surface_points);
+
+        for(const auto& surface_point : context.surface_points) {
+            surface_id sid = std::get<0>(surface_point);
+            const auto& surf_nearest_point = std::get<1>(surface_point);
+            const auto& surface = at_id(model->surfaces, sid);
+
+            if(!surface_needs_collision_response(current_thing_id, sid)) {
                 continue;
             }
 
-            auto maybe_surf_nearest_point = physics::bounded_closest_point_on_surface(sphere.position, *model->level, surface, sphere.radius);
-            maybe_if(maybe_surf_nearest_point, [&](vector<3> const &surf_nearest_point) {
-                auto surf_nearest_dist = length(sphere.position - surf_nearest_point);
+            auto surf_nearest_dist = length(sphere.position - surf_nearest_point);
 
-                if(surf_nearest_dist <= sphere.radius) {
-                    physics_thing_resting_manifolds.emplace_back(surf_nearest_point, (sphere.position - surf_nearest_point) / surf_nearest_dist,
-                            surface.normal * ((sphere.radius / surf_nearest_dist) - 1.0f));
-                    physics_thing_resting_manifolds.back().contact_surface_id = surface_id(i);
-                    physics_touched_surface_pairs.emplace(current_thing_id, surface_id(i));
-                }
-            });
+            if(surf_nearest_dist <= sphere.radius) {
+                context.resting_manifolds.emplace_back(surf_nearest_point, (sphere.position - surf_nearest_point) / surf_nearest_dist,
+                        surface.normal * ((sphere.radius / surf_nearest_dist) - 1.0f));
+                context.resting_manifolds.back().contact_surface_id = sid;
+                context.touched_surface_pairs.emplace(current_thing_id, sid);
+            }
         }
     }
 }
 
-void physics_presenter::physics_find_thing_resting_manifolds(const physics::sphere& sphere, const vector<3>&, thing_id current_thing_id) {
+void physics_presenter::physics_find_thing_resting_manifolds(physics_step_context& context, const physics::sphere& sphere,
+        const vector<3>&, thing_id current_thing_id) {
     // Get list of things within thing influence.
-    physics_overlapping_things.clear();
-    auto thing_influence_range = physics_broadphase_thing_influence.equal_range(current_thing_id);
-    for(auto it = std::get<0>(thing_influence_range); it != std::get<1>(thing_influence_range); ++it) {
-        auto influenced_thing_range = physics_broadphase_sector_things.equal_range(it->second);
-        for(auto jt = std::get<0>(influenced_thing_range); jt != std::get<1>(influenced_thing_range); ++jt) {
-            physics_overlapping_things.emplace(jt->second);
+    context.overlapping_things.clear();
+    for(auto influenced_sector_id : physics_broadphase.influenced_sectors(current_thing_id)) {
+        for(auto influenced_thing_id : physics_broadphase.influenced_things(influenced_sector_id)) {
+            context.overlapping_things.emplace(influenced_thing_id);
         }
     }
 
-    for(auto col_thing_id : physics_overlapping_things) {
+    for(auto col_thing_id : context.overlapping_things) {
         auto& col_thing = model->get_thing(col_thing_id);
 
         if(col_thing_id == current_thing_id) {
@@ -278,11 +193,11 @@ void physics_presenter::physics_find_thing_resting_manifolds(const physics::sphe
                         contact_point_vel = get_thing_path_moving_point_velocity(col_thing_id, contact_point);
                     }
 
-                    physics_thing_resting_manifolds.emplace_back(contact_point, vec_to / vec_to_len, contact_point_vel);
-                    physics_thing_resting_manifolds.back().contact_thing_id = col_thing_id;
+                    context.resting_manifolds.emplace_back(contact_point, vec_to / vec_to_len, contact_point_vel);
+                    context.resting_manifolds.back().contact_thing_id = col_thing_id;
                 }
 
-                physics_touched_thing_pairs.emplace(std::min(current_thing_id, col_thing_id), std::max(current_thing_id, col_thing_id));
+                context.touched_thing_pairs.emplace(std::min(current_thing_id, col_thing_id), std::max(current_thing_id, col_thing_id));
             }
         }
         else if(col_thing.collide == flags::collide_type::face) {
@@ -290,11 +205,12 @@ void physics_presenter::physics_find_thing_resting_manifolds(const physics::sphe
                 continue;
             }
 
-            physics_anim_node_visitor.needs_response = thing_needs_collision_response(current_thing_id, col_thing_id);
-            physics_anim_node_visitor.sphere = sphere;
-            physics_anim_node_visitor.visited_thing_id = col_thing_id;
-            physics_anim_node_visitor.moving_thing_id = current_thing_id;
-            presenter.key_presenter->visit_mesh_hierarchy(physics_anim_node_visitor, col_thing.model_3d.get_value(), col_thing.position, col_thing.orient, col_thing_id, /* is pov */ false);
+            auto& anim_node_visitor = context.anim_node_visitor;
+            anim_node_visitor.needs_response = thing_needs_collision_response(current_thing_id, col_thing_id);
+            anim_node_visitor.sphere = sphere;
+            anim_node_visitor.visited_thing_id = col_thing_id;
+            anim_node_visitor.moving_thing_id = current_thing_id;
+            presenter.key_presenter->visit_mesh_hierarchy(anim_node_visitor, col_thing.model_3d.get_value(), col_thing.position, col_thing.orient, col_thing_id, /* is pov */ false);
         }
     }
 }
@@ -343,7 +259,7 @@ void physics_presenter::compute_thing_attachment_velocity(components::thing &thi
     }
 }
 
-void physics_presenter::physics_thing_step(thing_id tid, components::thing& thing, double dt) {
+void physics_presenter::physics_thing_step(physics_step_context& context, thing_id tid, components::thing& thing, double dt) {
     // Only perform collision detection for player, actor, and weapon types.
     if(thing.type != flags::thing_type::Actor &&
        thing.type != flags::thing_type::Player &&
@@ -359,19 +275,20 @@ void physics_presenter::physics_thing_step(thing_id tid, components::thing& thin
 
     // Do sphere collision:
 
-    physics_thing_resting_manifolds.clear();
-    physics_find_sector_resting_manifolds(physics::sphere(thing.position, thing.size),
+    context.resting_manifolds.clear();
+    physics_find_sector_resting_manifolds(context,
+                                          physics::sphere(thing.position, thing.size),
                                           thing.sector,
                                           thing.vel,
                                           tid);
-    physics_find_thing_resting_manifolds(physics::sphere(thing.position, thing.size), thing.vel, tid);
+    physics_find_thing_resting_manifolds(context, physics::sphere(thing.position, thing.size), thing.vel, tid);
 
     vector<3> prev_thing_vel = thing.vel;
 
     bool influenced_by_manifolds = false;
 
     // Add 'towards' velocities from resting contacts, projected into manifold direction.
-    for(const auto& manifold : physics_thing_resting_manifolds) {
+    for(const auto& manifold : context.resting_manifolds) {
         auto man_vel_len = dot(manifold.velocity, manifold.normal);
 
         if(man_vel_len <= 0.0f) {
@@ -395,7 +312,7 @@ void physics_presenter::physics_thing_step(thing_id tid, components::thing& thin
     // Solve LCP, 5 iterations
     for(int i = 0; i < 5; ++i) {
         vector<3> new_computed_vel = prev_thing_vel;
-        for(const auto& manifold : physics_thing_resting_manifolds) {
+        for(const auto& manifold : context.resting_manifolds) {
             // Three cases:
             auto vel_dot = dot(new_computed_vel, manifold.normal);
             if(vel_dot < 0.0f) {
@@ -443,8 +360,7 @@ void physics_presenter::physics_thing_step(thing_id tid, components::thing& thin
     else {
         if(!reject_vel) {
             thing.vel = prev_thing_vel;
-            presenter.adjust_thing_pos(tid,
-                                       thing.position + prev_thing_vel * static_cast<float>(dt));
+            adjust_thing_pos(context, tid, thing.position + prev_thing_vel * static_cast<float>(dt));
         }
         else {
             thing.vel = make_zero_vector<3, float>();
@@ -453,7 +369,7 @@ void physics_presenter::physics_thing_step(thing_id tid, components::thing& thin
     }
 
     // Check vel to make sure all valid resting velocities are still applied.
-    for(const auto& manifold : physics_thing_resting_manifolds) {
+    for(const auto& manifold : context.resting_manifolds) {
         auto man_vel_len = dot(manifold.velocity, manifold.normal);
 
         if(man_vel_len <= 0.0f) {
@@ -476,7 +392,7 @@ void physics_presenter::physics_thing_step(thing_id tid, components::thing& thin
     }
 }
 
-void physics_presenter::update_thing_path_moving(thing_id tid, components::thing& thing, double dt) {
+void physics_presenter::update_thing_path_moving(physics_step_context& context, thing_id tid, components::thing& thing, double dt) {
     if(thing.move != flags::move_type::Path || thing.is_blocked || thing.path_moving_paused) {
         return;
     }
@@ -493,7 +409,7 @@ void physics_presenter::update_thing_path_moving(thing_id tid, components::thing
         float dist_len = length(targetPosition - currentPosition);
         float alpha = static_cast<float>(rate_factor * dt) * thing.path_move_speed / dist_len;
         if(alpha >= 1.0f || dist_len <= 0.0f) {
-            presenter.adjust_thing_pos(tid, targetPosition);
+            adjust_thing_pos(context, tid, targetPosition);
             thing.orient = targetOrientation;
 
             // Arrived at next frame. Advance to next.
@@ -501,13 +417,15 @@ void physics_presenter::update_thing_path_moving(thing_id tid, components::thing
             if(thing.current_frame == thing.goal_frame) {
                 thing.path_moving = false;
                 thing.path_move_speed = 0.0f;
-                presenter.sound_presenter->stop_foley_loop(thing_id(tid));
-                presenter.sound_presenter->play_sound_class(thing_id(tid), flags::sound_subclass_type::StopMove);
-
-                // Dispatch cog messages and resume cogs which are waiting for stop.
-                model->send_to_linked(cog::message_type::arrived,
-                                      /* sender */ thing_id(tid),
-                                      /* source */ cog::value());
+                context.effects->emplace_back([this, tid] {
+                        presenter.sound_presenter->stop_foley_loop(thing_id(tid));
+                        presenter.sound_presenter->play_sound_class(thing_id(tid), flags::sound_subclass_type::StopMove);
+
+                        // Dispatch cog messages and resume cogs which are waiting for stop.
+                        model->send_to_linked(cog::message_type::arrived,
+                                              /* sender */ thing_id(tid),
+                                              /* source */ cog::value());
+                    });
             }
             else if(thing.current_frame < thing.goal_frame) {
                 thing.next_frame = thing.current_frame + 1;
@@ -517,7 +435,7 @@ void physics_presenter::update_thing_path_moving(thing_id tid, components::thing
             }
         }
         else {
-            presenter.adjust_thing_pos(tid, lerp(thing.position, targetPosition, alpha));
+            adjust_thing_pos(context, tid, lerp(thing.position, targetPosition, alpha));
             thing.orient = slerp(thing.orient, targetOrientation, alpha);
         }
     }
@@ -539,15 +457,17 @@ void physics_presenter::update_thing_path_moving(thing_id tid, components::thing
             auto new_pos = angle.transform(thing.position - frame_pos) + frame_pos;
 
             thing.orient = angle * thing.orient;
-            presenter.adjust_thing_pos(tid, new_pos);
+            adjust_thing_pos(context, tid, new_pos);
 
-            presenter.sound_presenter->stop_foley_loop(thing_id(tid));
-            presenter.sound_presenter->play_sound_class(thing_id(tid), flags::sound_subclass_type::StopMove);
+            context.effects->emplace_back([this, tid] {
+                    presenter.sound_presenter->stop_foley_loop(thing_id(tid));
+                    presenter.sound_presenter->play_sound_class(thing_id(tid), flags::sound_subclass_type::StopMove);
 
-            // Dispatch cog messages and resume cogs which are waiting for stop.
-            model->send_to_linked(cog::message_type::arrived,
-                                  /* sender */ thing_id(tid),
-                                  /* source */ cog::value());
+                    // Dispatch cog messages and resume cogs which are waiting for stop.
+                    model->send_to_linked(cog::message_type::arrived,
+                                          /* sender */ thing_id(tid),
+                                          /* source */ cog::value());
+                });
         }
         else {
             vector<3> frame_pos, frame_orient;
@@ -562,7 +482,7 @@ void physics_presenter::update_thing_path_moving(thing_id tid, components::thing
             auto new_pos = angle.transform(thing.position - frame_pos) + frame_pos;
 
             thing.orient = angle * thing.orient;
-            presenter.adjust_thing_pos(tid, new_pos);
+            adjust_thing_pos(context, tid, new_pos);
 
             thing.path_move_time += static_cast<float>(dt);
         }
@@ -617,6 +537,63 @@ gorc::vector<3> physics_presenter::get_thing_path_moving_point_velocity(thing_id
     return make_zero_vector<3, float>();
 }
 
+void physics_presenter::adjust_thing_pos(physics_step_context& context, thing_id tid, const vector<3>& new_pos) {
+    sector_id old_sector = model->get_thing(tid).sector;
+    presenter.adjust_thing_pos(tid, new_pos, context.sector_path,
+            [this, &context](cog::message_type msg, cog::value sender, cog::value source) {
+                context.effects->emplace_back([this, msg, sender, source] {
+                        model->send_to_linked(msg, sender, source);
+                    });
+            });
+
+    if(model->get_thing(tid).sector != old_sector) {
+        context.sector_changed_things.push_back(tid);
+    }
+}
+
+void physics_presenter::physics_thing_group_step(physics_step_context& context, size_t first_thing, size_t last_thing,
+        double dt) {
+    auto const &thing_groups = physics_broadphase.groups();
+    auto thing_range_begin = thing_groups.begin() + first_thing;
+    auto thing_range_end = thing_groups.begin() + last_thing;
+
+    // - Compute minimum step size
+    double step_dt = dt;
+    for(auto const &moving_thing_pair : make_range(thing_range_begin, thing_range_end)) {
+        auto const &moving_thing = model->get_thing(moving_thing_pair.second);
+        auto moving_thing_vel_length = static_cast<double>(length(moving_thing.vel));
+        if(moving_thing_vel_length <= 0.0) {
+            step_dt = std::min(step_dt, dt);
+        }
+        else {
+            double moving_thing_step = 0.5 * static_cast<double>(moving_thing.move_size) /
+                                       static_cast<double>(length(moving_thing.vel));
+            step_dt = std::min(step_dt, moving_thing_step);
+        }
+    }
+
+    // - Update things
+    double dt_remaining = dt;
+    while(dt_remaining > 0.0) {
+        double this_step_dt = (dt_remaining > step_dt) ? step_dt : dt_remaining;
+        dt_remaining -= this_step_dt;
+
+        for(auto &moving_thing_pair : make_range(thing_range_begin, thing_range_end)) {
+            auto &moving_thing = model->get_thing(moving_thing_pair.second);
+            if(moving_thing.move == flags::move_type::physics) {
+                physics_thing_step(context,
+                                   moving_thing_pair.second,
+                                   moving_thing,
+                                   this_step_dt);
+            }
+            else if(!moving_thing.is_blocked &&
+                    (moving_thing.path_moving || moving_thing.rotatepivot_moving)) {
+                update_thing_path_moving(context, moving_thing_pair.second, moving_thing, this_step_dt);
+            }
+        }
+    }
+}
+
 void physics_presenter::update(const gorc::time& time) {
     double dt = time.elapsed_as_seconds();
 
@@ -631,7 +608,7 @@ void physics_presenter::update(const gorc::time& time) {
     }
 
     // - Calculate potentially overlapping pairs (broadphase)
-    physics_calculate_broadphase(dt);
+    physics_broadphase.update(*model, dt);
 
     // - Compute current velocity from thrust, etc.
     for(auto &thing : model->ecs.all_components<components::thing>()) {
@@ -643,52 +620,54 @@ void physics_presenter::update(const gorc::time& time) {
     }
 
     // - Rectify physics thing position vs. velocity, resting contacts, etc.
-    for(auto thing_range_begin = physics_broadphase_thing_groups.begin();
-        thing_range_begin != physics_broadphase_thing_groups.end(); ) {
-
+    // Groups are stepped concurrently. Their effects on the rest of the level are applied
+    // afterward in group order, so that the result does not depend on the worker count.
+    auto const &thing_groups = physics_broadphase.groups();
+    physics_group_ranges.clear();
+    for(size_t first_thing = 0; first_thing < thing_groups.size(); ) {
         // - Find end of group range.
-        auto thing_range_end = thing_range_begin;
-        while((thing_range_end != physics_broadphase_thing_groups.end()) &&
-              (thing_range_begin->first == thing_range_end->first)) {
-            ++thing_range_end;
+        size_t last_thing = first_thing;
+        while((last_thing < thing_groups.size()) &&
+              (thing_groups[first_thing].first == thing_groups[last_thing].first)) {
+            ++last_thing;
         }
 
-        // - Compute minimum step size
-        double step_dt = dt;
-        for(auto const &moving_thing_pair : make_range(thing_range_begin, thing_range_end)) {
-            auto const &moving_thing = model->get_thing(moving_thing_pair.second);
-            auto moving_thing_vel_length = static_cast<double>(length(moving_thing.vel));
-            if(moving_thing_vel_length <= 0.0) {
-                step_dt = std::min(step_dt, dt);
-            }
-            else {
-                double moving_thing_step = 0.5 * static_cast<double>(moving_thing.move_size) /
-                                           static_cast<double>(length(moving_thing.vel));
-                step_dt = std::min(step_dt, moving_thing_step);
-            }
+        physics_group_ranges.emplace_back(first_thing, last_thing);
+        first_thing = last_thing;
+    }
+
+    if(physics_group_effects.size() < physics_group_ranges.size()) {
+        physics_group_effects.resize(physics_group_ranges.size());
+    }
+
+    physics_workers.run(physics_group_ranges.size(), [&](size_t group, size_t thread) {
+            auto &context = *physics_step_contexts[thread];
+            context.effects = &physics_group_effects[group];
+            physics_thing_group_step(context,
+                                     std::get<0>(physics_group_ranges[group]),
+                                     std::get<1>(physics_group_ranges[group]),
+                                     dt);
+        });
+
+    for(auto &context : physics_step_contexts) {
+        physics_touched_thing_pairs.insert(context->touched_thing_pairs.begin(), context->touched_thing_pairs.end());
+        physics_touched_surface_pairs.insert(context->touched_surface_pairs.begin(), context->touched_surface_pairs.end());
+        context->touched_thing_pairs.clear();
+        context->touched_surface_pairs.clear();
+
+        for(auto tid : context->sector_changed_things) {
+            model->sector_things.set_sector(tid, model->get_thing(tid).sector);
         }
 
-        // - Update things
-        double dt_remaining = dt;
-        while(dt_remaining > 0.0) {
-            double this_step_dt = (dt_remaining > step_dt) ? step_dt : dt_remaining;
-            dt_remaining -= this_step_dt;
-
-            for(auto &moving_thing_pair : make_range(thing_range_begin, thing_range_end)) {
-                auto &moving_thing = model->get_thing(moving_thing_pair.second);
-                if(moving_thing.move == flags::move_type::physics) {
-                    physics_thing_step(moving_thing_pair.second,
-                                       moving_thing,
-                                       this_step_dt);
-                }
-                else if(!moving_thing.is_blocked &&
-                        (moving_thing.path_moving || moving_thing.rotatepivot_moving)) {
-                    update_thing_path_moving(moving_thing_pair.second, moving_thing, this_step_dt);
-                }
-            }
+        context->sector_changed_things.clear();
+    }
+
+    for(size_t i = 0; i < physics_group_ranges.size(); ++i) {
+        for(auto &effect : physics_group_effects[i]) {
+            effect();
         }
 
-        thing_range_begin = thing_range_end;
+        physics_group_effects[i].clear();
     }
 
     // - Remove thing attachment velocity.
@@ -717,18 +696,20 @@ void physics_presenter::update(const gorc::time& time) {
         thing_id tid;
         surface_id sid;
         std::tie(tid, sid) = touched_surface_pair;
-        eventbus->fire_event(events::touched_surface(tid, sid));
+        eventbus->queue_event(events::touched_surface(tid, sid));
     }
 
     for(const auto& touched_thing_pair : physics_touched_thing_pairs) {
         thing_id thing_a_id, thing_b_id;
         std::tie(thing_a_id, thing_b_id) = touched_thing_pair;
 
-        eventbus->fire_event(events::touched_thing(thing_a_id,
-                                                   thing_b_id));
-        eventbus->fire_event(events::touched_thing(thing_b_id,
-                                                   thing_a_id));
+        eventbus->queue_event(events::touched_thing(thing_a_id,
+                                                    thing_b_id));
+        eventbus->queue_event(events::touched_thing(thing_b_id,
+                                                    thing_a_id));
     }
+
+    eventbus->dispatch_queued_events();
 }
 
 physics_presenter::segment_query_node_visitor::segment_query_node_visitor(physics_presenter& presenter)
@@ -739,7 +720,14 @@ physics_presenter::segment_query_node_visitor::segment_query_node_visitor(physic
 void physics_presenter::segment_query_node_visitor::visit_mesh(asset_ref<content::assets::model> model, int mesh_id, int) {
     const auto& mesh = model->geosets.front().meshes[mesh_id];
 
-    for(const auto& face : mesh.faces) {
+    // Only faces whose bounds cross the segment can intersect it. Faces are tested in mesh order.
+    candidate_faces.clear();
+    mesh.bvh.visit([&](box<3> const &bounds) { return physics::segment_box_intersection(cam_segment, physics::transform_bounds(bounds, current_matrix)); },
+            [&](int face_index) { candidate_faces.push_back(face_index); });
+    std::sort(candidate_faces.begin(), candidate_faces.end());
+
+    for(int face_index : candidate_faces) {
+        const auto& face = mesh.faces[face_index];
         auto maybe_nearest_point = physics::segment_surface_intersection_point(cam_segment, mesh, face, current_matrix);
         maybe_if(maybe_nearest_point, [&](vector<3> const &nearest_point) {
             auto dist = length(nearest_point - std::get<0>(cam_segment));
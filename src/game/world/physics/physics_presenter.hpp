@@ -1,15 +1,17 @@
 #pragma once
 
 #include "utility/flag_set.hpp"
+#include "utility/inline_function.hpp"
+#include "utility/worker_pool.hpp"
 #include "math/vector.hpp"
 #include "game/world/components/thing.hpp"
 #include "libold/base/utility/time.hpp"
 #include "shape.hpp"
 #include "contact.hpp"
-#include <unordered_map>
-#include <map>
+#include "broadphase.hpp"
+#include "packed_surfaces.hpp"
+#include <memory>
 #include <set>
-#include <unordered_set>
 #include <vector>
 #include <tuple>
 #include "game/world/level_model.hpp"
@@ -36,29 +38,27 @@ private:
     level_model* model;
     event_bus* eventbus;
 
-    std::unordered_multimap<thing_id, sector_id> physics_broadphase_thing_influence;
-    std::unordered_multimap<sector_id, thing_id> physics_broadphase_sector_things;
-    std::unordered_map<sector_id, int> physics_broadphase_sector_group;
-    std::multimap<int, thing_id> physics_broadphase_thing_groups;
-    std::unordered_set<int> physics_broadphase_groups_to_merge;
-    std::set<thing_id> physics_overlapping_things;
-    std::vector<physics::contact> physics_thing_resting_manifolds;
-    std::set<sector_id> physics_thing_closed_set;
-    std::vector<sector_id> physics_thing_open_set;
+    physics::broadphase physics_broadphase;
+    physics::packed_surfaces physics_packed_surfaces;
     std::set<std::tuple<thing_id, thing_id>> physics_touched_thing_pairs;
     std::set<std::tuple<thing_id, surface_id>> physics_touched_surface_pairs;
     std::set<sector_id> segment_query_closed_sectors;
     std::vector<sector_id> segment_query_open_sectors;
 
-    void physics_calculate_broadphase(double dt);
-    void physics_find_sector_resting_manifolds(const physics::sphere& sphere, sector_id, const vector<3>& vel_dir, thing_id current_thing_id);
-    void physics_find_thing_resting_manifolds(const physics::sphere& sphere, const vector<3>& vel_dir, thing_id current_thing_id);
+    class physics_step_context;
+
+    void physics_find_sector_resting_manifolds(physics_step_context& context, const physics::sphere& sphere, sector_id,
+            const vector<3>& vel_dir, thing_id current_thing_id);
+    void physics_find_thing_resting_manifolds(physics_step_context& context, const physics::sphere& sphere,
+            const vector<3>& vel_dir, thing_id current_thing_id);
     void compute_current_velocity(components::thing &thing, double dt);
     void compute_thing_attachment_velocity(components::thing &thing, double dt);
-    void physics_thing_step(thing_id, components::thing& thing, double dt);
+    void physics_thing_step(physics_step_context& context, thing_id, components::thing& thing, double dt);
+    void physics_thing_group_step(physics_step_context& context, size_t first_thing, size_t last_thing, double dt);
 
-    void update_thing_path_moving(thing_id, components::thing& thing, double dt);
+    void update_thing_path_moving(physics_step_context& context, thing_id, components::thing& thing, double dt);
     vector<3> get_thing_path_moving_point_velocity(thing_id, const vector<3>& rel_point);
+    void adjust_thing_pos(physics_step_context& context, thing_id, const vector<3>& new_pos);
 
     class physics_node_visitor {
     private:
@@ -67,6 +67,7 @@ private:
         std::set<std::tuple<thing_id, thing_id>>& physics_touched_thing_pairs;
         std::stack<matrix<4>> matrices;
         matrix<4> current_matrix = make_identity_matrix<4>();
+        std::vector<int> candidate_faces;
 
     public:
         physics_node_visitor(physics_presenter& presenter, std::vector<physics::contact>& resting_manifolds,
@@ -91,13 +92,44 @@ private:
         thing_id moving_thing_id;
         thing_id visited_thing_id;
         physics::sphere sphere;
-    } physics_anim_node_visitor;
+    };
+
+    using deferred_effect_list = std::vector<inline_function<void()>>;
+
+    // Scratch space and results of one thread stepping thing groups
+    class physics_step_context {
+    public:
+        std::set<thing_id> overlapping_things;
+        std::vector<physics::contact> resting_manifolds;
+        std::set<std::tuple<thing_id, thing_id>> touched_thing_pairs;
+        std::set<std::tuple<thing_id, surface_id>> touched_surface_pairs;
+        std::vector<std::tuple<sector_id, surface_id>> sector_path;
+        physics::packed_surfaces::closest_point_list surface_points;
+        physics_node_visitor anim_node_visitor;
+
+        // Things which changed sector. The sector index is updated after every group has
+        // been stepped.
+        std::vector<thing_id> sector_changed_things;
+
+        // Effects of the current group on the rest of the level. Effects are applied after
+        // every group has been stepped.
+        deferred_effect_list* effects = nullptr;
+
+        explicit physics_step_context(physics_presenter& presenter);
+    };
+
+    // Thing groups cannot touch each other, and are stepped concurrently
+    worker_pool physics_workers;
+    std::vector<std::unique_ptr<physics_step_context>> physics_step_contexts;
+    std::vector<std::tuple<size_t, size_t>> physics_group_ranges;
+    std::vector<deferred_effect_list> physics_group_effects;
 
     class segment_query_node_visitor {
     private:
         physics_presenter& presenter;
         std::stack<matrix<4>> matrices;
         matrix<4> current_matrix = make_identity_matrix<4>();
+        std::vector<int> candidate_faces;
 
     public:
         segment_query_node_visitor(physics_presenter& presenter);
@@ -127,6 +159,7 @@ public:
     physics_presenter(level_presenter& presenter);
 
     void start(level_model& model, event_bus& eventbus);
+    void set_worker_count(size_t count);
     void update(const gorc::time& time);
 
     template <typename ThingP, typename SurfaceP> maybe<contact> segment_query(const segment& cam_segment, sector_id initial_sector, thing_id ray_cast_thing,
@@ -194,56 +227,49 @@ public:
             }
         }
 
-        // Find contact among things.
-        // Get list of things within thing influence.
-        physics_overlapping_things.clear();
+        // Find contact among things in the sectors the segment crosses.
         for(auto sector_id : segment_query_closed_sectors) {
-            auto influenced_thing_range = physics_broadphase_sector_things.equal_range(sector_id);
-            for(auto jt = std::get<0>(influenced_thing_range); jt != std::get<1>(influenced_thing_range); ++jt) {
-                physics_overlapping_things.emplace(jt->second);
-            }
-        }
+            for(auto col_thing_id : model->sector_things.things_in_sector(sector_id)) {
+                auto& col_thing = model->get_thing(col_thing_id);
 
-        for(auto col_thing_id : physics_overlapping_things) {
-            auto& col_thing = model->get_thing(col_thing_id);
+                if(col_thing_id == ray_cast_thing || !thing_p(col_thing_id)) {
+                    continue;
+                }
 
-            if(col_thing_id == ray_cast_thing || !thing_p(col_thing_id)) {
-                continue;
-            }
+                if(col_thing.collide == flags::collide_type::sphere) {
+                    auto maybe_int = segment_sphere_intersection(cam_segment, sphere(col_thing.position, col_thing.size));
+                    maybe_if(maybe_int, [&](vector<3> const &int_point) {
+                        // Sphere intersected.
+                        float col_dist = length(int_point - std::get<0>(cam_segment));
+                        if(col_dist < closest_contact_distance) {
+                            closest_contact_distance = col_dist;
+                            has_contact = true;
+                            closest_contact_surface_id = invalid_id;
+                            closest_contact_thing_id = col_thing_id;
+                            closest_contact_normal = normalize(int_point - col_thing.position);
+                            closest_contact_position = int_point;
+                        }
+                    });
+                }
+                else if(col_thing.collide == flags::collide_type::face) {
+                    if(!col_thing.model_3d.has_value()) {
+                        continue;
+                    }
+
+                    segment_query_anim_node_visitor.cam_segment = cam_segment;
+                    segment_query_anim_node_visitor.closest_contact_distance = closest_contact_distance;
+                    segment_query_anim_node_visitor.has_closest_contact = false;
+                    presenter.key_presenter->visit_mesh_hierarchy(segment_query_anim_node_visitor, col_thing.model_3d.get_value(), col_thing.position,
+                            col_thing.orient, col_thing_id, /* is pov mix */ false);
 
-            if(col_thing.collide == flags::collide_type::sphere) {
-                auto maybe_int = segment_sphere_intersection(cam_segment, sphere(col_thing.position, col_thing.size));
-                maybe_if(maybe_int, [&](vector<3> const &int_point) {
-                    // Sphere intersected.
-                    float col_dist = length(int_point - std::get<0>(cam_segment));
-                    if(col_dist < closest_contact_distance) {
-                        closest_contact_distance = col_dist;
+                    if(segment_query_anim_node_visitor.has_closest_contact) {
+                        closest_contact_distance = segment_query_anim_node_visitor.closest_contact_distance;
                         has_contact = true;
                         closest_contact_surface_id = invalid_id;
                         closest_contact_thing_id = col_thing_id;
-                        closest_contact_normal = normalize(int_point - col_thing.position);
-                        closest_contact_position = int_point;
+                        closest_contact_normal = segment_query_anim_node_visitor.closest_contact_normal;
+                        closest_contact_position = segment_query_anim_node_visitor.closest_contact;
                     }
-                });
-            }
-            else if(col_thing.collide == flags::collide_type::face) {
-                if(!col_thing.model_3d.has_value()) {
-                    continue;
-                }
-
-                segment_query_anim_node_visitor.cam_segment = cam_segment;
-                segment_query_anim_node_visitor.closest_contact_distance = closest_contact_distance;
-                segment_query_anim_node_visitor.has_closest_contact = false;
-                presenter.key_presenter->visit_mesh_hierarchy(segment_query_anim_node_visitor, col_thing.model_3d.get_value(), col_thing.position,
-                        col_thing.orient, col_thing_id, /* is pov mix */ false);
-
-                if(segment_query_anim_node_visitor.has_closest_contact) {
-                    closest_contact_distance = segment_query_anim_node_visitor.closest_contact_distance;
-                    has_contact = true;
-                    closest_contact_surface_id = invalid_id;
-                    closest_contact_thing_id = col_thing_id;
-                    closest_contact_normal = segment_query_anim_node_visitor.closest_contact_normal;
-                    closest_contact_position = segment_query_anim_node_visitor.closest_contact;
                 }
             }
         }
@@ -7,6 +7,7 @@
 #include "contact.hpp"
 #include "math/util.hpp"
 #include "math/matrix.hpp"
+#include "math/box.hpp"
 #include "game/world/level_model.hpp"
 #include "utility/maybe.hpp"
 
@@ -234,6 +235,55 @@ template <typename VertexProvider, typename EdgeProvider> maybe<float> swept_sph
     return (sphere.radius - dot(std::get<0>(sphere.position) - p, nrm)) / u;
 }
 
+// Bounds of the transformed box. The bounds are enlarged slightly, so that they contain
+// transformed points despite rounding.
+inline box<3> transform_bounds(const box<3>& bounds, const matrix<4>& trns) {
+    const float tolerance = 1.0e-4f;
+
+    auto center = trns.transform((bounds.v0 + bounds.v1) * 0.5f);
+    auto half_size = (bounds.v1 - bounds.v0) * 0.5f;
+
+    auto half_extent = make_vector(
+            std::abs(get<0, 0>(trns)) * get<0>(half_size) + std::abs(get<0, 1>(trns)) * get<1>(half_size) +
+                std::abs(get<0, 2>(trns)) * get<2>(half_size) + tolerance,
+            std::abs(get<1, 0>(trns)) * get<0>(half_size) + std::abs(get<1, 1>(trns)) * get<1>(half_size) +
+                std::abs(get<1, 2>(trns)) * get<2>(half_size) + tolerance,
+            std::abs(get<2, 0>(trns)) * get<0>(half_size) + std::abs(get<2, 1>(trns)) * get<1>(half_size) +
+                std::abs(get<2, 2>(trns)) * get<2>(half_size) + tolerance);
+
+    return make_box(center - half_extent, center + half_extent);
+}
+
+inline bool segment_box_intersection(const segment& segment, const box<3>& bounds) {
+    float u0 = 0.0f;
+    float u1 = 1.0f;
+
+    auto st = std::get<0>(segment).begin();
+    auto et = std::get<1>(segment).begin();
+    auto lt = bounds.v0.begin();
+    auto ht = bounds.v1.begin();
+    for(; lt != bounds.v0.end(); ++st, ++et, ++lt, ++ht) {
+        auto dir = *et - *st;
+        if(dir == 0.0f) {
+            if(*st < *lt || *st > *ht) {
+                return false;
+            }
+
+            continue;
+        }
+
+        auto ul = (*lt - *st) / dir;
+        auto uh = (*ht - *st) / dir;
+        u0 = std::max(u0, std::min(ul, uh));
+        u1 = std::min(u1, std::max(ul, uh));
+        if(u0 > u1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 inline maybe<vector<3>> segment_sphere_intersection(const segment& segment, const sphere& sphere) {
     auto v = std::get<1>(segment) - std::get<0>(segment);
     auto w = std::get<0>(segment) - sphere.position;
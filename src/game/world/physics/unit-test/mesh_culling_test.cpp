@@ -0,0 +1,246 @@
+#include "test/test.hpp"
+#include "game/world/physics/query.hpp"
+#include "libold/content/assets/model_mesh.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace gorc;
+using namespace gorc::game::world::physics;
+
+namespace {
+    using content::assets::model_face;
+    using content::assets::model_mesh;
+    using content::assets::model_mesh_bvh;
+
+    void add_face(model_mesh &mesh,
+                  vector<3> const &center,
+                  vector<3> const &normal,
+                  int vertex_count,
+                  float radius)
+    {
+        auto tangent = normalize(cross(normal, make_vector(0.3f, 0.5f, 0.8f)));
+        auto bitangent = cross(normal, tangent);
+
+        model_face face;
+        face.normal = normal;
+        for(int i = 0; i < vertex_count; ++i) {
+            float angle = 6.2831853f * static_cast<float>(i) / static_cast<float>(vertex_count);
+            mesh.vertices.push_back(center +
+                                    tangent * (radius * std::cos(angle)) +
+                                    bitangent * (radius * std::sin(angle)));
+            face.vertices.emplace_back(mesh.vertices.size() - 1, 0);
+        }
+
+        mesh.faces.push_back(face);
+    }
+
+    template <typename OverlapP>
+    std::vector<int> candidate_faces(model_mesh const &mesh, OverlapP overlaps)
+    {
+        std::vector<int> rv;
+        mesh.bvh.visit(overlaps, [&](int face) { rv.push_back(face); });
+        std::sort(rv.begin(), rv.end());
+        return rv;
+    }
+
+    std::vector<int> sphere_hits(model_mesh const &mesh,
+                                 std::vector<int> const &faces,
+                                 matrix<4> const &trns,
+                                 vector<3> const &position,
+                                 float radius)
+    {
+        std::vector<int> rv;
+        for(int face : faces) {
+            auto point = bounded_closest_point_on_surface(position,
+                                                          mesh,
+                                                          mesh.faces[face],
+                                                          trns,
+                                                          radius);
+            maybe_if(point, [&](vector<3> const &p) {
+                    if(length(position - p) <= radius) {
+                        rv.push_back(face);
+                    }
+                });
+        }
+
+        return rv;
+    }
+
+    std::vector<int> segment_hits(model_mesh const &mesh,
+                                  std::vector<int> const &faces,
+                                  matrix<4> const &trns,
+                                  segment const &seg)
+    {
+        std::vector<int> rv;
+        for(int face : faces) {
+            if(segment_surface_intersection_point(seg, mesh, mesh.faces[face], trns).has_value()) {
+                rv.push_back(face);
+            }
+        }
+
+        return rv;
+    }
+
+    std::vector<int> all_faces(model_mesh const &mesh)
+    {
+        std::vector<int> rv;
+        for(size_t i = 0; i < mesh.faces.size(); ++i) {
+            rv.push_back(static_cast<int>(i));
+        }
+
+        return rv;
+    }
+
+    int tree_depth(model_mesh_bvh const &bvh, int index)
+    {
+        auto const &current = bvh.nodes[index];
+        if(current.count > 0) {
+            return 1;
+        }
+
+        return 1 + std::max(tree_depth(bvh, index + 1), tree_depth(bvh, current.first));
+    }
+}
+
+begin_suite(mesh_culling_test);
+
+test_case(segment_box_zero_direction)
+{
+    auto bounds = make_box(make_vector(0.0f, 0.0f, 0.0f), make_vector(1.0f, 1.0f, 1.0f));
+
+    // Parallel to the x and y slabs
+    assert_true(segment_box_intersection(segment(make_vector(0.5f, 0.5f, -1.0f),
+                                                 make_vector(0.5f, 0.5f, 2.0f)),
+                                         bounds));
+    assert_true(!segment_box_intersection(segment(make_vector(1.5f, 0.5f, -1.0f),
+                                                  make_vector(1.5f, 0.5f, 2.0f)),
+                                          bounds));
+    assert_true(segment_box_intersection(segment(make_vector(1.0f, 0.0f, -1.0f),
+                                                 make_vector(1.0f, 0.0f, 2.0f)),
+                                         bounds));
+
+    // Degenerate segments
+    assert_true(segment_box_intersection(segment(make_vector(0.5f, 0.5f, 0.5f),
+                                                 make_vector(0.5f, 0.5f, 0.5f)),
+                                         bounds));
+    assert_true(!segment_box_intersection(segment(make_vector(0.5f, 0.5f, 1.5f),
+                                                  make_vector(0.5f, 0.5f, 1.5f)),
+                                          bounds));
+}
+
+test_case(matches_brute_force)
+{
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    size_t sphere_hit_count = 0;
+    size_t segment_hit_count = 0;
+    for(int trial = 0; trial < 100; ++trial) {
+        model_mesh mesh;
+        int face_count = 1 + static_cast<int>(rng() % 200);
+        for(int i = 0; i < face_count; ++i) {
+            add_face(mesh,
+                     make_vector(dist(rng), dist(rng), dist(rng)) * 0.5f,
+                     normalize(make_vector(dist(rng), dist(rng), dist(rng))),
+                     3 + static_cast<int>(rng() % 3),
+                     0.02f + 0.1f * std::abs(dist(rng)));
+        }
+
+        mesh.bvh.build(mesh.vertices, mesh.faces);
+        auto faces = all_faces(mesh);
+
+        for(int i = 0; i < 50; ++i) {
+            // Every fourth query is made in mesh space, so that segment components stay zero
+            auto trns = make_identity_matrix<4>();
+            if(i % 4 != 0) {
+                trns = make_translation_matrix(make_vector(dist(rng), dist(rng), dist(rng)) * 50.0f) *
+                       make_rotation_matrix(180.0f * dist(rng),
+                                            normalize(make_vector(dist(rng), dist(rng), dist(rng))));
+            }
+
+            auto position = trns.transform(make_vector(dist(rng), dist(rng), dist(rng)) * 0.6f);
+            float radius = 0.05f + 0.1f * std::abs(dist(rng));
+            auto extent = make_fill_vector<3>(radius);
+            auto sphere_bounds = make_box(position - extent, position + extent);
+
+            auto sphere_candidates = candidate_faces(mesh, [&](box<3> const &bounds) {
+                    return transform_bounds(bounds, trns).overlaps(sphere_bounds);
+                });
+
+            auto expected = sphere_hits(mesh, faces, trns, position, radius);
+            assert_range_eq(sphere_hits(mesh, sphere_candidates, trns, position, radius),
+                            expected);
+            sphere_hit_count += expected.size();
+
+            auto end = make_vector(dist(rng), dist(rng), dist(rng)) * 0.6f;
+            if(i % 4 == 0) {
+                // Zero direction along one or two axes
+                get<0>(end) = get<0>(position);
+                if(i % 8 == 0) {
+                    get<1>(end) = get<1>(position);
+                }
+            }
+            else {
+                end = trns.transform(end);
+            }
+
+            auto seg = segment(position, end);
+            auto segment_candidates = candidate_faces(mesh, [&](box<3> const &bounds) {
+                    return segment_box_intersection(seg, transform_bounds(bounds, trns));
+                });
+
+            expected = segment_hits(mesh, faces, trns, seg);
+            assert_range_eq(segment_hits(mesh, segment_candidates, trns, seg), expected);
+            segment_hit_count += expected.size();
+        }
+    }
+
+    assert_true(sphere_hit_count > 100UL);
+    assert_true(segment_hit_count > 100UL);
+}
+
+test_case(deep_mesh)
+{
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    // A large mesh, and a stack of coincident faces which cannot be separated
+    model_mesh mesh;
+    for(int i = 0; i < 60000; ++i) {
+        add_face(mesh,
+                 make_vector(dist(rng), dist(rng), dist(rng)) * 10.0f,
+                 normalize(make_vector(dist(rng), dist(rng), dist(rng))),
+                 3,
+                 0.05f);
+    }
+
+    for(int i = 0; i < 4000; ++i) {
+        add_face(mesh, make_zero_vector<3, float>(), make_vector(0.0f, 0.0f, 1.0f), 4, 0.5f);
+    }
+
+    mesh.bvh.build(mesh.vertices, mesh.faces);
+
+    int depth = tree_depth(mesh.bvh, 0);
+    assert_true(depth > 14);
+    assert_true(depth < 64);
+
+    // Every face is reached exactly once
+    auto faces = all_faces(mesh);
+    auto visited_faces = candidate_faces(mesh, [](box<3> const &) { return true; });
+    assert_range_eq(visited_faces, faces);
+
+    auto trns = make_identity_matrix<4>();
+    auto seg = segment(make_vector(0.1f, 0.2f, -10.0f), make_vector(0.1f, 0.2f, 10.0f));
+    auto segment_candidates = candidate_faces(mesh, [&](box<3> const &bounds) {
+            return segment_box_intersection(seg, transform_bounds(bounds, trns));
+        });
+
+    auto expected = segment_hits(mesh, faces, trns, seg);
+    assert_true(expected.size() >= 4000UL);
+    assert_true(segment_candidates.size() < faces.size() / 4);
+    assert_range_eq(segment_hits(mesh, segment_candidates, trns, seg), expected);
+}
+
+end_suite(mesh_culling_test);
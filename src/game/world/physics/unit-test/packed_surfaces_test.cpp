@@ -0,0 +1,214 @@
+#include "test/test.hpp"
+#include "game/world/physics/packed_surfaces.hpp"
+#include "game/world/physics/query.hpp"
+#include <cmath>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using namespace gorc;
+using namespace gorc::game::world::physics;
+
+namespace {
+    class mock_level {
+    public:
+        std::vector<vector<3>> vertices;
+    };
+
+    class mock_surface {
+    public:
+        std::vector<std::tuple<int, int, float>> vertices;
+        vector<3> normal;
+    };
+
+    // Regular polygon about center, in the plane with the given normal
+    mock_surface make_polygon(mock_level &level,
+                              vector<3> const &center,
+                              vector<3> const &normal,
+                              int vertex_count,
+                              float radius)
+    {
+        auto tangent = normalize(cross(normal, make_vector(0.3f, 0.5f, 0.8f)));
+        auto bitangent = cross(normal, tangent);
+
+        mock_surface rv;
+        rv.normal = normal;
+        for(int i = 0; i < vertex_count; ++i) {
+            float angle = 6.2831853f * static_cast<float>(i) / static_cast<float>(vertex_count);
+            level.vertices.push_back(center +
+                                     tangent * (radius * std::cos(angle)) +
+                                     bitangent * (radius * std::sin(angle)));
+            rv.vertices.emplace_back(static_cast<int>(level.vertices.size() - 1), 0, 0.0f);
+        }
+
+        return rv;
+    }
+
+    packed_surfaces::closest_point_list reference_closest_points(
+            mock_level const &level,
+            std::vector<mock_surface> const &surfaces,
+            int first_id,
+            vector<3> const &origin,
+            float max_dist)
+    {
+        packed_surfaces::closest_point_list rv;
+        for(size_t i = 0; i < surfaces.size(); ++i) {
+            auto point = bounded_closest_point_on_surface(origin, level, surfaces[i], max_dist);
+            maybe_if(point, [&](vector<3> const &p) {
+                    rv.emplace_back(surface_id(first_id + static_cast<int>(i)), p);
+                });
+        }
+
+        return rv;
+    }
+
+    bool same_points(packed_surfaces::closest_point_list const &a,
+                     packed_surfaces::closest_point_list const &b)
+    {
+        if(a.size() != b.size()) {
+            return false;
+        }
+
+        for(size_t i = 0; i < a.size(); ++i) {
+            if(std::get<0>(a[i]) != std::get<0>(b[i]) ||
+               !(std::get<1>(a[i]) == std::get<1>(b[i]))) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+begin_suite(packed_surfaces_test);
+
+test_case(inside_and_edge)
+{
+    mock_level level;
+    std::vector<mock_surface> surfaces;
+    surfaces.push_back(make_polygon(level,
+                                    make_vector(0.0f, 0.0f, 0.0f),
+                                    make_vector(0.0f, 0.0f, 1.0f),
+                                    4,
+                                    1.0f));
+
+    packed_surfaces ps;
+    ps.add_sector();
+    ps.add_surface(level, surfaces[0], surface_id(0));
+
+    packed_surfaces::closest_point_list points;
+
+    // Above the polygon
+    auto origin = make_vector(0.1f, 0.1f, 0.5f);
+    ps.closest_points(0, origin, 1.0f, points);
+    assert_eq(points.size(), 1UL);
+    assert_true(length(std::get<1>(points[0]) - make_vector(0.1f, 0.1f, 0.0f)) < 1.0e-5f);
+    assert_true(same_points(points, reference_closest_points(level, surfaces, 0, origin, 1.0f)));
+
+    // Beside the polygon, within range of its plane
+    points.clear();
+    origin = make_vector(2.0f, 0.2f, 0.5f);
+    ps.closest_points(0, origin, 1.0f, points);
+    assert_true(same_points(points, reference_closest_points(level, surfaces, 0, origin, 1.0f)));
+
+    // Behind the polygon, and too far in front of it
+    points.clear();
+    ps.closest_points(0, make_vector(0.1f, 0.1f, -0.5f), 1.0f, points);
+    ps.closest_points(0, make_vector(0.1f, 0.1f, 1.5f), 1.0f, points);
+    assert_true(points.empty());
+}
+
+test_case(sectors)
+{
+    mock_level level;
+    std::vector<mock_surface> first_sector;
+    std::vector<mock_surface> second_sector;
+
+    packed_surfaces ps;
+    ps.add_sector();
+    for(int i = 0; i < 5; ++i) {
+        first_sector.push_back(make_polygon(level,
+                                            make_vector(0.0f, 0.0f, -0.1f * i),
+                                            make_vector(0.0f, 0.0f, 1.0f),
+                                            3 + i,
+                                            1.0f));
+        ps.add_surface(level, first_sector.back(), surface_id(i));
+    }
+
+    ps.add_sector();
+    second_sector.push_back(make_polygon(level,
+                                         make_vector(0.0f, 0.0f, 0.0f),
+                                         make_vector(1.0f, 0.0f, 0.0f),
+                                         4,
+                                         1.0f));
+    ps.add_surface(level, second_sector.back(), surface_id(5));
+
+    auto origin = make_vector(0.2f, 0.1f, 0.3f);
+
+    packed_surfaces::closest_point_list points;
+    ps.closest_points(0, origin, 1.0f, points);
+    assert_eq(points.size(), 5UL);
+    assert_true(same_points(points,
+                            reference_closest_points(level, first_sector, 0, origin, 1.0f)));
+
+    points.clear();
+    ps.closest_points(1, origin, 1.0f, points);
+    assert_eq(points.size(), 1UL);
+    assert_true(same_points(points,
+                            reference_closest_points(level, second_sector, 5, origin, 1.0f)));
+
+    points.clear();
+    ps.scalar_closest_points(1, origin, 1.0f, points);
+    assert_true(same_points(points,
+                            reference_closest_points(level, second_sector, 5, origin, 1.0f)));
+}
+
+test_case(matches_reference)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    size_t hits = 0;
+    for(int trial = 0; trial < 500; ++trial) {
+        mock_level level;
+        std::vector<mock_surface> surfaces;
+
+        packed_surfaces ps;
+        ps.add_sector();
+
+        // Surface and vertex counts cover full and partial lane groups
+        int surface_count = 1 + static_cast<int>(rng() % 11);
+        for(int i = 0; i < surface_count; ++i) {
+            auto normal = normalize(make_vector(dist(rng), dist(rng), dist(rng)));
+            auto center = make_vector(dist(rng), dist(rng), dist(rng));
+            int vertex_count = 3 + static_cast<int>(rng() % 6);
+            surfaces.push_back(make_polygon(level,
+                                            center,
+                                            normal,
+                                            vertex_count,
+                                            0.5f + 0.3f * dist(rng)));
+            ps.add_surface(level, surfaces.back(), surface_id(i));
+        }
+
+        for(int i = 0; i < 20; ++i) {
+            auto origin = make_vector(dist(rng), dist(rng), dist(rng)) * 1.5f;
+            float max_dist = 0.4f + 0.2f * dist(rng);
+
+            packed_surfaces::closest_point_list points;
+            ps.closest_points(0, origin, max_dist, points);
+
+            packed_surfaces::closest_point_list scalar_points;
+            ps.scalar_closest_points(0, origin, max_dist, scalar_points);
+
+            auto expected = reference_closest_points(level, surfaces, 0, origin, max_dist);
+            assert_true(same_points(points, expected));
+            assert_true(same_points(scalar_points, expected));
+            hits += expected.size();
+        }
+    }
+
+    // The queries must reach both the inside and edge cases
+    assert_true(hits > 1000UL);
+}
+
+end_suite(packed_surfaces_test);
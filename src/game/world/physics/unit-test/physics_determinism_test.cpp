@@ -0,0 +1,417 @@
+#include "test/test.hpp"
+#include "game/level_state.hpp"
+#include "game/world/level_model.hpp"
+#include "game/world/level_presenter.hpp"
+#include "game/world/events/touched_surface.hpp"
+#include "game/world/events/touched_thing.hpp"
+#include "content/content_manager.hpp"
+#include "content/loader.hpp"
+#include "content/loader_registry.hpp"
+#include "io/memory_file.hpp"
+#include "jk/cog/compiler/script_loader.hpp"
+#include "jk/content/inventory.hpp"
+#include "libold/content/assets/level.hpp"
+#include "vfs/virtual_file_system.hpp"
+#include <cstring>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace gorc;
+using namespace gorc::game;
+using namespace gorc::game::world;
+
+namespace {
+    // Records crossed, entered and arrived messages through test verbs.
+    char const *recorder_cog =
+        "symbols\n"
+        "message crossed\n"
+        "message entered\n"
+        "message arrived\n"
+        "surface adjoin mask=0xfff\n"
+        "sector room mask=0xfff\n"
+        "thing door mask=0xfff\n"
+        "end\n"
+        "code\n"
+        "crossed:\n"
+        "    recordcrossed(getsenderref(), getsourceref());\n"
+        "    return;\n"
+        "entered:\n"
+        "    recordentered(getsenderref(), getsourceref());\n"
+        "    return;\n"
+        "arrived:\n"
+        "    recordarrived(getsenderref());\n"
+        "    return;\n"
+        "end\n";
+
+    class mock_vfs : public virtual_file_system {
+    private:
+        memory_file recorder_mf;
+        memory_file empty_mf;
+
+    public:
+        mock_vfs()
+        {
+            recorder_mf.write(recorder_cog, std::strlen(recorder_cog));
+        }
+
+        virtual std::unique_ptr<input_stream> open(path const &p) const override
+        {
+            if(p.filename() == "recorder.cog") {
+                return std::make_unique<memory_file::reader>(recorder_mf);
+            }
+
+            return std::make_unique<memory_file::reader>(empty_mf);
+        }
+
+        virtual std::tuple<path, std::unique_ptr<input_stream>>
+            find(path const &p, std::vector<path> const &) const override
+        {
+            return std::make_tuple(p, open(p));
+        }
+    };
+
+    class mock_inventory_loader : public loader {
+    public:
+        static fourcc const type;
+
+        virtual std::vector<path> const &get_prefixes() const override
+        {
+            static std::vector<path> rv = {""};
+            return rv;
+        }
+
+        virtual std::unique_ptr<asset> deserialize(input_stream &,
+                                                   content_manager &,
+                                                   asset_id,
+                                                   service_registry const &,
+                                                   std::string const &) const override
+        {
+            return std::make_unique<gorc::inventory>();
+        }
+    };
+
+    fourcc const mock_inventory_loader::type = "IBIN"_4CC;
+
+    // Adds a rectangle centered on face_center. The tangent and bitangent are half extents,
+    // and must wind counterclockwise about the normal.
+    void add_face(content::assets::level &lev,
+                  content::assets::level_sector &sec,
+                  vector<3> const &face_center,
+                  vector<3> const &normal,
+                  vector<3> const &tangent,
+                  vector<3> const &bitangent)
+    {
+        content::assets::level_surface surf;
+        surf.material = -1;
+        surf.geometry_mode = flags::geometry_mode::solid;
+        surf.light_mode = flags::light_mode::fully_lit;
+        surf.texture_mode = flags::texture_mode::AffineMapping;
+        surf.adjoin = -1;
+        surf.adjoined_sector = invalid_id;
+        surf.extra_light = 0.0f;
+        surf.normal = normal;
+        surf.texture_offset = make_zero_vector<2, float>();
+        surf.thrust = make_zero_vector<3, float>();
+
+        for(auto const &corner : { -tangent - bitangent,
+                                   tangent - bitangent,
+                                   tangent + bitangent,
+                                   bitangent - tangent }) {
+            lev.vertices.push_back(face_center + corner);
+            sec.vertices.push_back(lev.vertices.size() - 1);
+            surf.vertices.emplace_back(static_cast<int>(lev.vertices.size() - 1), 0, 0.0f);
+        }
+
+        lev.surfaces.push_back(surf);
+        ++sec.surface_count;
+    }
+
+    // Axis aligned box sector, with inward facing surfaces in the order -x, +x, -y, +y, -z, +z
+    void add_box_sector(content::assets::level &lev, vector<3> const &min, vector<3> const &max)
+    {
+        content::assets::level_sector sec;
+        sec.number = sector_id(static_cast<int>(lev.sectors.size()));
+        sec.ambient_light = 1.0f;
+        sec.extra_light = 0.0f;
+        sec.colormap_id = 0;
+        sec.tint = make_color(0.0f, 0.0f, 0.0f);
+        sec.bounding_box = make_box(min, max);
+        sec.collide_box = make_box(min, max);
+        sec.center = (min + max) * 0.5f;
+        sec.radius = length(max - min) * 0.5f;
+        sec.first_surface = static_cast<int>(lev.surfaces.size());
+        sec.surface_count = 0;
+        sec.thrust = make_zero_vector<3, float>();
+
+        auto c = sec.center;
+        auto ex = make_vector(get<0>(max - min) * 0.5f, 0.0f, 0.0f);
+        auto ey = make_vector(0.0f, get<1>(max - min) * 0.5f, 0.0f);
+        auto ez = make_vector(0.0f, 0.0f, get<2>(max - min) * 0.5f);
+
+        add_face(lev, sec, c - ex, make_vector(1.0f, 0.0f, 0.0f), ey, ez);
+        add_face(lev, sec, c + ex, make_vector(-1.0f, 0.0f, 0.0f), ey, -ez);
+        add_face(lev, sec, c - ey, make_vector(0.0f, 1.0f, 0.0f), ez, ex);
+        add_face(lev, sec, c + ey, make_vector(0.0f, -1.0f, 0.0f), ez, -ex);
+        add_face(lev, sec, c - ez, make_vector(0.0f, 0.0f, 1.0f), ex, ey);
+        add_face(lev, sec, c + ez, make_vector(0.0f, 0.0f, -1.0f), ex, -ey);
+
+        lev.sectors.push_back(sec);
+    }
+
+    // Joins the +x surface of sector a to the -x surface of sector b
+    std::tuple<surface_id, surface_id> adjoin_sectors(content::assets::level &lev, int a, int b)
+    {
+        int a_surf = lev.sectors[a].first_surface + 1;
+        int b_surf = lev.sectors[b].first_surface;
+
+        content::assets::level_adjoin adj;
+        adj.flags = flag_set<flags::adjoin_flag> { flags::adjoin_flag::Visible,
+                                                   flags::adjoin_flag::AllowMovement };
+        adj.distance = 0.0f;
+
+        adj.mirror = static_cast<int>(lev.adjoins.size()) + 1;
+        lev.adjoins.push_back(adj);
+        lev.surfaces[a_surf].adjoin = static_cast<int>(lev.adjoins.size()) - 1;
+        lev.surfaces[a_surf].adjoined_sector = sector_id(b);
+
+        adj.mirror = static_cast<int>(lev.adjoins.size()) - 1;
+        lev.adjoins.push_back(adj);
+        lev.surfaces[b_surf].adjoin = static_cast<int>(lev.adjoins.size()) - 1;
+        lev.surfaces[b_surf].adjoined_sector = sector_id(a);
+
+        return std::make_tuple(surface_id(a_surf), surface_id(b_surf));
+    }
+
+    content::assets::thing_template make_actor(int sector, vector<3> const &pos, vector<3> const &vel)
+    {
+        content::assets::thing_template rv;
+        rv.type = flags::thing_type::Actor;
+        rv.move = flags::move_type::physics;
+        rv.collide = flags::collide_type::sphere;
+        rv.physics_flags = flag_set<flags::physics_flag> { flags::physics_flag::has_gravity };
+        rv.size = 0.1f;
+        rv.move_size = 0.1f;
+        rv.sector = sector_id(sector);
+        rv.position = pos;
+        rv.vel = vel;
+        return rv;
+    }
+
+    content::assets::thing_template make_door(int sector, vector<3> const &from, vector<3> const &to)
+    {
+        content::assets::thing_template rv;
+        rv.type = flags::thing_type::cog;
+        rv.move = flags::move_type::Path;
+        rv.collide = flags::collide_type::sphere;
+        rv.size = 0.2f;
+        rv.move_size = 0.05f;
+        rv.sector = sector_id(sector);
+        rv.position = from;
+        rv.frames.emplace_back(from, make_zero_vector<3, float>());
+        rv.frames.emplace_back(to, make_zero_vector<3, float>());
+        return rv;
+    }
+
+    int const room_count = 4;
+
+    // Each room holds two adjoined sectors, two actors which collide while crossing the
+    // adjoin, and a door which moves across their path. Rooms are far enough apart to be
+    // stepped as separate physics groups.
+    class mock_level_loader : public loader {
+    public:
+        static fourcc const type;
+
+        virtual std::vector<path> const &get_prefixes() const override
+        {
+            static std::vector<path> rv = {""};
+            return rv;
+        }
+
+        virtual std::unique_ptr<asset> deserialize(input_stream &,
+                                                   content_manager &content,
+                                                   asset_id,
+                                                   service_registry const &,
+                                                   std::string const &) const override
+        {
+            auto lev = std::make_unique<content::assets::level>();
+            auto recorder = content.load<cog::script>("recorder.cog");
+
+            // Things are created in level order, so the doors have predictable ids.
+            int next_thing = 0;
+            for(int i = 0; i < room_count; ++i) {
+                float y = 10.0f * static_cast<float>(i);
+                int a = static_cast<int>(lev->sectors.size());
+                add_box_sector(*lev, make_vector(0.0f, y, 0.0f), make_vector(2.0f, y + 2.0f, 2.0f));
+                add_box_sector(*lev, make_vector(2.0f, y, 0.0f), make_vector(4.0f, y + 2.0f, 2.0f));
+                auto adjoin = std::get<0>(adjoin_sectors(*lev, a, a + 1));
+
+                lev->things.push_back(make_actor(a,
+                                                 make_vector(1.0f, y + 1.0f, 0.3f),
+                                                 make_vector(1.5f + 0.1f * static_cast<float>(i), 0.05f, 0.0f)));
+                lev->things.push_back(make_actor(a + 1,
+                                                 make_vector(3.5f, y + 1.1f, 0.3f),
+                                                 make_vector(-1.0f, 0.0f, 0.0f)));
+                lev->things.push_back(make_door(a + 1,
+                                                make_vector(3.0f, y + 0.4f, 0.3f),
+                                                make_vector(3.0f, y + 1.6f, 0.3f)));
+                thing_id door(next_thing + 2);
+                next_thing += 3;
+
+                lev->cogs.emplace_back(recorder,
+                                       std::vector<cog::value> { adjoin, sector_id(a + 1), door });
+            }
+
+            // The player spawns alone in a distant sector.
+            int spawn = static_cast<int>(lev->sectors.size());
+            add_box_sector(*lev, make_vector(100.0f, 0.0f, 0.0f), make_vector(102.0f, 2.0f, 2.0f));
+
+            content::assets::thing_template player;
+            player.type = flags::thing_type::Player;
+            player.sector = sector_id(spawn);
+            player.position = make_vector(101.0f, 1.0f, 1.0f);
+            lev->things.push_back(player);
+
+            return std::move(lev);
+        }
+    };
+
+    fourcc const mock_level_loader::type = "JKL"_4CC;
+
+    class thing_state {
+    public:
+        vector<3> position;
+        vector<3> vel;
+        quaternion<float> orient;
+        sector_id sector;
+
+        bool operator==(thing_state const &s) const
+        {
+            return position == s.position &&
+                   vel == s.vel &&
+                   get<0>(orient) == get<0>(s.orient) &&
+                   get<1>(orient) == get<1>(s.orient) &&
+                   get<2>(orient) == get<2>(s.orient) &&
+                   get<3>(orient) == get<3>(s.orient) &&
+                   sector == s.sector;
+        }
+    };
+
+    // Each event is (kind, sender, source). Touched things and surfaces are kinds 3 and 4.
+    using event_record = std::tuple<int, int, int>;
+
+    class level_run {
+    public:
+        std::vector<std::vector<thing_state>> frames;
+        std::vector<event_record> events;
+    };
+
+    class physics_determinism_fixture : public test::fixture {
+    public:
+        service_registry services;
+        loader_registry loaders;
+        mock_vfs vfs;
+        event_bus bus;
+
+        physics_determinism_fixture()
+        {
+            loaders.emplace_loader<cog::script_loader>();
+            loaders.emplace_loader<mock_inventory_loader>();
+            loaders.emplace_loader<mock_level_loader>();
+            services.add(loaders);
+            services.add<virtual_file_system>(vfs);
+            services.add(bus);
+        }
+
+        level_run run_level(size_t physics_worker_count)
+        {
+            level_run rv;
+
+            level_state components(services);
+            components.verbs.add_verb("recordcrossed", [&rv](surface_id sender, thing_id source) {
+                    rv.events.emplace_back(0, static_cast<int>(sender), static_cast<int>(source));
+                });
+
+            components.verbs.add_verb("recordentered", [&rv](sector_id sender, thing_id source) {
+                    rv.events.emplace_back(1, static_cast<int>(sender), static_cast<int>(source));
+                });
+
+            components.verbs.add_verb("recordarrived", [&rv](thing_id sender) {
+                    rv.events.emplace_back(2, static_cast<int>(sender), -1);
+                });
+
+            auto touched_thing_delegate = bus.add_handler<events::touched_thing>(
+                    [&rv](events::touched_thing const &e) {
+                    rv.events.emplace_back(3, static_cast<int>(e.toucher), static_cast<int>(e.touched));
+                });
+
+            auto touched_surface_delegate = bus.add_handler<events::touched_surface>(
+                    [&rv](events::touched_surface const &e) {
+                    rv.events.emplace_back(4, static_cast<int>(e.toucher), static_cast<int>(e.touched));
+                });
+
+            auto contentmanager = std::make_shared<content_manager>(components.services);
+            auto lev = contentmanager->load<content::assets::level>("rooms.jkl");
+
+            level_presenter presenter(components, level_place(contentmanager, lev, physics_worker_count));
+            presenter.start(bus);
+
+            for(int i = 0; i < room_count; ++i) {
+                presenter.move_to_frame(thing_id(i * 3 + 2), 1, 8.0f);
+            }
+
+            for(uint32_t frame = 1; frame <= 90; ++frame) {
+                presenter.update(gorc::time(timestamp(frame * 33), timestamp((frame - 1) * 33)));
+
+                rv.frames.emplace_back();
+                for(auto const &thing : presenter.model->ecs.all_components<components::thing>()) {
+                    rv.frames.back().push_back(thing_state { thing.second->position,
+                                                             thing.second->vel,
+                                                             thing.second->orient,
+                                                             thing.second->sector });
+                }
+            }
+
+            return rv;
+        }
+    };
+
+    bool has_event(level_run const &run, int kind)
+    {
+        for(auto const &e : run.events) {
+            if(std::get<0>(e) == kind) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+begin_suite_fixture(physics_determinism_test, physics_determinism_fixture);
+
+test_case(worker_count_does_not_change_results)
+{
+    auto serial = run_level(0);
+
+    // The scene must exercise every kind of event.
+    assert_true(has_event(serial, 0));
+    assert_true(has_event(serial, 1));
+    assert_true(has_event(serial, 2));
+    assert_true(has_event(serial, 3));
+    assert_true(has_event(serial, 4));
+
+    for(size_t workers : { 1UL, 3UL }) {
+        auto parallel = run_level(workers);
+
+        assert_eq(parallel.frames.size(), serial.frames.size());
+        for(size_t i = 0; i < serial.frames.size(); ++i) {
+            assert_true((parallel.frames[i] == serial.frames[i]));
+        }
+
+        assert_true((parallel.events == serial.events));
+    }
+}
+
+end_suite(physics_determinism_test);
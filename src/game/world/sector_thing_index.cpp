@@ -0,0 +1,115 @@
+#include "sector_thing_index.hpp"
+#include "components/thing.hpp"
+#include "ecs/generational_entity_generator.hpp"
+#include <algorithm>
+
+using namespace gorc::game::world;
+
+sector_thing_index::sector_thing_index(entity_component_system<thing_id>& ecs, size_t sector_count)
+    : ecs(ecs), sector_things(sector_count) {
+    ecs.add_component_observer<components::thing>(this);
+}
+
+sector_thing_index::~sector_thing_index() {
+    ecs.remove_component_observer<components::thing>(this);
+}
+
+void sector_thing_index::remove_from_sector(thing_id tid, sector_id sid) {
+    int index = static_cast<int>(sid);
+    if(index < 0 || static_cast<size_t>(index) >= sector_things.size()) {
+        return;
+    }
+
+    auto &things = sector_things[index];
+    auto it = std::lower_bound(things.begin(), things.end(), tid);
+    if(it != things.end() && *it == tid) {
+        things.erase(it);
+    }
+}
+
+void sector_thing_index::set_sector(thing_id tid, sector_id sid) {
+    size_t slot = entity_slot(tid);
+    if(slot >= thing_sectors.size()) {
+        thing_sectors.resize(slot + 1, std::make_pair(thing_id(), sector_id()));
+    }
+
+    auto &entry = thing_sectors[slot];
+    if(entry.first == tid && entry.second == sid) {
+        return;
+    }
+
+    if(entry.first.is_valid()) {
+        remove_from_sector(entry.first, entry.second);
+    }
+
+    entry = std::make_pair(tid, sid);
+
+    int index = static_cast<int>(sid);
+    if(index < 0 || static_cast<size_t>(index) >= sector_things.size()) {
+        // Thing is not in a sector.
+        return;
+    }
+
+    auto &things = sector_things[index];
+    things.insert(std::lower_bound(things.begin(), things.end(), tid), tid);
+}
+
+void sector_thing_index::erase(thing_id tid) {
+    size_t slot = entity_slot(tid);
+    if(slot >= thing_sectors.size() || thing_sectors[slot].first != tid) {
+        return;
+    }
+
+    auto &entry = thing_sectors[slot];
+    remove_from_sector(entry.first, entry.second);
+    entry = std::make_pair(thing_id(), sector_id());
+}
+
+std::vector<gorc::thing_id> const& sector_thing_index::things_in_sector(sector_id sid) const {
+    int index = static_cast<int>(sid);
+    if(index < 0 || static_cast<size_t>(index) >= sector_things.size()) {
+        return empty_things;
+    }
+
+    return sector_things[index];
+}
+
+gorc::thing_id sector_thing_index::next_thing_in_sector(thing_id tid) const {
+    size_t slot = entity_slot(tid);
+    if(slot >= thing_sectors.size() || thing_sectors[slot].first != tid) {
+        return invalid_id;
+    }
+
+    auto const &things = things_in_sector(thing_sectors[slot].second);
+    auto it = std::upper_bound(things.begin(), things.end(), tid);
+    if(it == things.end()) {
+        return invalid_id;
+    }
+
+    return *it;
+}
+
+void sector_thing_index::rebuild() {
+    for(auto &things : sector_things) {
+        things.clear();
+    }
+
+    thing_sectors.clear();
+
+    for(auto const &thing : ecs.all_components<components::thing>()) {
+        set_sector(thing.first, thing.second->sector);
+    }
+}
+
+void sector_thing_index::components_changed(thing_id entity) {
+    // Emplaced things are indexed when their sector is set. Erased things are removed.
+    erase(entity);
+}
+
+void sector_thing_index::components_moved() {
+    return;
+}
+
+void sector_thing_index::components_replaced() {
+    rebuild();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "content/id.hpp"
+#include "ecs/entity_component_system.hpp"
+#include <utility>
+#include <vector>
+
+namespace gorc {
+namespace game {
+namespace world {
+
+// Lists the things contained by each sector, in id order. Sector changes must be reported
+// through set_sector. Erased things are removed from the index when the thing component
+// is erased.
+class sector_thing_index : public component_pool_observer<thing_id> {
+private:
+    entity_component_system<thing_id>& ecs;
+
+    // Indexed by sector
+    std::vector<std::vector<thing_id>> sector_things;
+
+    // Indexed by entity slot
+    std::vector<std::pair<thing_id, sector_id>> thing_sectors;
+
+    std::vector<thing_id> const empty_things;
+
+    void remove_from_sector(thing_id tid, sector_id sid);
+    void rebuild();
+
+public:
+    sector_thing_index(entity_component_system<thing_id>& ecs, size_t sector_count);
+    ~sector_thing_index();
+
+    sector_thing_index(sector_thing_index const &) = delete;
+    sector_thing_index& operator=(sector_thing_index const &) = delete;
+
+    void set_sector(thing_id tid, sector_id sid);
+    void erase(thing_id tid);
+
+    std::vector<thing_id> const& things_in_sector(sector_id sid) const;
+
+    // Returns the thing after tid in its sector, in id order
+    thing_id next_thing_in_sector(thing_id tid) const;
+
+    virtual void components_changed(thing_id entity) override;
+    virtual void components_moved() override;
+    virtual void components_replaced() override;
+};
+
+}
+}
+}
@@ -0,0 +1,133 @@
+#include "test/test.hpp"
+#include "game/world/sector_thing_index.hpp"
+#include "game/world/components/thing.hpp"
+#include "ecs/component_registry.hpp"
+#include "utility/event_bus.hpp"
+#include "utility/service_registry.hpp"
+#include <vector>
+
+using namespace gorc;
+using namespace gorc::game::world;
+
+namespace {
+    class sector_thing_index_fixture : public test::fixture {
+    public:
+        event_bus bus;
+        component_registry<thing_id> cr;
+        service_registry services;
+
+        sector_thing_index_fixture()
+        {
+            cr.register_component_type<components::thing>();
+            services.add(cr);
+            services.add(bus);
+        }
+    };
+
+    thing_id emplace_thing(entity_component_system<thing_id> &ecs,
+                           sector_thing_index &index,
+                           int sector)
+    {
+        auto tid = ecs.emplace_entity();
+        auto &thing = ecs.emplace_component<components::thing>(tid);
+        thing.sector = sector_id(sector);
+        index.set_sector(tid, thing.sector);
+        return tid;
+    }
+}
+
+begin_suite_fixture(sector_thing_index_test, sector_thing_index_fixture);
+
+test_case(created_things_listed_in_id_order)
+{
+    entity_component_system<thing_id> ecs(services);
+    sector_thing_index index(ecs, 3);
+
+    auto t0 = emplace_thing(ecs, index, 1);
+    auto t1 = emplace_thing(ecs, index, 0);
+    auto t2 = emplace_thing(ecs, index, 1);
+
+    assert_range_eq(index.things_in_sector(sector_id(0)), std::vector<thing_id>({ t1 }));
+    assert_range_eq(index.things_in_sector(sector_id(1)), std::vector<thing_id>({ t0, t2 }));
+    assert_true(index.things_in_sector(sector_id(2)).empty());
+
+    assert_eq(index.next_thing_in_sector(t0), t2);
+    assert_true(!index.next_thing_in_sector(t2).is_valid());
+    assert_true(!index.next_thing_in_sector(t1).is_valid());
+}
+
+test_case(moved_things)
+{
+    entity_component_system<thing_id> ecs(services);
+    sector_thing_index index(ecs, 3);
+
+    auto t0 = emplace_thing(ecs, index, 1);
+    auto t1 = emplace_thing(ecs, index, 1);
+
+    index.set_sector(t0, sector_id(2));
+    assert_range_eq(index.things_in_sector(sector_id(1)), std::vector<thing_id>({ t1 }));
+    assert_range_eq(index.things_in_sector(sector_id(2)), std::vector<thing_id>({ t0 }));
+
+    // Repeated moves to the same sector do not duplicate the thing
+    index.set_sector(t0, sector_id(2));
+    assert_range_eq(index.things_in_sector(sector_id(2)), std::vector<thing_id>({ t0 }));
+
+    // Things outside every sector are not listed
+    index.set_sector(t1, sector_id());
+    index.set_sector(t0, sector_id(7));
+    for(int i = 0; i < 3; ++i) {
+        assert_true(index.things_in_sector(sector_id(i)).empty());
+    }
+
+    assert_true(index.things_in_sector(sector_id(7)).empty());
+    assert_true(!index.next_thing_in_sector(t0).is_valid());
+}
+
+test_case(erased_things)
+{
+    entity_component_system<thing_id> ecs(services);
+    sector_thing_index index(ecs, 2);
+
+    auto t0 = emplace_thing(ecs, index, 0);
+    auto t1 = emplace_thing(ecs, index, 0);
+    auto t2 = emplace_thing(ecs, index, 1);
+
+    ecs.erase_entity(t0);
+    ecs.update(time_delta());
+    assert_range_eq(index.things_in_sector(sector_id(0)), std::vector<thing_id>({ t1 }));
+
+    index.erase(t2);
+    assert_true(index.things_in_sector(sector_id(1)).empty());
+
+    // A new thing in the erased thing's slot does not inherit its entry
+    auto t3 = emplace_thing(ecs, index, 1);
+    assert_eq(entity_slot(t3), entity_slot(t0));
+    index.erase(t0);
+    assert_range_eq(index.things_in_sector(sector_id(0)), std::vector<thing_id>({ t1 }));
+    assert_range_eq(index.things_in_sector(sector_id(1)), std::vector<thing_id>({ t3 }));
+    assert_true(!index.next_thing_in_sector(t0).is_valid());
+}
+
+test_case(restored_snapshot)
+{
+    entity_component_system<thing_id> ecs(services);
+    sector_thing_index index(ecs, 3);
+
+    auto t0 = emplace_thing(ecs, index, 0);
+    auto t1 = emplace_thing(ecs, index, 1);
+    auto snapshot = ecs.take_snapshot();
+
+    ecs.get_unique_component<components::thing>(t0).sector = sector_id(2);
+    index.set_sector(t0, sector_id(2));
+    ecs.erase_entity(t1);
+    ecs.update(time_delta());
+    auto t2 = emplace_thing(ecs, index, 1);
+
+    ecs.restore_snapshot(snapshot);
+    assert_range_eq(index.things_in_sector(sector_id(0)), std::vector<thing_id>({ t0 }));
+    assert_range_eq(index.things_in_sector(sector_id(1)), std::vector<thing_id>({ t1 }));
+    assert_true(index.things_in_sector(sector_id(2)).empty());
+    assert_true(!index.next_thing_in_sector(t2).is_valid());
+}
+
+end_suite(sector_thing_index_test);
@@ -1,11 +1,13 @@
 #include "codegen.hpp"
 #include "statement_gen_visitor.hpp"
 #include "jk/cog/ir/ir_printer.hpp"
+#include "jk/cog/ir/peephole_optimizer.hpp"
 
 void gorc::cog::perform_code_generation(script &out_script,
                                         ast::translation_unit &tu,
                                         verb_table const &verbs,
-                                        constant_table const &constants)
+                                        constant_table const &constants,
+                                        bool optimize)
 {
     memory_file::writer text_writer(out_script.program);
     ir_printer ir(text_writer,
@@ -17,6 +19,10 @@ void gorc::cog::perform_code_generation(script &out_script,
                               constants);
     ast_visit(sgv, tu.code->code);
 
+    if(optimize) {
+        perform_peephole_optimization(ir.get_instructions());
+    }
+
     ir.finalize();
 
     return;
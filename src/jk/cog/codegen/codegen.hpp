@@ -11,7 +11,8 @@ namespace gorc {
         void perform_code_generation(script &out_script,
                                      ast::translation_unit &tu,
                                      verb_table const &verbs,
-                                     constant_table const &constants);
+                                     constant_table const &constants,
+                                     bool optimize = true);
 
     }
 }
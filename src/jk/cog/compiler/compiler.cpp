@@ -6,13 +6,20 @@
 #include "jk/cog/codegen/codegen.hpp"
 
 gorc::cog::compiler::compiler(verb_table &verbs,
-                              constant_table &constants)
+                              constant_table &constants,
+                              bool optimize)
     : verbs(verbs)
     , constants(constants)
+    , optimize(optimize)
 {
     return;
 }
 
+bool gorc::cog::compiler::is_optimizing() const
+{
+    return optimize;
+}
+
 std::unique_ptr<gorc::cog::script> gorc::cog::compiler::compile(input_stream &f)
 {
     ast_factory ast_factory;
@@ -48,7 +55,8 @@ std::unique_ptr<gorc::cog::script> gorc::cog::compiler::compile(input_stream &f)
     cog::perform_code_generation(*script,
                                  *tu,
                                  verbs,
-                                 constants);
+                                 constants,
+                                 optimize);
 
     // Abort after any code generation error
     LOG_FATAL_ASSERT(diagnostic_file_error_count() == 0,
@@ -14,13 +14,18 @@ namespace gorc {
         protected:
             verb_table &verbs;
             constant_table &constants;
+            bool optimize;
 
         public:
             compiler(verb_table &verbs,
-                     constant_table &constants);
+                     constant_table &constants,
+                     bool optimize = true);
 
             std::unique_ptr<script> compile(input_stream &);
 
+            // True when generated code is passed through the peephole optimizer
+            bool is_optimizing() const;
+
             virtual bool handle_parsed_ast(ast::translation_unit &);
             virtual bool handle_analyzed_ast(ast::translation_unit &, script &);
             virtual bool handle_generated_code(script &);
@@ -0,0 +1,326 @@
+#include "script_cache.hpp"
+#include "io/binary_input_stream.hpp"
+#include "io/binary_output_stream.hpp"
+#include "io/memory_file.hpp"
+#include "io/native_file.hpp"
+#include "jk/cog/vm/decoded_program.hpp"
+#include "log/log.hpp"
+#include <boost/filesystem/operations.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    constexpr uint32_t cache_magic = 0x434f4743; // COGC
+    constexpr uint32_t cache_version = 3;
+
+    constexpr uint64_t fnv_offset_basis = 14695981039346656037ULL;
+    constexpr uint64_t fnv_prime = 1099511628211ULL;
+
+    uint64_t fnv_hash(void const *data, size_t size, uint64_t hash = fnv_offset_basis)
+    {
+        auto const *bytes = static_cast<unsigned char const *>(data);
+        for(size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= fnv_prime;
+        }
+
+        return hash;
+    }
+
+    template <typename T>
+    uint64_t fnv_hash_value(T const &value, uint64_t hash)
+    {
+        return fnv_hash(&value, sizeof(T), hash);
+    }
+
+    uint64_t fnv_hash_string(std::string const &str, uint64_t hash = fnv_offset_basis)
+    {
+        return fnv_hash(str.data(), str.size(), hash);
+    }
+
+    using string_index_map = std::unordered_map<char const *, size_t>;
+
+    // String values hold pointers into the script string table. Cached values store the
+    // string table index instead.
+    void serialize_cached_value(gorc::binary_output_stream &bos,
+                                gorc::cog::value v,
+                                string_index_map const &string_index)
+    {
+        if(v.get_type() != gorc::cog::value_type::string) {
+            binary_serialize(bos, true);
+            binary_serialize(bos, v);
+        }
+        else {
+            binary_serialize(bos, false);
+            binary_serialize(bos, string_index.at(static_cast<char const *>(v)));
+        }
+    }
+
+    bool is_cacheable_value(gorc::cog::value v, string_index_map const &string_index)
+    {
+        return v.get_type() != gorc::cog::value_type::string ||
+               string_index.find(static_cast<char const *>(v)) != string_index.end();
+    }
+
+    gorc::cog::value deserialize_cached_value(gorc::binary_input_stream &bis,
+                                              gorc::cog::script const &cog)
+    {
+        if(gorc::binary_deserialize<bool>(bis)) {
+            return gorc::binary_deserialize<gorc::cog::value>(bis);
+        }
+
+        return gorc::cog::value(cog.strings.get_string(gorc::binary_deserialize<size_t>(bis)));
+    }
+}
+
+gorc::cog::script_cache::script_cache(path const &cache_directory,
+                                      verb_table const &verbs,
+                                      constant_table const &constants)
+    : cache_directory(cache_directory)
+    , verbs(verbs)
+    , constants(constants)
+    , table_fingerprint(get_fingerprint())
+{
+    boost::filesystem::create_directories(cache_directory);
+}
+
+uint64_t gorc::cog::script_cache::get_fingerprint() const
+{
+    // Table entries are combined by addition so that the fingerprint does not depend on the
+    // iteration order of the underlying hash maps.
+    uint64_t verb_hash = 0;
+    for(auto const &em : verbs.get_verb_index()) {
+        int id;
+        bool deprecated;
+        std::tie(id, deprecated) = em.second;
+
+        auto const &v = verbs.get_verb(verb_id(id));
+
+        uint64_t h = fnv_hash_string(em.first);
+        h = fnv_hash_value(id, h);
+        h = fnv_hash_value(deprecated, h);
+        h = fnv_hash_value(v.return_type, h);
+        for(auto arg_type : v.argument_types) {
+            h = fnv_hash_value(arg_type, h);
+        }
+
+        verb_hash += h;
+    }
+
+    uint64_t constant_hash = 0;
+    for(auto const &em : constants) {
+        uint64_t h = fnv_hash_string(em.first);
+        h = fnv_hash_value(em.second.get_type(), h);
+        h = fnv_hash_string(as_string(em.second), h);
+
+        constant_hash += h;
+    }
+
+    return fnv_hash_value(constant_hash, fnv_hash_value(verb_hash, fnv_offset_basis));
+}
+
+gorc::path gorc::cog::script_cache::get_entry_path(uint64_t source_hash,
+                                                   uint64_t fingerprint) const
+{
+    return cache_directory / str(format("%016x-%016x.cogc") % source_hash % fingerprint);
+}
+
+std::unique_ptr<gorc::cog::script> gorc::cog::script_cache::compile(compiler &cc,
+                                                                    input_stream &is)
+{
+    memory_file source;
+    is.copy_to(source);
+
+    uint64_t source_hash = fnv_hash(source.data(), source.size());
+    bool optimized = cc.is_optimizing();
+    uint64_t fingerprint = fnv_hash_value(optimized, table_fingerprint);
+    path entry = get_entry_path(source_hash, fingerprint);
+
+    if(boost::filesystem::exists(entry)) {
+        try {
+            auto cached = load(entry, source_hash, fingerprint, optimized, source.size());
+            if(cached) {
+                return cached;
+            }
+        }
+        catch(std::exception const &e) {
+            LOG_DEBUG(format("discarding cached script %s: %s") % entry.generic_string() %
+                      e.what());
+        }
+    }
+
+    int warning_count = diagnostic_file_warning_count();
+
+    memory_file::reader sr(source);
+    auto cog = cc.compile(sr);
+
+    if(diagnostic_file_warning_count() == warning_count) {
+        try {
+            store(entry, source_hash, fingerprint, optimized, source.size(), *cog);
+        }
+        catch(std::exception const &e) {
+            LOG_DEBUG(format("could not cache script %s: %s") % entry.generic_string() %
+                      e.what());
+        }
+    }
+
+    return cog;
+}
+
+std::unique_ptr<gorc::cog::script> gorc::cog::script_cache::load(path const &entry,
+                                                                 uint64_t source_hash,
+                                                                 uint64_t fingerprint,
+                                                                 bool optimized,
+                                                                 size_t source_size) const
+{
+    auto f = make_native_read_only_file(entry);
+    binary_input_stream bis(*f);
+
+    if(binary_deserialize<uint32_t>(bis) != cache_magic ||
+       binary_deserialize<uint32_t>(bis) != cache_version ||
+       binary_deserialize<uint64_t>(bis) != source_hash ||
+       binary_deserialize<uint64_t>(bis) != fingerprint ||
+       binary_deserialize<bool>(bis) != optimized ||
+       binary_deserialize<size_t>(bis) != source_size) {
+        return nullptr;
+    }
+
+    auto cog = std::make_unique<script>();
+    cog->filename = diagnostic_file_name();
+
+    size_t num_strings = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_strings; ++i) {
+        cog->strings.add_string(binary_deserialize<std::string>(bis));
+    }
+
+    size_t num_symbols = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_symbols; ++i) {
+        auto type = binary_deserialize<value_type>(bis);
+        auto name = binary_deserialize<std::string>(bis);
+        auto default_value = deserialize_cached_value(bis, *cog);
+        auto local = binary_deserialize<bool>(bis);
+        auto desc = binary_deserialize<std::string>(bis);
+        auto mask = binary_deserialize<flag_set<source_type>>(bis);
+        auto link_id = binary_deserialize<int>(bis);
+        auto no_link = binary_deserialize<bool>(bis);
+
+        cog->symbols.add_symbol(type, name, default_value, local, desc, mask, link_id, no_link);
+    }
+
+    size_t num_exports = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_exports; ++i) {
+        auto msg = binary_deserialize<message_type>(bis);
+        auto offset = binary_deserialize<size_t>(bis);
+        cog->exports.set_offset(msg, offset);
+    }
+
+    std::vector<char> program(binary_deserialize<size_t>(bis));
+    bis.read(program.data(), program.size());
+    cog->program.write(program.data(), program.size());
+
+    // Patch string immediates with pointers into the new string table
+    memory_file::writer program_writer(cog->program);
+    binary_output_stream program_stream(program_writer);
+
+    size_t num_relocations = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_relocations; ++i) {
+        auto offset = binary_deserialize<size_t>(bis);
+        auto string_index = binary_deserialize<size_t>(bis);
+
+        program_writer.set_position(offset);
+        binary_serialize(program_stream, value(cog->strings.get_string(string_index)));
+    }
+
+    return cog;
+}
+
+void gorc::cog::script_cache::store(path const &entry,
+                                    uint64_t source_hash,
+                                    uint64_t fingerprint,
+                                    bool optimized,
+                                    size_t source_size,
+                                    script const &cog) const
+{
+    string_index_map string_index;
+    for(size_t i = 0; i < cog.strings.size(); ++i) {
+        string_index.emplace(cog.strings.get_string(i), i);
+    }
+
+    // Locate string immediates in the program text
+    std::vector<std::tuple<size_t, size_t>> relocations;
+    decoded_program decoded(cog, verbs);
+    for(size_t i = 0; i < decoded.instructions.size(); ++i) {
+        auto const &inst = decoded.instructions[i];
+        if(inst.op != opcode::push || inst.immediate.get_type() != value_type::string) {
+            continue;
+        }
+
+        if(!is_cacheable_value(inst.immediate, string_index)) {
+            LOG_DEBUG(format("script %s has a string immediate outside of its string table") %
+                      cog.filename);
+            return;
+        }
+
+        relocations.emplace_back(decoded.get_offset(i) + sizeof(opcode),
+                                 string_index.at(static_cast<char const *>(inst.immediate)));
+    }
+
+    for(auto const &sym : cog.symbols) {
+        if(!is_cacheable_value(sym.default_value, string_index)) {
+            LOG_DEBUG(format("script %s symbol %s has a default value outside of its string "
+                             "table") %
+                      cog.filename % sym.name);
+            return;
+        }
+    }
+
+    // Write to a temporary file first. Other processes may be reading the same entry.
+    path temp_entry = boost::filesystem::unique_path(entry.generic_string() + ".%%%%%%%%.tmp");
+
+    {
+        auto f = make_native_file(temp_entry);
+        binary_output_stream bos(*f);
+
+        binary_serialize(bos, cache_magic);
+        binary_serialize(bos, cache_version);
+        binary_serialize(bos, source_hash);
+        binary_serialize(bos, fingerprint);
+        binary_serialize(bos, optimized);
+        binary_serialize(bos, source_size);
+
+        binary_serialize(bos, cog.strings.size());
+        for(size_t i = 0; i < cog.strings.size(); ++i) {
+            binary_serialize(bos, std::string(cog.strings.get_string(i)));
+        }
+
+        binary_serialize(bos, cog.symbols.size());
+        for(auto const &sym : cog.symbols) {
+            binary_serialize(bos, sym.type);
+            binary_serialize(bos, sym.name);
+            serialize_cached_value(bos, sym.default_value, string_index);
+            binary_serialize(bos, sym.local);
+            binary_serialize(bos, sym.desc);
+            binary_serialize(bos, sym.mask);
+            binary_serialize(bos, sym.link_id);
+            binary_serialize(bos, sym.no_link);
+        }
+
+        binary_serialize(bos,
+                         static_cast<size_t>(std::distance(cog.exports.begin(),
+                                                           cog.exports.end())));
+        for(auto const &em : cog.exports) {
+            binary_serialize(bos, em.first);
+            binary_serialize(bos, em.second);
+        }
+
+        binary_serialize(bos, cog.program.size());
+        bos.write(cog.program.data(), cog.program.size());
+
+        binary_serialize_range(bos, relocations, [](auto &bos, auto const &em) {
+            binary_serialize(bos, std::get<0>(em));
+            binary_serialize(bos, std::get<1>(em));
+        });
+    }
+
+    boost::filesystem::rename(temp_entry, entry);
+}
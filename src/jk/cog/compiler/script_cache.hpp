@@ -0,0 +1,52 @@
+#pragma once
+
+#include "compiler.hpp"
+#include "io/input_stream.hpp"
+#include "io/path.hpp"
+#include "jk/cog/script/constant_table.hpp"
+#include "jk/cog/script/script.hpp"
+#include "jk/cog/script/verb_table.hpp"
+#include <cstdint>
+#include <memory>
+
+namespace gorc {
+    namespace cog {
+
+        // On-disk cache of compiled scripts. Entries are keyed by a hash of the script source
+        // and a fingerprint of the verb and constant tables and the code generation options
+        // used to compile it. Scripts that produce diagnostics are never cached, so that
+        // warnings are reported on every load.
+        class script_cache {
+        private:
+            path cache_directory;
+            verb_table const &verbs;
+            constant_table const &constants;
+
+            // The tables do not change after the cache is constructed
+            uint64_t table_fingerprint;
+
+            uint64_t get_fingerprint() const;
+            path get_entry_path(uint64_t source_hash, uint64_t fingerprint) const;
+
+            std::unique_ptr<script> load(path const &entry,
+                                         uint64_t source_hash,
+                                         uint64_t fingerprint,
+                                         bool optimized,
+                                         size_t source_size) const;
+            void store(path const &entry,
+                       uint64_t source_hash,
+                       uint64_t fingerprint,
+                       bool optimized,
+                       size_t source_size,
+                       script const &) const;
+
+        public:
+            script_cache(path const &cache_directory,
+                         verb_table const &verbs,
+                         constant_table const &constants);
+
+            std::unique_ptr<script> compile(compiler &, input_stream &);
+        };
+
+    }
+}
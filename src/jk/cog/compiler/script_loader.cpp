@@ -1,5 +1,6 @@
 #include "script_loader.hpp"
 #include "compiler.hpp"
+#include "script_cache.hpp"
 
 gorc::fourcc const gorc::cog::script_loader::type = "COG"_4CC;
 
@@ -12,6 +13,12 @@ std::vector<gorc::path> const &gorc::cog::script_loader::get_prefixes() const
     return cog_prefixes;
 }
 
+bool gorc::cog::script_loader::is_thread_safe() const
+{
+    // Compilation state is created per script. Verb and constant tables are only read.
+    return true;
+}
+
 std::unique_ptr<gorc::asset> gorc::cog::script_loader::deserialize(input_stream &is,
                                                                    content_manager &,
                                                                    asset_id,
@@ -19,5 +26,10 @@ std::unique_ptr<gorc::asset> gorc::cog::script_loader::deserialize(input_stream
                                                                    std::string const &name) const
 {
     auto &compiler = services.get<cog::compiler>();
+
+    if(services.has<script_cache>()) {
+        return services.get<script_cache>().compile(compiler, is);
+    }
+
     return compiler.compile(is);
 }
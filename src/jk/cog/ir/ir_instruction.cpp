@@ -0,0 +1,14 @@
+#include "ir_instruction.hpp"
+
+gorc::cog::ir_instruction::ir_instruction(opcode op)
+    : op(op)
+{
+    return;
+}
+
+gorc::cog::ir_instruction::ir_instruction(label_id lid)
+    : is_label(true)
+    , target(lid)
+{
+    return;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "jk/cog/script/value.hpp"
+#include "jk/cog/vm/opcode.hpp"
+#include "label_id.hpp"
+#include "log/diagnostic_context_location.hpp"
+#include <cstddef>
+
+namespace gorc {
+    namespace cog {
+
+        // Instruction buffered by ir_printer. Label definitions are stored in the same
+        // sequence, so that optimization passes can see basic block boundaries.
+        class ir_instruction {
+        public:
+            bool is_label = false;
+            opcode op = opcode::ret;
+            value immediate;
+            size_t address = 0;
+            label_id target;
+            verb_id verb;
+            diagnostic_context_location location;
+
+            explicit ir_instruction(opcode op);
+
+            // Creates a label definition
+            explicit ir_instruction(label_id lid);
+        };
+    }
+}
@@ -10,13 +10,36 @@ gorc::cog::ir_printer::ir_printer(file &program_text, message_table &exports)
     return;
 }
 
+std::vector<gorc::cog::ir_instruction> &gorc::cog::ir_printer::get_instructions()
+{
+    return instructions;
+}
+
 void gorc::cog::ir_printer::finalize()
 {
+    // End program text with ret
+    bool ends_with_ret = false;
+    for(auto it = instructions.rbegin(); it != instructions.rend(); ++it) {
+        if(!it->is_label) {
+            ends_with_ret = (it->op == opcode::ret);
+            break;
+        }
+    }
+
     if(!ends_with_ret) {
-        // End program text with ret
         ret();
     }
 
+    for(auto const &inst : instructions) {
+        if(inst.is_label) {
+            // Current position is the label offset
+            label_offsets.emplace(static_cast<int>(inst.target), program_text.position());
+        }
+        else {
+            write_instruction(inst);
+        }
+    }
+
     // Loop over backpatch map, replacing temporary indices
     for(auto const &backpatch : backpatch_map) {
         int label_id;
@@ -71,249 +94,270 @@ gorc::cog::label_id gorc::cog::ir_printer::get_export_label(message_type mt,
 
 void gorc::cog::ir_printer::label(label_id lid)
 {
-    // Current position is the label offset
-    bool succeeded = label_offsets.emplace(static_cast<int>(lid), program_text.position()).second;
+    bool succeeded = defined_labels.insert(static_cast<int>(lid)).second;
     if(!succeeded) {
         LOG_FATAL(format("label id %d used for multiple branch targets") % static_cast<int>(lid));
     }
+
+    instructions.emplace_back(lid);
+}
+
+gorc::cog::ir_instruction &gorc::cog::ir_printer::append(opcode op)
+{
+    instructions.emplace_back(op);
+    return instructions.back();
+}
+
+void gorc::cog::ir_printer::write_instruction(ir_instruction const &inst)
+{
+    switch(inst.op) {
+    case opcode::push:
+        binary_serialize(program_stream, inst.op);
+        binary_serialize(program_stream, inst.immediate);
+        break;
+
+    case opcode::load:
+    case opcode::loadi:
+    case opcode::loadg:
+    case opcode::loadgi:
+    case opcode::stor:
+    case opcode::stori:
+    case opcode::storg:
+    case opcode::storgi:
+        binary_serialize(program_stream, inst.op);
+        binary_serialize(program_stream, inst.address);
+        break;
+
+    case opcode::incr:
+    case opcode::decr:
+    case opcode::incrg:
+    case opcode::decrg:
+        binary_serialize(program_stream, inst.op);
+        binary_serialize(program_stream, inst.address);
+        binary_serialize(program_stream, inst.immediate);
+        break;
+
+    case opcode::jmp:
+    case opcode::jal:
+    case opcode::bt:
+    case opcode::bf:
+    case opcode::bteq:
+    case opcode::btne:
+    case opcode::btgt:
+    case opcode::btge:
+    case opcode::btlt:
+    case opcode::btle:
+    case opcode::bfeq:
+    case opcode::bfne:
+    case opcode::bfgt:
+    case opcode::bfge:
+    case opcode::bflt:
+    case opcode::bfle:
+        write_branch_instruction(inst.op, inst.target);
+        break;
+
+    case opcode::call:
+    case opcode::callv:
+        binary_serialize(program_stream, inst.op);
+        binary_serialize(program_stream, static_cast<int>(inst.verb));
+        binary_serialize(program_stream, inst.location.first_line);
+        binary_serialize(program_stream, inst.location.first_col);
+        binary_serialize(program_stream, inst.location.last_line);
+        binary_serialize(program_stream, inst.location.last_col);
+        break;
+
+    default:
+        binary_serialize(program_stream, inst.op);
+        break;
+    }
+}
+
+void gorc::cog::ir_printer::write_branch_instruction(opcode op, label_id lid)
+{
+    binary_serialize(program_stream, op);
+
+    // Store current location in backpatch map
+    backpatch_map.emplace(static_cast<int>(lid), program_text.position());
+
+    // Write placeholder
+    binary_serialize(program_stream, size_t(0));
 }
 
 void gorc::cog::ir_printer::push(value v)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::push);
-    binary_serialize(program_stream, v);
+    append(opcode::push).immediate = v;
 }
 
 void gorc::cog::ir_printer::dup()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::dup);
+    append(opcode::dup);
 }
 
 void gorc::cog::ir_printer::load(size_t addr)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::load);
-    binary_serialize(program_stream, addr);
+    append(opcode::load).address = addr;
 }
 
 void gorc::cog::ir_printer::loadi(size_t addr)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::loadi);
-    binary_serialize(program_stream, addr);
+    append(opcode::loadi).address = addr;
 }
 
 void gorc::cog::ir_printer::loadg(size_t addr)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::loadg);
-    binary_serialize(program_stream, addr);
+    append(opcode::loadg).address = addr;
 }
 
 void gorc::cog::ir_printer::loadgi(size_t addr)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::loadgi);
-    binary_serialize(program_stream, addr);
+    append(opcode::loadgi).address = addr;
 }
 
 void gorc::cog::ir_printer::stor(size_t addr)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::stor);
-    binary_serialize(program_stream, addr);
+    append(opcode::stor).address = addr;
 }
 
 void gorc::cog::ir_printer::stori(size_t addr)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::stori);
-    binary_serialize(program_stream, addr);
+    append(opcode::stori).address = addr;
 }
 
 void gorc::cog::ir_printer::storg(size_t addr)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::storg);
-    binary_serialize(program_stream, addr);
+    append(opcode::storg).address = addr;
 }
 
 void gorc::cog::ir_printer::storgi(size_t addr)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::storgi);
-    binary_serialize(program_stream, addr);
-}
-
-void gorc::cog::ir_printer::write_branch_instruction(opcode op, label_id lid)
-{
-    binary_serialize(program_stream, op);
-
-    // Store current location in backpatch map
-    backpatch_map.emplace(static_cast<int>(lid), program_text.position());
-
-    // Write placeholder
-    binary_serialize(program_stream, size_t(0));
+    append(opcode::storgi).address = addr;
 }
 
 void gorc::cog::ir_printer::jmp(label_id lid)
 {
-    ends_with_ret = false;
-    write_branch_instruction(opcode::jmp, lid);
+    append(opcode::jmp).target = lid;
 }
 
 void gorc::cog::ir_printer::jal(label_id lid)
 {
-    ends_with_ret = false;
-    write_branch_instruction(opcode::jal, lid);
+    append(opcode::jal).target = lid;
 }
 
 void gorc::cog::ir_printer::bt(label_id lid)
 {
-    ends_with_ret = false;
-    write_branch_instruction(opcode::bt, lid);
+    append(opcode::bt).target = lid;
 }
 
 void gorc::cog::ir_printer::bf(label_id lid)
 {
-    ends_with_ret = false;
-    write_branch_instruction(opcode::bf, lid);
+    append(opcode::bf).target = lid;
 }
 
 void gorc::cog::ir_printer::ret()
 {
-    ends_with_ret = true;
-    binary_serialize(program_stream, opcode::ret);
+    append(opcode::ret);
 }
 
 void gorc::cog::ir_printer::call(verb_id id, diagnostic_context_location const &loc)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::call);
-    binary_serialize(program_stream, static_cast<int>(id));
-    binary_serialize(program_stream, loc.first_line);
-    binary_serialize(program_stream, loc.first_col);
-    binary_serialize(program_stream, loc.last_line);
-    binary_serialize(program_stream, loc.last_col);
+    auto &inst = append(opcode::call);
+    inst.verb = id;
+    inst.location = loc;
 }
 
 void gorc::cog::ir_printer::callv(verb_id id, diagnostic_context_location const &loc)
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::callv);
-    binary_serialize(program_stream, static_cast<int>(id));
-    binary_serialize(program_stream, loc.first_line);
-    binary_serialize(program_stream, loc.first_col);
-    binary_serialize(program_stream, loc.last_line);
-    binary_serialize(program_stream, loc.last_col);
+    auto &inst = append(opcode::callv);
+    inst.verb = id;
+    inst.location = loc;
 }
 
 void gorc::cog::ir_printer::neg()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::neg);
+    append(opcode::neg);
 }
 
 void gorc::cog::ir_printer::lnot()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::lnot);
+    append(opcode::lnot);
 }
 
 void gorc::cog::ir_printer::add()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::add);
+    append(opcode::add);
 }
 
 void gorc::cog::ir_printer::sub()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::sub);
+    append(opcode::sub);
 }
 
 void gorc::cog::ir_printer::mul()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::mul);
+    append(opcode::mul);
 }
 
 void gorc::cog::ir_printer::div()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::div);
+    append(opcode::div);
 }
 
 void gorc::cog::ir_printer::mod()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::mod);
+    append(opcode::mod);
 }
 
 void gorc::cog::ir_printer::bor()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::bor);
+    append(opcode::bor);
 }
 
 void gorc::cog::ir_printer::band()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::band);
+    append(opcode::band);
 }
 
 void gorc::cog::ir_printer::bxor()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::bxor);
+    append(opcode::bxor);
 }
 
 void gorc::cog::ir_printer::lor()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::lor);
+    append(opcode::lor);
 }
 
 void gorc::cog::ir_printer::land()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::land);
+    append(opcode::land);
 }
 
 void gorc::cog::ir_printer::eq()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::eq);
+    append(opcode::eq);
 }
 
 void gorc::cog::ir_printer::ne()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::ne);
+    append(opcode::ne);
 }
 
 void gorc::cog::ir_printer::gt()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::gt);
+    append(opcode::gt);
 }
 
 void gorc::cog::ir_printer::ge()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::ge);
+    append(opcode::ge);
 }
 
 void gorc::cog::ir_printer::lt()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::lt);
+    append(opcode::lt);
 }
 
 void gorc::cog::ir_printer::le()
 {
-    ends_with_ret = false;
-    binary_serialize(program_stream, opcode::le);
+    append(opcode::le);
 }
@@ -2,6 +2,7 @@
 
 #include "io/binary_output_stream.hpp"
 #include "io/file.hpp"
+#include "ir_instruction.hpp"
 #include "jk/cog/script/message_table.hpp"
 #include "jk/cog/script/value.hpp"
 #include "jk/cog/vm/opcode.hpp"
@@ -9,6 +10,8 @@
 #include "utility/enum_hash.hpp"
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace gorc {
     namespace cog {
@@ -24,17 +27,24 @@ namespace gorc {
             std::unordered_map<std::string, label_id> named_label_ids;
             std::unordered_map<message_type, label_id, enum_hash<message_type>> exported_label_ids;
 
+            std::vector<ir_instruction> instructions;
+            std::unordered_set<int> defined_labels;
+
             std::unordered_map<int, size_t> label_offsets;
 
             std::unordered_multimap<int, size_t> backpatch_map;
 
-            bool ends_with_ret = false;
+            ir_instruction &append(opcode op);
 
+            void write_instruction(ir_instruction const &);
             void write_branch_instruction(opcode op, label_id lid);
 
         public:
             ir_printer(file &program_text, message_table &exports);
 
+            // Instructions are buffered until finalize. Optimization passes may rewrite them.
+            std::vector<ir_instruction> &get_instructions();
+
             void finalize();
 
             label_id generate_label();
@@ -0,0 +1,340 @@
+#include "peephole_optimizer.hpp"
+#include "utility/maybe.hpp"
+
+namespace {
+
+    using gorc::cog::ir_instruction;
+    using gorc::cog::opcode;
+    using gorc::cog::value;
+    using instruction_list = std::vector<ir_instruction>;
+
+    bool is_op(ir_instruction const &inst, opcode op)
+    {
+        return !inst.is_label && inst.op == op;
+    }
+
+    bool is_conditional_branch(ir_instruction const &inst)
+    {
+        return is_op(inst, opcode::bt) || is_op(inst, opcode::bf);
+    }
+
+    bool is_unconditional_exit(ir_instruction const &inst)
+    {
+        return is_op(inst, opcode::jmp) || is_op(inst, opcode::ret);
+    }
+
+    // Division and modulo are never folded. Their behavior on a zero divisor must be
+    // preserved until run time.
+    gorc::maybe<value> fold_binary(opcode op, value x, value y)
+    {
+        switch(op) {
+        case opcode::add:
+            return x + y;
+        case opcode::sub:
+            return x - y;
+        case opcode::mul:
+            return x * y;
+        case opcode::bor:
+            return x | y;
+        case opcode::band:
+            return x & y;
+        case opcode::bxor:
+            return x ^ y;
+        case opcode::lor:
+            return x || y;
+        case opcode::land:
+            return x && y;
+        case opcode::eq:
+            return x == y;
+        case opcode::ne:
+            return x != y;
+        case opcode::gt:
+            return x > y;
+        case opcode::ge:
+            return x >= y;
+        case opcode::lt:
+            return x < y;
+        case opcode::le:
+            return x <= y;
+        default:
+            return gorc::nothing;
+        }
+    }
+
+    gorc::maybe<opcode> fuse_branch(opcode cmp, opcode branch)
+    {
+        bool bt = (branch == opcode::bt);
+
+        switch(cmp) {
+        case opcode::eq:
+            return bt ? opcode::bteq : opcode::bfeq;
+        case opcode::ne:
+            return bt ? opcode::btne : opcode::bfne;
+        case opcode::gt:
+            return bt ? opcode::btgt : opcode::bfgt;
+        case opcode::ge:
+            return bt ? opcode::btge : opcode::bfge;
+        case opcode::lt:
+            return bt ? opcode::btlt : opcode::bflt;
+        case opcode::le:
+            return bt ? opcode::btle : opcode::bfle;
+        default:
+            return gorc::nothing;
+        }
+    }
+
+    gorc::maybe<opcode> fuse_load_op_store(opcode load, opcode op)
+    {
+        if(load == opcode::load) {
+            return (op == opcode::add) ? opcode::incr : opcode::decr;
+        }
+        else {
+            return (op == opcode::add) ? opcode::incrg : opcode::decrg;
+        }
+    }
+
+    void drop_back(instruction_list &out, size_t count)
+    {
+        out.erase(out.end() - static_cast<std::ptrdiff_t>(count), out.end());
+    }
+
+    // Rewrites the end of the output after an instruction has been appended. Returns true
+    // if the output was changed, so that the new tail can be examined again.
+    bool rewrite_tail(instruction_list &out)
+    {
+        size_t n = out.size();
+        auto const &last = out[n - 1];
+
+        if(last.is_label) {
+            // Jump to an immediately following label
+            size_t i = n - 1;
+            while(i > 0 && out[i - 1].is_label) {
+                --i;
+            }
+
+            if(i > 0 && is_op(out[i - 1], opcode::jmp) && out[i - 1].target == last.target) {
+                out.erase(out.begin() + static_cast<std::ptrdiff_t>(i - 1));
+                return true;
+            }
+
+            return false;
+        }
+
+        if(n < 2 || out[n - 2].is_label) {
+            return false;
+        }
+
+        auto &prev = out[n - 2];
+
+        // Unreachable code
+        if(is_unconditional_exit(prev)) {
+            drop_back(out, 1);
+            return true;
+        }
+
+        // Unary constant folding
+        if(prev.op == opcode::push && (last.op == opcode::neg || last.op == opcode::lnot)) {
+            prev.immediate = (last.op == opcode::neg) ? -prev.immediate : !prev.immediate;
+            drop_back(out, 1);
+            return true;
+        }
+
+        if(is_conditional_branch(last)) {
+            // Branch on a constant condition
+            if(prev.op == opcode::push) {
+                bool taken = (static_cast<bool>(prev.immediate) == (last.op == opcode::bt));
+                if(taken) {
+                    prev = ir_instruction(opcode::jmp);
+                    prev.target = last.target;
+                    drop_back(out, 1);
+                }
+                else {
+                    drop_back(out, 2);
+                }
+
+                return true;
+            }
+
+            // Branch on a negated condition
+            if(prev.op == opcode::lnot) {
+                prev.op = (last.op == opcode::bt) ? opcode::bf : opcode::bt;
+                prev.target = last.target;
+                drop_back(out, 1);
+                return true;
+            }
+
+            // Compare and branch
+            auto fused = fuse_branch(prev.op, last.op);
+            if(fused.has_value()) {
+                prev.op = fused.get_value();
+                prev.target = last.target;
+                drop_back(out, 1);
+                return true;
+            }
+
+            return false;
+        }
+
+        // Copy of a variable to itself
+        if((prev.op == opcode::load && last.op == opcode::stor) ||
+           (prev.op == opcode::loadg && last.op == opcode::storg)) {
+            if(prev.address == last.address) {
+                drop_back(out, 2);
+                return true;
+            }
+        }
+
+        if(n < 3 || out[n - 3].is_label) {
+            return false;
+        }
+
+        auto &first = out[n - 3];
+
+        // Binary constant folding
+        if(first.op == opcode::push && prev.op == opcode::push) {
+            auto folded = fold_binary(last.op, first.immediate, prev.immediate);
+            if(folded.has_value()) {
+                first.immediate = folded.get_value();
+                drop_back(out, 2);
+                return true;
+            }
+        }
+
+        if(n < 4 || out[n - 4].is_label) {
+            return false;
+        }
+
+        // Load, add or subtract immediate, store to the same address
+        auto &load = out[n - 4];
+        bool is_local = (load.op == opcode::load && last.op == opcode::stor);
+        bool is_global = (load.op == opcode::loadg && last.op == opcode::storg);
+        if((is_local || is_global) && load.address == last.address &&
+           first.op == opcode::push && (prev.op == opcode::add || prev.op == opcode::sub)) {
+            load.op = fuse_load_op_store(load.op, prev.op).get_value();
+            load.immediate = first.immediate;
+            drop_back(out, 3);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool perform_tail_rewrites(instruction_list &instructions)
+    {
+        bool changed = false;
+
+        instruction_list out;
+        out.reserve(instructions.size());
+
+        for(auto const &inst : instructions) {
+            out.push_back(inst);
+            while(!out.empty() && rewrite_tail(out)) {
+                changed = true;
+            }
+        }
+
+        instructions = std::move(out);
+        return changed;
+    }
+
+    bool reads_address(ir_instruction const &inst, opcode load_op, size_t address)
+    {
+        return inst.op == load_op && inst.address == address;
+    }
+
+    bool is_store_barrier(ir_instruction const &inst)
+    {
+        if(inst.is_label) {
+            return true;
+        }
+
+        switch(inst.op) {
+        case opcode::push:
+        case opcode::dup:
+        case opcode::load:
+        case opcode::loadg:
+        case opcode::stor:
+        case opcode::storg:
+        case opcode::incr:
+        case opcode::decr:
+        case opcode::incrg:
+        case opcode::decrg:
+        case opcode::neg:
+        case opcode::lnot:
+        case opcode::add:
+        case opcode::sub:
+        case opcode::mul:
+        case opcode::div:
+        case opcode::mod:
+        case opcode::bor:
+        case opcode::band:
+        case opcode::bxor:
+        case opcode::lor:
+        case opcode::land:
+        case opcode::eq:
+        case opcode::ne:
+        case opcode::gt:
+        case opcode::ge:
+        case opcode::lt:
+        case opcode::le:
+            return false;
+
+        default:
+            // Branches, calls, returns and indexed accesses
+            return true;
+        }
+    }
+
+    // Removes a constant or copied value stored to an address that is overwritten later in
+    // the same basic block, before it can be read.
+    bool eliminate_dead_stores(instruction_list &instructions)
+    {
+        bool changed = false;
+
+        for(size_t i = 0; i + 1 < instructions.size(); ++i) {
+            auto const &src = instructions[i];
+            auto const &store = instructions[i + 1];
+            if(src.is_label || store.is_label) {
+                continue;
+            }
+
+            bool is_source = (src.op == opcode::push || src.op == opcode::load ||
+                              src.op == opcode::loadg);
+            bool is_store = (store.op == opcode::stor || store.op == opcode::storg);
+            if(!is_source || !is_store) {
+                continue;
+            }
+
+            opcode load_op = (store.op == opcode::stor) ? opcode::load : opcode::loadg;
+            opcode incr_op = (store.op == opcode::stor) ? opcode::incr : opcode::incrg;
+            opcode decr_op = (store.op == opcode::stor) ? opcode::decr : opcode::decrg;
+
+            for(size_t j = i + 2; j < instructions.size(); ++j) {
+                auto const &inst = instructions[j];
+                if(is_store_barrier(inst) || reads_address(inst, load_op, store.address) ||
+                   reads_address(inst, incr_op, store.address) ||
+                   reads_address(inst, decr_op, store.address)) {
+                    break;
+                }
+
+                if(inst.op == store.op && inst.address == store.address) {
+                    instructions.erase(instructions.begin() + static_cast<std::ptrdiff_t>(i),
+                                       instructions.begin() + static_cast<std::ptrdiff_t>(i + 2));
+                    changed = true;
+                    break;
+                }
+            }
+        }
+
+        return changed;
+    }
+}
+
+void gorc::cog::perform_peephole_optimization(std::vector<ir_instruction> &instructions)
+{
+    bool changed = true;
+    while(changed) {
+        changed = perform_tail_rewrites(instructions);
+        changed = eliminate_dead_stores(instructions) || changed;
+    }
+}
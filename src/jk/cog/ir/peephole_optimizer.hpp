@@ -0,0 +1,14 @@
+#pragma once
+
+#include "ir_instruction.hpp"
+#include <vector>
+
+namespace gorc {
+    namespace cog {
+
+        // Rewrites buffered instructions in place. Performs constant folding, dead store
+        // elimination, and forms fused compare-and-branch and load-op-store instructions.
+        void perform_peephole_optimization(std::vector<ir_instruction> &instructions);
+
+    }
+}
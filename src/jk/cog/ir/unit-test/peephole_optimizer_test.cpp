@@ -0,0 +1,127 @@
+#include "test/test.hpp"
+#include "jk/cog/ir/peephole_optimizer.hpp"
+
+using namespace gorc;
+using namespace gorc::cog;
+
+namespace {
+
+    ir_instruction make_instruction(opcode op, size_t address = 0)
+    {
+        ir_instruction rv(op);
+        rv.address = address;
+        return rv;
+    }
+
+    ir_instruction make_push(value v)
+    {
+        ir_instruction rv(opcode::push);
+        rv.immediate = v;
+        return rv;
+    }
+
+    ir_instruction make_branch(opcode op, label_id target)
+    {
+        ir_instruction rv(op);
+        rv.target = target;
+        return rv;
+    }
+}
+
+begin_suite(peephole_optimizer_test);
+
+test_case(folds_constants)
+{
+    std::vector<ir_instruction> code {
+        make_push(value(2)),
+        make_push(value(3)),
+        make_instruction(opcode::mul),
+        make_instruction(opcode::neg),
+        make_instruction(opcode::stor, 0)
+    };
+
+    perform_peephole_optimization(code);
+
+    assert_eq(code.size(), size_t(2));
+    assert_true(code[0].op == opcode::push);
+    assert_eq(static_cast<int>(code[0].immediate), -6);
+    assert_true(code[1].op == opcode::stor);
+}
+
+test_case(does_not_fold_division)
+{
+    std::vector<ir_instruction> code {
+        make_push(value(1)),
+        make_push(value(0)),
+        make_instruction(opcode::div),
+        make_instruction(opcode::stor, 0)
+    };
+
+    perform_peephole_optimization(code);
+
+    assert_eq(code.size(), size_t(4));
+    assert_true(code[2].op == opcode::div);
+}
+
+test_case(fuses_compare_and_branch)
+{
+    std::vector<ir_instruction> code {
+        make_instruction(opcode::load, 0),
+        make_push(value(10)),
+        make_instruction(opcode::lt),
+        make_branch(opcode::bf, label_id(0)),
+        make_instruction(opcode::load, 0),
+        make_push(value(1)),
+        make_instruction(opcode::add),
+        make_instruction(opcode::stor, 0),
+        ir_instruction(label_id(0))
+    };
+
+    perform_peephole_optimization(code);
+
+    assert_eq(code.size(), size_t(5));
+    assert_true(code[2].op == opcode::bflt);
+    assert_eq(static_cast<int>(code[2].target), 0);
+    assert_true(code[3].op == opcode::incr);
+    assert_eq(code[3].address, size_t(0));
+    assert_eq(static_cast<int>(code[3].immediate), 1);
+    assert_true(code[4].is_label);
+}
+
+test_case(keeps_stores_that_are_read)
+{
+    std::vector<ir_instruction> code {
+        make_push(value(1)),
+        make_instruction(opcode::stor, 0),
+        make_instruction(opcode::load, 0),
+        make_instruction(opcode::stor, 1),
+        make_push(value(2)),
+        make_instruction(opcode::stor, 0),
+        make_instruction(opcode::ret)
+    };
+
+    perform_peephole_optimization(code);
+
+    assert_eq(code.size(), size_t(7));
+}
+
+test_case(removes_dead_stores)
+{
+    std::vector<ir_instruction> code {
+        make_push(value(1)),
+        make_instruction(opcode::stor, 0),
+        make_push(value(2)),
+        make_instruction(opcode::stor, 1),
+        make_push(value(3)),
+        make_instruction(opcode::stor, 0),
+        make_instruction(opcode::ret)
+    };
+
+    perform_peephole_optimization(code);
+
+    assert_eq(code.size(), size_t(5));
+    assert_eq(static_cast<int>(code[0].immediate), 2);
+    assert_eq(static_cast<int>(code[2].immediate), 3);
+}
+
+end_suite(peephole_optimizer_test);
@@ -1,10 +1,11 @@
 #pragma once
 
-#include <vector>
+#include "utility/small_vector.hpp"
 #include "value.hpp"
 
 namespace gorc {
     namespace cog {
-        using stack = std::vector<value>;
+        // Most messages never exceed the inline capacity, so running them does not allocate.
+        using stack = small_vector<value, 32>;
     }
 }
@@ -5,3 +5,13 @@ char const* gorc::cog::string_table::add_string(std::string const &str)
     strings.push_back(std::make_unique<std::string>(str));
     return strings.back()->c_str();
 }
+
+size_t gorc::cog::string_table::size() const
+{
+    return strings.size();
+}
+
+char const* gorc::cog::string_table::get_string(size_t index) const
+{
+    return strings.at(index)->c_str();
+}
@@ -13,6 +13,9 @@ namespace gorc {
 
         public:
             char const* add_string(std::string const &str);
+
+            size_t size() const;
+            char const* get_string(size_t index) const;
         };
 
     }
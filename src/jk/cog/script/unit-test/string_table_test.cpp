@@ -14,4 +14,15 @@ test_case(basic)
     assert_eq(std::string(str), std::string("Hello, World!"));
 }
 
+test_case(get_string)
+{
+    string_table st;
+    char const *first = st.add_string("first");
+    char const *second = st.add_string("second");
+
+    assert_eq(st.size(), size_t(2));
+    assert_eq(st.get_string(0), first);
+    assert_eq(st.get_string(1), second);
+}
+
 end_suite(string_table_test);
@@ -1,4 +1,5 @@
 #include "value.hpp"
+#include <cstring>
 #include <sstream>
 
 namespace {
@@ -350,6 +351,82 @@ bool gorc::cog::value::is_same(value const &v) const
     }
 }
 
+namespace {
+    uint64_t float_bits(float f)
+    {
+        uint32_t rv;
+        std::memcpy(&rv, &f, sizeof(float));
+        return rv;
+    }
+
+    size_t hash_combine(size_t seed, uint64_t v)
+    {
+        return seed ^ (static_cast<size_t>(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+    }
+}
+
+bool gorc::cog::value::is_identical(value const &v) const
+{
+    if(type_flag != v.type_flag) {
+        return false;
+    }
+
+    switch(type_flag) {
+    case value_type::nothing:
+    case value_type::dynamic:
+        return true;
+
+    case value_type::floating:
+        return float_bits(data.floating) == float_bits(v.data.floating);
+
+    case value_type::boolean:
+        return data.boolean == v.data.boolean;
+
+    case value_type::string:
+        return std::strcmp(data.string, v.data.string) == 0;
+
+    case value_type::vector:
+        return float_bits(data.vector.x) == float_bits(v.data.vector.x) &&
+               float_bits(data.vector.y) == float_bits(v.data.vector.y) &&
+               float_bits(data.vector.z) == float_bits(v.data.vector.z);
+
+    default:
+        return data.integer == v.data.integer;
+    }
+}
+
+size_t gorc::cog::value::get_hash() const
+{
+    size_t seed = static_cast<size_t>(type_flag);
+
+    switch(type_flag) {
+    case value_type::nothing:
+    case value_type::dynamic:
+        return seed;
+
+    case value_type::floating:
+        return hash_combine(seed, float_bits(data.floating));
+
+    case value_type::boolean:
+        return hash_combine(seed, data.boolean);
+
+    case value_type::string:
+        for(char const *c = data.string; *c; ++c) {
+            seed = hash_combine(seed, static_cast<unsigned char>(*c));
+        }
+
+        return seed;
+
+    case value_type::vector:
+        seed = hash_combine(seed, float_bits(data.vector.x));
+        seed = hash_combine(seed, float_bits(data.vector.y));
+        return hash_combine(seed, float_bits(data.vector.z));
+
+    default:
+        return hash_combine(seed, static_cast<uint32_t>(data.integer));
+    }
+}
+
 std::string gorc::cog::value::as_string() const
 {
     std::stringstream ss;
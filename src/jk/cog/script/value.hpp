@@ -108,6 +108,11 @@ namespace gorc {
             std::string as_string() const;
 
             bool is_same(value const &v) const;
+
+            // Hash index support. Values are identical if they have the same type and payload.
+            // Unlike is_same, floating point payloads are compared bitwise.
+            bool is_identical(value const &v) const;
+            size_t get_hash() const;
         };
 
         std::string as_string(value const &);
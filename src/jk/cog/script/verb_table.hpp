@@ -4,6 +4,7 @@
 #include "type.hpp"
 #include "mock_verb.hpp"
 #include "function_verb.hpp"
+#include "utility/range.hpp"
 #include <memory>
 #include <vector>
 #include <unordered_map>
@@ -56,6 +57,11 @@ namespace gorc {
 
             verb_id get_verb_id(std::string const &name) const;
             verb const& get_verb(verb_id) const;
+
+            inline auto get_verb_index() const
+            {
+                return make_range(verb_index);
+            }
         };
 
     }
@@ -1,6 +1,7 @@
 #include "call_stack_frame.hpp"
 
 gorc::cog::call_stack_frame::call_stack_frame(cog_id instance_id,
+                                              message_type msg,
                                               size_t program_counter,
                                               value sender,
                                               value sender_id,
@@ -10,6 +11,7 @@ gorc::cog::call_stack_frame::call_stack_frame(cog_id instance_id,
                                               value param2,
                                               value param3)
     : instance_id(instance_id)
+    , msg(msg)
     , program_counter(program_counter)
     , sender(sender)
     , sender_id(sender_id)
@@ -25,6 +27,7 @@ gorc::cog::call_stack_frame::call_stack_frame(cog_id instance_id,
 gorc::cog::call_stack_frame::call_stack_frame(deserialization_constructor_tag,
                                               binary_input_stream &bis)
     : instance_id(deserialization_constructor, bis)
+    , msg(binary_deserialize<message_type>(bis))
     , program_counter(binary_deserialize<size_t>(bis))
     , sender(binary_deserialize<value>(bis))
     , sender_id(binary_deserialize<value>(bis))
@@ -43,6 +46,7 @@ gorc::cog::call_stack_frame::call_stack_frame(deserialization_constructor_tag,
 void gorc::cog::call_stack_frame::binary_serialize_object(binary_output_stream &bos) const
 {
     binary_serialize(bos, instance_id);
+    binary_serialize(bos, msg);
     binary_serialize(bos, program_counter);
     binary_serialize(bos, sender);
     binary_serialize(bos, sender_id);
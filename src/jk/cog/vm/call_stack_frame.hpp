@@ -1,5 +1,6 @@
 #pragma once
 
+#include "jk/cog/script/message_type.hpp"
 #include "jk/cog/script/script.hpp"
 #include "heap.hpp"
 #include "content/asset_ref.hpp"
@@ -13,6 +14,7 @@ namespace gorc {
         class call_stack_frame {
         public:
             cog_id instance_id;
+            message_type msg;
             size_t program_counter;
             value sender;
             value sender_id;
@@ -31,6 +33,7 @@ namespace gorc {
             bool push_return_register = false;
 
             call_stack_frame(cog_id instance_id,
+                             message_type msg,
                              size_t program_counter,
                              value sender,
                              value sender_id,
@@ -1,7 +1,7 @@
 #pragma once
 
-#include <vector>
 #include "jk/cog/script/stack.hpp"
+#include "utility/small_vector.hpp"
 #include "call_stack_frame.hpp"
 #include "jk/cog/script/value.hpp"
 #include "io/binary_input_stream.hpp"
@@ -12,7 +12,7 @@ namespace gorc {
 
         class continuation {
         public:
-            std::vector<call_stack_frame> call_stack;
+            small_vector<call_stack_frame, 4> call_stack;
             cog::stack data_stack;
 
             continuation() = default;
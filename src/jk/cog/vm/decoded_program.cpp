@@ -0,0 +1,170 @@
+#include "decoded_program.hpp"
+#include "io/binary_input_stream.hpp"
+#include "log/log.hpp"
+#include <algorithm>
+
+gorc::cog::instruction::instruction(opcode op)
+    : op(op)
+{
+    return;
+}
+
+gorc::cog::decoded_program::decoded_program(script const &cog, verb_table const &verbs)
+{
+    memory_file::reader sr(cog.program);
+    binary_input_stream bsr(sr);
+
+    while(!sr.at_end()) {
+        offsets.push_back(sr.position());
+        instructions.emplace_back(binary_deserialize<opcode>(bsr));
+        auto &inst = instructions.back();
+
+        switch(inst.op) {
+        case opcode::push:
+            inst.immediate = value(deserialization_constructor, bsr);
+            break;
+
+        case opcode::incr:
+        case opcode::decr:
+        case opcode::incrg:
+        case opcode::decrg:
+            inst.address = binary_deserialize<size_t>(bsr);
+            inst.immediate = value(deserialization_constructor, bsr);
+            break;
+
+        case opcode::load:
+        case opcode::loadi:
+        case opcode::loadg:
+        case opcode::loadgi:
+        case opcode::stor:
+        case opcode::stori:
+        case opcode::storg:
+        case opcode::storgi:
+        case opcode::jmp:
+        case opcode::jal:
+        case opcode::bt:
+        case opcode::bf:
+        case opcode::bteq:
+        case opcode::btne:
+        case opcode::btgt:
+        case opcode::btge:
+        case opcode::btlt:
+        case opcode::btle:
+        case opcode::bfeq:
+        case opcode::bfne:
+        case opcode::bfgt:
+        case opcode::bfge:
+        case opcode::bflt:
+        case opcode::bfle:
+            inst.address = binary_deserialize<size_t>(bsr);
+            break;
+
+        case opcode::call:
+        case opcode::callv: {
+            inst.target_verb = &verbs.get_verb(verb_id(binary_deserialize<int>(bsr)));
+
+            int first_line = binary_deserialize<int>(bsr);
+            int first_col = binary_deserialize<int>(bsr);
+            int last_line = binary_deserialize<int>(bsr);
+            int last_col = binary_deserialize<int>(bsr);
+            call_locations.emplace_back(instructions.size() - 1,
+                                        diagnostic_context_location(cog.filename.c_str(),
+                                                                    first_line,
+                                                                    first_col,
+                                                                    last_line,
+                                                                    last_col));
+        } break;
+
+        case opcode::dup:
+        case opcode::ret:
+        case opcode::neg:
+        case opcode::lnot:
+        case opcode::add:
+        case opcode::sub:
+        case opcode::mul:
+        case opcode::div:
+        case opcode::mod:
+        case opcode::bor:
+        case opcode::band:
+        case opcode::bxor:
+        case opcode::lor:
+        case opcode::land:
+        case opcode::eq:
+        case opcode::ne:
+        case opcode::gt:
+        case opcode::ge:
+        case opcode::lt:
+        case opcode::le:
+            break;
+
+        default:
+            LOG_FATAL(format("invalid opcode %d at offset %d") %
+                      static_cast<int>(inst.op) %
+                      offsets.back());
+        }
+
+        inst.next_offset = sr.position();
+    }
+
+    // Branches may target the end of the program text. Terminate with a sentinel return.
+    offsets.push_back(sr.position());
+    instructions.emplace_back(opcode::ret);
+    instructions.back().next_offset = sr.position();
+
+    // Resolve branch targets to instruction indices
+    for(auto &inst : instructions) {
+        switch(inst.op) {
+        case opcode::jmp:
+        case opcode::jal:
+        case opcode::bt:
+        case opcode::bf:
+        case opcode::bteq:
+        case opcode::btne:
+        case opcode::btgt:
+        case opcode::btge:
+        case opcode::btlt:
+        case opcode::btle:
+        case opcode::bfeq:
+        case opcode::bfne:
+        case opcode::bfgt:
+        case opcode::bfge:
+        case opcode::bflt:
+        case opcode::bfle:
+            inst.address = get_index(inst.address);
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+size_t gorc::cog::decoded_program::get_index(size_t program_offset) const
+{
+    auto it = std::lower_bound(offsets.begin(), offsets.end(), program_offset);
+    if(it == offsets.end() || *it != program_offset) {
+        LOG_FATAL(format("program offset %d is not an instruction boundary") % program_offset);
+    }
+
+    return static_cast<size_t>(std::distance(offsets.begin(), it));
+}
+
+size_t gorc::cog::decoded_program::get_offset(size_t index) const
+{
+    return offsets[index];
+}
+
+gorc::diagnostic_context_location gorc::cog::decoded_program::get_call_location(size_t index) const
+{
+    auto it = std::lower_bound(call_locations.begin(),
+                               call_locations.end(),
+                               index,
+                               [](auto const &em, size_t index) {
+                                   return std::get<0>(em) < index;
+                               });
+    if(it == call_locations.end() || std::get<0>(*it) != index) {
+        LOG_FATAL(format("instruction %d is not a verb call") % index);
+    }
+
+    return std::get<1>(*it);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "jk/cog/script/script.hpp"
+#include "jk/cog/script/value.hpp"
+#include "jk/cog/script/verb.hpp"
+#include "jk/cog/script/verb_table.hpp"
+#include "log/diagnostic_context_location.hpp"
+#include "opcode.hpp"
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+namespace gorc {
+    namespace cog {
+
+        class instruction {
+        public:
+            opcode op;
+
+            // Byte offset of the following instruction in the serialized program.
+            // Stored in the call stack frame whenever execution may leave this instruction.
+            size_t next_offset = 0;
+
+            // Heap address for memory operations, instruction index for branches.
+            size_t address = 0;
+
+            value immediate;
+
+            verb const *target_verb = nullptr;
+
+            explicit instruction(opcode op);
+        };
+
+        // Load-time decoding of a script program. Branch targets are resolved to instruction
+        // indices and verb ids to verb pointers, so that the virtual machine does not need to
+        // deserialize the byte stream while executing.
+        class decoded_program {
+        private:
+            std::vector<size_t> offsets;
+
+            // Source locations of verb calls, sorted by instruction index. Only needed when a
+            // verb writes a diagnostic, so they are kept out of the instruction stream.
+            std::vector<std::tuple<size_t, diagnostic_context_location>> call_locations;
+
+        public:
+            std::vector<instruction> instructions;
+
+            decoded_program(script const &cog, verb_table const &verbs);
+
+            size_t get_index(size_t program_offset) const;
+            size_t get_offset(size_t index) const;
+
+            diagnostic_context_location get_call_location(size_t index) const;
+        };
+
+    }
+}
@@ -199,8 +199,7 @@ namespace {
                     cc.data_stack.push_back(value());
                 }
 
-                exec.add_sleep_record(std::make_unique<sleep_record>(continuation(cc),
-                                                                     time_delta(time)));
+                exec.add_sleep_record(continuation(cc), time_delta(time));
                 throw suspend_exception();
             });
 
@@ -1,18 +1,70 @@
 #include "executor.hpp"
 #include "log/log.hpp"
 #include "utility/range.hpp"
+#include <algorithm>
 
-bool gorc::cog::detail::executor_link_comp::operator()(value left, value right) const
+namespace {
+    size_t combine_key_hash(int first, gorc::cog::value second)
+    {
+        size_t seed = second.get_hash();
+        return seed ^ (static_cast<size_t>(first) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+    }
+
+    // Records sharing a key are serialized individually, as they were by the original
+    // tree-based indexes.
+    template <typename IndexT, typename FmtFnT>
+    void serialize_multi_index(gorc::binary_output_stream &bos, IndexT const &index, FmtFnT fn)
+    {
+        size_t count = 0;
+        for(auto const &em : index) {
+            count += em.second.size();
+        }
+
+        gorc::binary_serialize(bos, count);
+        for(auto const &em : index) {
+            for(auto const &record : em.second) {
+                fn(bos, em.first, record);
+            }
+        }
+    }
+}
+
+size_t gorc::cog::detail::executor_key_hash::operator()(value v) const
+{
+    return v.get_hash();
+}
+
+size_t gorc::cog::detail::executor_key_hash::
+    operator()(std::tuple<message_type, value> const &key) const
 {
-    return std::make_tuple(left.get_type(), left) < std::make_tuple(right.get_type(), right);
+    return combine_key_hash(static_cast<int>(std::get<0>(key)), std::get<1>(key));
 }
 
-bool gorc::cog::detail::executor_wait_comp::
+size_t gorc::cog::detail::executor_key_hash::
+    operator()(std::tuple<cog_id, value> const &key) const
+{
+    return combine_key_hash(static_cast<int>(std::get<0>(key)), std::get<1>(key));
+}
+
+bool gorc::cog::detail::executor_key_equal::operator()(value left, value right) const
+{
+    return left.is_identical(right);
+}
+
+bool gorc::cog::detail::executor_key_equal::
     operator()(std::tuple<message_type, value> const &left,
                std::tuple<message_type, value> const &right) const
 {
-    return std::make_tuple(std::get<0>(left), std::get<1>(left).get_type(), std::get<1>(left)) <
-           std::make_tuple(std::get<0>(right), std::get<1>(right).get_type(), std::get<1>(right));
+    return std::get<0>(left) == std::get<0>(right) &&
+           std::get<1>(left).is_identical(std::get<1>(right));
+}
+
+bool gorc::cog::detail::executor_key_equal::
+    operator()(std::tuple<cog_id, value> const &left,
+               std::tuple<cog_id, value> const &right) const
+{
+    return std::get<0>(left) == std::get<0>(right) &&
+           std::get<1>(left).is_identical(std::get<1>(right));
 }
 
 bool gorc::cog::detail::executor_gi_comp::operator()(asset_ref<script> left,
@@ -23,15 +75,22 @@ bool gorc::cog::detail::executor_gi_comp::operator()(asset_ref<script> left,
 }
 
 bool gorc::cog::detail::executor_timer_comp::
-    operator()(std::tuple<cog_id, value> const &left, std::tuple<cog_id, value> const &right) const
+    operator()(std::tuple<cog_id, value, uint64_t> const &left,
+               std::tuple<cog_id, value, uint64_t> const &right) const
 {
-    return std::make_tuple(std::get<0>(left), std::get<1>(left).get_type(), std::get<1>(left)) <
-           std::make_tuple(std::get<0>(right), std::get<1>(right).get_type(), std::get<1>(right));
+    return std::make_tuple(std::get<0>(left),
+                           std::get<1>(left).get_type(),
+                           std::get<1>(left),
+                           std::get<2>(left)) < std::make_tuple(std::get<0>(right),
+                                                                std::get<1>(right).get_type(),
+                                                                std::get<1>(right),
+                                                                std::get<2>(right));
 }
 
 gorc::cog::executor::executor(service_registry const &parent)
     : verbs(parent.get<verb_table>())
     , services(&parent)
+    , message_subscribers(static_cast<size_t>(message_type::trigger) + 1)
 {
     services.add(*this);
     services.add(vm);
@@ -41,6 +100,7 @@ gorc::cog::executor::executor(service_registry const &parent)
 gorc::cog::executor::executor(deserialization_constructor_tag, binary_input_stream &bis)
     : verbs(bis.services.get<verb_table>())
     , services(&bis.services)
+    , message_subscribers(static_cast<size_t>(message_type::trigger) + 1)
 {
     services.add(*this);
     services.add(vm);
@@ -49,34 +109,48 @@ gorc::cog::executor::executor(deserialization_constructor_tag, binary_input_stre
         return std::make_unique<instance>(deserialization_constructor, bis);
     });
 
-    binary_deserialize_range(bis, std::back_inserter(sleep_records), [](auto &bis) {
-        return std::make_unique<sleep_record>(deserialization_constructor, bis);
+    for(size_t i = 0; i < instances.size(); ++i) {
+        add_message_subscriptions(cog_id(static_cast<int>(i)), *instances[i]);
+    }
+
+    current_time = binary_deserialize<time_delta>(bis);
+
+    binary_deserialize_range(bis, std::inserter(sleep_records, sleep_records.end()), [&](auto &bis) {
+        auto sr = std::make_unique<sleep_record>(deserialization_constructor, bis);
+        sleep_record_schedule.insert(sr->expiration_time, next_sleep_serial);
+        return std::make_pair(next_sleep_serial++, std::move(sr));
     });
 
-    binary_deserialize_range(bis, std::inserter(wait_records, wait_records.end()), [](auto &bis) {
+    size_t num_wait_records = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_wait_records; ++i) {
         auto mt = binary_deserialize<message_type>(bis);
         auto obj = binary_deserialize<value>(bis);
         auto cont = std::make_unique<continuation>(deserialization_constructor, bis);
-        return std::make_pair(std::make_tuple(mt, obj), std::move(cont));
-    });
+        wait_records[std::make_tuple(mt, obj)].push_back(std::move(cont));
+    }
 
-    binary_deserialize_range(bis, std::inserter(pulse_records, pulse_records.end()), [](auto &is) {
+    binary_deserialize_range(bis, std::inserter(pulse_records, pulse_records.end()), [&](auto &is) {
         auto inst = binary_deserialize<cog_id>(is);
-        return std::make_pair(inst, pulse_record(deserialization_constructor, is));
+        pulse_record pr(deserialization_constructor, is);
+        pulse_record_schedule.insert(pr.expiration_time, inst);
+        return std::make_pair(inst, pr);
     });
 
-    binary_deserialize_range(bis, std::inserter(timer_records, timer_records.end()), [](auto &is) {
-        auto inst = binary_deserialize<cog_id>(is);
-        auto timer_id = binary_deserialize<value>(is);
-        return std::make_pair(std::make_tuple(inst, timer_id),
-                              timer_record(deserialization_constructor, is));
-    });
+    size_t num_timer_records = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_timer_records; ++i) {
+        auto inst = binary_deserialize<cog_id>(bis);
+        auto timer_id = binary_deserialize<value>(bis);
+        uint64_t serial = next_timer_serial++;
+        timer_record tr(deserialization_constructor, bis);
+        timer_record_schedule.insert(tr.expiration_time, std::make_tuple(inst, timer_id, serial));
+        timer_records[std::make_tuple(inst, timer_id)].emplace_back(serial, tr);
+    }
 
-    binary_deserialize_range(bis, std::inserter(linkages, linkages.end()), [](auto &bis) {
+    size_t num_linkages = binary_deserialize<size_t>(bis);
+    for(size_t i = 0; i < num_linkages; ++i) {
         auto obj = binary_deserialize<value>(bis);
-        auto st = binary_deserialize<executor_linkage>(bis);
-        return std::make_pair(obj, st);
-    });
+        linkages[obj].push_back(binary_deserialize<executor_linkage>(bis));
+    }
 
     binary_deserialize_range(
         bis, std::inserter(global_instance_map, global_instance_map.end()), [](auto &bis) {
@@ -94,14 +168,16 @@ void gorc::cog::executor::binary_serialize_object(binary_output_stream &bos) con
         binary_serialize(bos, *em);
     });
 
+    binary_serialize(bos, current_time);
+
     binary_serialize_range(bos, sleep_records, [](auto &bos, auto const &em) {
-        binary_serialize(bos, *em);
+        binary_serialize(bos, *em.second);
     });
 
-    binary_serialize_range(bos, wait_records, [](auto &bos, auto const &em) {
-        binary_serialize(bos, std::get<0>(em.first));
-        binary_serialize(bos, std::get<1>(em.first));
-        binary_serialize(bos, *em.second);
+    serialize_multi_index(bos, wait_records, [](auto &bos, auto const &key, auto const &cc) {
+        binary_serialize(bos, std::get<0>(key));
+        binary_serialize(bos, std::get<1>(key));
+        binary_serialize(bos, *cc);
     });
 
     binary_serialize_range(bos, pulse_records, [](auto &bos, auto const &em) {
@@ -109,15 +185,15 @@ void gorc::cog::executor::binary_serialize_object(binary_output_stream &bos) con
         binary_serialize(bos, em.second);
     });
 
-    binary_serialize_range(bos, timer_records, [](auto &bos, auto const &em) {
-        binary_serialize(bos, std::get<0>(em.first));
-        binary_serialize(bos, std::get<1>(em.first));
-        binary_serialize(bos, em.second);
+    serialize_multi_index(bos, timer_records, [](auto &bos, auto const &key, auto const &tr) {
+        binary_serialize(bos, std::get<0>(key));
+        binary_serialize(bos, std::get<1>(key));
+        binary_serialize(bos, std::get<1>(tr));
     });
 
-    binary_serialize_range(bos, linkages, [](auto &bos, auto const &em) {
-        binary_serialize(bos, em.first);
-        binary_serialize(bos, em.second);
+    serialize_multi_index(bos, linkages, [](auto &bos, auto const &obj, auto const &link) {
+        binary_serialize(bos, obj);
+        binary_serialize(bos, link);
     });
 
     binary_serialize_range(bos, global_instance_map, [](auto &bos, auto const &em) {
@@ -131,7 +207,23 @@ void gorc::cog::executor::binary_serialize_object(binary_output_stream &bos) con
 void gorc::cog::executor::add_linkage(cog_id id, instance const &inst)
 {
     for(auto const &link : inst.linkages) {
-        linkages.emplace(link.object, executor_linkage(link.mask, id, link.sender_link_id));
+        linkages[link.object].emplace_back(link.mask, id, link.sender_link_id);
+    }
+}
+
+void gorc::cog::executor::add_message_subscriptions(cog_id id, instance const &inst)
+{
+    // Instances created by another instance's constructor are added first. Subscribers are
+    // kept in id order, which is the order broadcasts were originally delivered in.
+    for(auto const &em : inst.cog->exports) {
+        auto &subscribers = message_subscribers.at(static_cast<size_t>(em.first));
+        auto it = std::upper_bound(subscribers.begin(),
+                                   subscribers.end(),
+                                   id,
+                                   [](cog_id left, auto const &right) {
+                                       return left < std::get<0>(right);
+                                   });
+        subscribers.emplace(it, id, em.second);
     }
 }
 
@@ -142,6 +234,8 @@ gorc::cog_id gorc::cog::executor::create_instance(asset_ref<cog::script> cog)
     instances.push_back(nullptr);
     at_id(instances, new_cog) = std::make_unique<instance>(services, cog);
     add_linkage(new_cog, *instances.back());
+    add_message_subscriptions(new_cog, *at_id(instances, new_cog));
+    vm.get_program(*cog, verbs);
     return new_cog;
 }
 
@@ -153,6 +247,8 @@ gorc::cog_id gorc::cog::executor::create_instance(asset_ref<cog::script> cog,
     instances.push_back(nullptr);
     at_id(instances, new_cog) = std::make_unique<instance>(services, cog, values);
     add_linkage(new_cog, *instances.back());
+    add_message_subscriptions(new_cog, *at_id(instances, new_cog));
+    vm.get_program(*cog, verbs);
     return new_cog;
 }
 
@@ -170,6 +266,8 @@ gorc::cog_id gorc::cog::executor::create_global_instance(asset_ref<cog::script>
 
     at_id(instances, new_cog) = std::make_unique<instance>(services, cog);
     add_linkage(new_cog, *instances.back());
+    add_message_subscriptions(new_cog, *at_id(instances, new_cog));
+    vm.get_program(*cog, verbs);
     return new_cog;
 }
 
@@ -178,17 +276,20 @@ gorc::cog::instance &gorc::cog::executor::get_instance(cog_id instance_id)
     return *at_id(instances, instance_id);
 }
 
-void gorc::cog::executor::add_sleep_record(std::unique_ptr<sleep_record> &&sr)
+void gorc::cog::executor::add_sleep_record(continuation &&cc, time_delta duration)
 {
-    sleep_records.push_back(std::forward<std::unique_ptr<sleep_record>>(sr));
+    auto sr = std::make_unique<sleep_record>(std::forward<continuation>(cc),
+                                             current_time + duration);
+    sleep_record_schedule.insert(sr->expiration_time, next_sleep_serial);
+    sleep_records.emplace(next_sleep_serial++, std::move(sr));
 }
 
 void gorc::cog::executor::add_wait_record(message_type msg,
                                           value sender,
                                           std::unique_ptr<continuation> &&cc)
 {
-    wait_records.emplace(std::make_tuple(msg, sender),
-                         std::forward<std::unique_ptr<continuation>>(cc));
+    wait_records[std::make_tuple(msg, sender)].push_back(
+        std::forward<std::unique_ptr<continuation>>(cc));
 }
 
 void gorc::cog::executor::add_timer_record(cog_id instance_id,
@@ -197,20 +298,41 @@ void gorc::cog::executor::add_timer_record(cog_id instance_id,
                                            value param0,
                                            value param1)
 {
-    timer_records.emplace(std::make_tuple(instance_id, timer_id),
-                          timer_record(duration, param0, param1));
+    uint64_t serial = next_timer_serial++;
+    timer_record_schedule.insert(current_time + duration,
+                                 std::make_tuple(instance_id, timer_id, serial));
+    timer_records[std::make_tuple(instance_id, timer_id)].emplace_back(
+        serial, timer_record(duration, current_time + duration, param0, param1));
 }
 
 void gorc::cog::executor::erase_timer_record(cog_id instance_id, value timer_id)
 {
-    timer_records.erase(std::make_tuple(instance_id, timer_id));
+    auto key = std::make_tuple(instance_id, timer_id);
+    auto it = timer_records.find(key);
+    if(it == timer_records.end()) {
+        return;
+    }
+
+    for(auto const &tr : it->second) {
+        timer_record_schedule.erase(std::get<1>(tr).expiration_time,
+                                    std::make_tuple(instance_id, timer_id, std::get<0>(tr)));
+    }
+
+    timer_records.erase(key);
 }
 
 void gorc::cog::executor::set_pulse(cog_id instance_id, maybe<time_delta> duration)
 {
-    pulse_records.erase(instance_id);
-    maybe_if(duration,
-             [&](time_delta dt) { pulse_records.emplace(instance_id, pulse_record(dt)); });
+    auto it = pulse_records.find(instance_id);
+    if(it != pulse_records.end()) {
+        pulse_record_schedule.erase(it->second.expiration_time, instance_id);
+        pulse_records.erase(it);
+    }
+
+    maybe_if(duration, [&](time_delta dt) {
+        pulse_records.emplace(instance_id, pulse_record(dt, current_time + dt));
+        pulse_record_schedule.insert(current_time + dt, instance_id);
+    });
 }
 
 gorc::maybe<gorc::cog::call_stack_frame> gorc::cog::executor::create_message_frame(cog_id target,
@@ -238,8 +360,12 @@ gorc::maybe<gorc::cog::call_stack_frame> gorc::cog::executor::create_message_fra
         return nothing;
     }
 
+    if(profiler *prof = vm.get_profiler()) {
+        prof->count_message(inst->cog->filename, msg);
+    }
+
     return call_stack_frame(
-        target, addr.get_value(), sender, sender_id, source, param0, param1, param2, param3);
+        target, msg, addr.get_value(), sender, sender_id, source, param0, param1, param2, param3);
 }
 
 gorc::cog::value gorc::cog::executor::send(cog_id instance,
@@ -261,13 +387,19 @@ gorc::cog::value gorc::cog::executor::send(cog_id instance,
     }
 
     diagnostic_context dc(inst->cog->filename.c_str());
-    LOG_DEBUG(format("instance %d received %s message %s "
-                     "from sender %s due to source %s") %
-              static_cast<int>(instance) % send_reason % as_string(t) % as_string(sender) %
-              as_string(source));
+    if(is_log_level_enabled(log_level::debug)) {
+        LOG_DEBUG(format("instance %d received %s message %s "
+                         "from sender %s due to source %s") %
+                  static_cast<int>(instance) % send_reason % as_string(t) % as_string(sender) %
+                  as_string(source));
+    }
+
+    if(profiler *prof = vm.get_profiler()) {
+        prof->count_message(inst->cog->filename, t);
+    }
 
     continuation cc(call_stack_frame(
-        instance, addr.get_value(), sender, sender_id, source, param0, param1, param2, param3));
+        instance, t, addr.get_value(), sender, sender_id, source, param0, param1, param2, param3));
     return vm.execute(globals, verbs, *this, services, cc);
 }
 
@@ -280,8 +412,35 @@ void gorc::cog::executor::send_to_all(message_type t,
                                       value param2,
                                       value param3)
 {
-    for(size_t i = 0; i < instances.size(); ++i) {
-        send(cog_id(i), t, sender, sender_id, source, param0, param1, param2, param3, "broadcast");
+    // Message handlers may create instances, which also receive the broadcast. The
+    // subscriber list is searched again after each message.
+    auto const &subscribers = message_subscribers.at(static_cast<size_t>(t));
+    profiler *prof = vm.get_profiler();
+
+    // Handlers that suspend store a copy of the continuation, so one buffer is reused.
+    continuation cc;
+    for(size_t i = 0; i < subscribers.size(); ++i) {
+        cog_id instance = std::get<0>(subscribers[i]);
+        size_t addr = std::get<1>(subscribers[i]);
+        auto const &inst = at_id(instances, instance);
+
+        diagnostic_context dc(inst->cog->filename.c_str());
+        if(is_log_level_enabled(log_level::debug)) {
+            LOG_DEBUG(format("instance %d received broadcast message %s "
+                             "from sender %s due to source %s") %
+                      static_cast<int>(instance) % as_string(t) % as_string(sender) %
+                      as_string(source));
+        }
+
+        if(prof) {
+            prof->count_message(inst->cog->filename, t);
+        }
+
+        cc.call_stack.clear();
+        cc.data_stack.clear();
+        cc.call_stack.emplace_back(
+            instance, t, addr, sender, sender_id, source, param0, param1, param2, param3);
+        vm.execute(globals, verbs, *this, services, cc);
     }
 }
 
@@ -294,18 +453,26 @@ void gorc::cog::executor::send_to_linked(message_type t,
                                          value param2,
                                          value param3)
 {
-    // Dispatch message to all linked level cogs
-    for(auto const &link : make_range(linkages.equal_range(sender))) {
+    // Dispatch message to all linked level cogs. Message handlers may create instances and
+    // add linkages, so the index is searched again after each message.
+    for(size_t i = 0;; ++i) {
+        auto it = linkages.find(sender);
+        if(it == linkages.end() || i >= it->second.size()) {
+            break;
+        }
+
+        executor_linkage link = it->second[i];
+
         // System source type cannot be masked.
-        if(!(link.second.mask & st) && (st != source_type::system)) {
+        if(!(link.mask & st) && (st != source_type::system)) {
             // This source type is masked. Don't dispatch message.
             continue;
         }
 
-        send(link.second.instance_id,
+        send(link.instance_id,
              t,
              sender,
-             link.second.sender_link_id,
+             link.sender_link_id,
              source,
              param0,
              param1,
@@ -316,15 +483,25 @@ void gorc::cog::executor::send_to_linked(message_type t,
 
     // Some cogs may have blocked on a particular message. For example, the
     // WaitForStop verb blocks until the correct arrived message is sent.
-    // Resume any continuations matching this message.
-    auto wait_rng = wait_records.equal_range(std::make_tuple(t, sender));
-    for(auto it = wait_rng.first; it != wait_rng.second;) {
-        auto curr_it = it++;
-        vm.execute(globals, verbs, *this, services, *curr_it->second);
-        wait_records.erase(curr_it);
+    // Resume any continuations matching this message. Resumed continuations may wait again,
+    // so the matching records are detached before they are resumed.
+    auto wait_key = std::make_tuple(t, sender);
+    auto wait_it = wait_records.find(wait_key);
+    if(wait_it != wait_records.end()) {
+        auto continuations = std::move(wait_it->second);
+        wait_records.erase(wait_key);
+
+        for(auto const &cc : continuations) {
+            vm.execute(globals, verbs, *this, services, *cc);
+        }
     }
 }
 
+void gorc::cog::executor::set_profiler(profiler *prof)
+{
+    vm.set_profiler(prof);
+}
+
 void gorc::cog::executor::set_master_cog(cog_id id)
 {
     master_cog = id;
@@ -337,85 +514,72 @@ gorc::cog_id gorc::cog::executor::get_master_cog() const
 
 void gorc::cog::executor::update(time_delta dt)
 {
-    // Decrement times first.
-    // Continuations may insert new records. The new records shouldn't be decremented this frame.
-    for(auto &timer_record : timer_records) {
-        timer_record.second.remaining -= dt;
-    }
+    // Advance the clock first. Records inserted by event handlers expire relative to the new
+    // time, so they are not shortened by this frame.
+    current_time += dt;
 
-    for(auto &pulse_record : pulse_records) {
-        pulse_record.second.remaining -= dt;
-    }
-
-    for(auto &sleep_record : sleep_records) {
-        sleep_record->expiration_time -= dt;
-    }
-
-    // Intentionally quadratic. The timer records data structure may be modified by timer event
-    // handlers. Repeatedly searching the map is still more efficient than copying this data.
+    // Event handlers may insert or erase records. Each expired record is fetched from the
+    // schedule only when the previous handler has returned.
     while(true) {
-        bool seen_any = false;
-        for(auto it = timer_records.begin(); it != timer_records.end(); ++it) {
-            if(it->second.remaining <= 0.0s) {
-                cog_id instance = std::get<0>(it->first);
-                value sender_id = std::get<1>(it->first);
-                value param0 = it->second.param0;
-                value param1 = it->second.param1;
-
-                timer_records.erase(it);
-
-                send(instance,
-                     message_type::timer,
-                     /* sender */ value(),
-                     sender_id,
-                     /* source */ value(),
-                     param0,
-                     param1);
-
-                seen_any = true;
-                break;
-            }
+        auto key = timer_record_schedule.pop_expired(current_time);
+        if(!key.has_value()) {
+            break;
         }
 
-        if(!seen_any) {
-            break;
+        cog_id instance = std::get<0>(key.get_value());
+        value sender_id = std::get<1>(key.get_value());
+        uint64_t serial = std::get<2>(key.get_value());
+
+        auto record_key = std::make_tuple(instance, sender_id);
+        auto &records = timer_records.find(record_key)->second;
+        auto record_it = std::find_if(records.begin(), records.end(), [&](auto const &tr) {
+            return std::get<0>(tr) == serial;
+        });
+
+        value param0 = std::get<1>(*record_it).param0;
+        value param1 = std::get<1>(*record_it).param1;
+
+        records.erase(record_it);
+        if(records.empty()) {
+            timer_records.erase(record_key);
         }
+
+        send(instance,
+             message_type::timer,
+             /* sender */ value(),
+             sender_id,
+             /* source */ value(),
+             param0,
+             param1);
     }
 
-    // Intentionally quadratic. The pulse records data structure may be modified by pulse event
-    // handlers. Repeatedly searching the map is still more efficient than copying this data.
     while(true) {
-        bool seen_any = false;
-        for(auto it = pulse_records.begin(); it != pulse_records.end(); ++it) {
-            if(it->second.remaining <= 0.0s) {
-                it->second.remaining += it->second.duration;
-
-                send(it->first,
-                     message_type::pulse,
-                     /* sender */ value(),
-                     /* sender id */ value(),
-                     /* source */ value());
-
-                seen_any = true;
-                break;
-            }
+        auto key = pulse_record_schedule.pop_expired(current_time);
+        if(!key.has_value()) {
+            break;
         }
 
-        if(!seen_any) {
+        auto &pr = pulse_records.at(key.get_value());
+        pr.expiration_time += pr.duration;
+        pulse_record_schedule.insert(pr.expiration_time, key.get_value());
+
+        send(key.get_value(),
+             message_type::pulse,
+             /* sender */ value(),
+             /* sender id */ value(),
+             /* source */ value());
+    }
+
+    while(true) {
+        auto key = sleep_record_schedule.pop_expired(current_time);
+        if(!key.has_value()) {
             break;
         }
-    }
 
-    for(auto it = sleep_records.begin(); it != sleep_records.end();) {
-        if((*it)->expiration_time <= 0.0s) {
-            auto sr = std::move(*it);
-            std::swap(*it, sleep_records.back());
-            sleep_records.pop_back();
+        auto it = sleep_records.find(key.get_value());
+        auto sr = std::move(it->second);
+        sleep_records.erase(it);
 
-            vm.execute(globals, verbs, *this, services, sr->cc);
-        }
-        else {
-            ++it;
-        }
+        vm.execute(globals, verbs, *this, services, sr->cc);
     }
 }
@@ -13,6 +13,8 @@
 #include "pulse_record.hpp"
 #include "sleep_record.hpp"
 #include "timer_record.hpp"
+#include "timer_schedule.hpp"
+#include "utility/flat_hash_map.hpp"
 #include "utility/range.hpp"
 #include "utility/service_registry.hpp"
 #include "virtual_machine.hpp"
@@ -25,13 +27,19 @@ namespace gorc {
     namespace cog {
 
         namespace detail {
-            struct executor_link_comp {
-                bool operator()(value left, value right) const;
+            // Hash index keys compare the exact type and payload of values
+            struct executor_key_hash {
+                size_t operator()(value) const;
+                size_t operator()(std::tuple<message_type, value> const &) const;
+                size_t operator()(std::tuple<cog_id, value> const &) const;
             };
 
-            struct executor_wait_comp {
+            struct executor_key_equal {
+                bool operator()(value, value) const;
                 bool operator()(std::tuple<message_type, value> const &,
                                 std::tuple<message_type, value> const &) const;
+                bool operator()(std::tuple<cog_id, value> const &,
+                                std::tuple<cog_id, value> const &) const;
             };
 
             struct executor_gi_comp {
@@ -39,8 +47,8 @@ namespace gorc {
             };
 
             struct executor_timer_comp {
-                bool operator()(std::tuple<cog_id, value> const &,
-                                std::tuple<cog_id, value> const &) const;
+                bool operator()(std::tuple<cog_id, value, uint64_t> const &,
+                                std::tuple<cog_id, value, uint64_t> const &) const;
             };
         }
 
@@ -53,21 +61,48 @@ namespace gorc {
 
             std::vector<std::unique_ptr<instance>> instances;
 
-            std::vector<std::unique_ptr<sleep_record>> sleep_records;
-            std::multimap<std::tuple<message_type, value>,
-                          std::unique_ptr<continuation>,
-                          detail::executor_wait_comp>
+            // Instances exporting each message, in creation order, with the handler offset.
+            // Indexed by message type.
+            std::vector<std::vector<std::tuple<cog_id, size_t>>> message_subscribers;
+
+            // Sleep, pulse and timer records expire at an absolute time. Timer and sleep
+            // records are keyed by a serial number to preserve insertion order.
+            time_delta current_time = 0.0s;
+
+            uint64_t next_sleep_serial = 0;
+            std::map<uint64_t, std::unique_ptr<sleep_record>> sleep_records;
+            timer_schedule<uint64_t> sleep_record_schedule;
+
+            // Records sharing a key are kept in insertion order
+            flat_hash_map<std::tuple<message_type, value>,
+                          std::vector<std::unique_ptr<continuation>>,
+                          detail::executor_key_hash,
+                          detail::executor_key_equal>
                 wait_records;
+
             std::map<cog_id, pulse_record> pulse_records;
-            std::multimap<std::tuple<cog_id, value>, timer_record, detail::executor_timer_comp>
-                timer_records;
+            timer_schedule<cog_id> pulse_record_schedule;
 
-            std::multimap<value, executor_linkage, detail::executor_link_comp> linkages;
+            uint64_t next_timer_serial = 0;
+            flat_hash_map<std::tuple<cog_id, value>,
+                          std::vector<std::tuple<uint64_t, timer_record>>,
+                          detail::executor_key_hash,
+                          detail::executor_key_equal>
+                timer_records;
+            timer_schedule<std::tuple<cog_id, value, uint64_t>, detail::executor_timer_comp>
+                timer_record_schedule;
+
+            flat_hash_map<value,
+                          std::vector<executor_linkage>,
+                          detail::executor_key_hash,
+                          detail::executor_key_equal>
+                linkages;
             std::map<asset_ref<script>, cog_id, detail::executor_gi_comp> global_instance_map;
 
             cog_id master_cog;
 
             void add_linkage(cog_id id, instance const &inst);
+            void add_message_subscriptions(cog_id id, instance const &inst);
 
         public:
             executor(service_registry const &svc);
@@ -81,7 +116,7 @@ namespace gorc {
 
             instance &get_instance(cog_id instance_id);
 
-            void add_sleep_record(std::unique_ptr<sleep_record> &&);
+            void add_sleep_record(continuation &&, time_delta duration);
             void add_wait_record(message_type msg, value sender, std::unique_ptr<continuation> &&);
             void add_timer_record(cog_id, value id, time_delta, value param0, value param1);
             void erase_timer_record(cog_id, value id);
@@ -126,6 +161,9 @@ namespace gorc {
                                 value param2 = value(),
                                 value param3 = value());
 
+            // Attached profilers are not serialized
+            void set_profiler(profiler *);
+
             void set_master_cog(cog_id);
             cog_id get_master_cog() const;
 
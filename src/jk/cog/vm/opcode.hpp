@@ -49,6 +49,25 @@ namespace gorc {
             ge, // GE : greater or equal
             lt, // LT : less than
             le, // LE : less or equal
+
+            // Superinstructions. These are only produced by the peephole optimizer.
+            incr, // INCR [address] [immediate] : adds immediate to heap value
+            decr, // DECR [address] [immediate] : subtracts immediate from heap value
+            incrg, // INCRG [address] [immediate] : adds immediate to global heap value
+            decrg, // DECRG [address] [immediate] : subtracts immediate from global heap value
+
+            bteq, // BTEQ [address] : jump if top two values are equal
+            btne, // BTNE [address] : jump if top two values are not equal
+            btgt, // BTGT [address] : jump if bottom is greater than top
+            btge, // BTGE [address] : jump if bottom is greater or equal to top
+            btlt, // BTLT [address] : jump if bottom is less than top
+            btle, // BTLE [address] : jump if bottom is less or equal to top
+            bfeq, // BFEQ [address] : jump unless top two values are equal
+            bfne, // BFNE [address] : jump unless top two values are not equal
+            bfgt, // BFGT [address] : jump unless bottom is greater than top
+            bfge, // BFGE [address] : jump unless bottom is greater or equal to top
+            bflt, // BFLT [address] : jump unless bottom is less than top
+            bfle, // BFLE [address] : jump unless bottom is less or equal to top
         };
     }
 }
@@ -0,0 +1,187 @@
+#include "profiler.hpp"
+#include <cmath>
+
+namespace {
+    void json_serialize_entry_members(gorc::json_output_stream &f,
+                                      gorc::cog::profile_entry const &entry)
+    {
+        using gorc::json_serialize;
+        using gorc::json_serialize_member;
+
+        json_serialize_member(f, "calls", [&] { json_serialize(f, entry.calls); });
+        json_serialize_member(f, "instructions", [&] {
+                json_serialize(f, entry.total.instructions);
+            });
+        json_serialize_member(f, "self_instructions", [&] {
+                json_serialize(f, entry.self.instructions);
+            });
+        json_serialize_member(f, "allocations", [&] {
+                json_serialize(f, entry.total.allocations);
+            });
+        json_serialize_member(f, "self_allocations", [&] {
+                json_serialize(f, entry.self.allocations);
+            });
+        json_serialize_member(f, "time", [&] { json_serialize(f, entry.total.time.count()); });
+        json_serialize_member(f, "self_time", [&] {
+                json_serialize(f, entry.self.time.count());
+            });
+    }
+}
+
+gorc::cog::profile_sample &gorc::cog::profile_sample::operator+=(profile_sample const &s)
+{
+    instructions += s.instructions;
+    allocations += s.allocations;
+    time += s.time;
+    return *this;
+}
+
+gorc::cog::profile_sample &gorc::cog::profile_sample::operator-=(profile_sample const &s)
+{
+    instructions -= s.instructions;
+    allocations -= s.allocations;
+    time -= s.time;
+    return *this;
+}
+
+gorc::cog::profile_sample gorc::cog::operator-(profile_sample left, profile_sample const &right)
+{
+    return left -= right;
+}
+
+gorc::cog::profiler::profiler(allocation_counter get_allocation_count)
+    : get_allocation_count(get_allocation_count)
+    , epoch(std::chrono::steady_clock::now())
+{
+    return;
+}
+
+gorc::cog::profile_sample gorc::cog::profiler::get_sample() const
+{
+    profile_sample rv;
+    rv.instructions = instruction_count;
+
+    if(get_allocation_count) {
+        rv.allocations = get_allocation_count() - overhead.allocations;
+    }
+
+    rv.time = std::chrono::steady_clock::now() - epoch - overhead.time;
+    return rv;
+}
+
+void gorc::cog::profiler::exclude_overhead(profile_sample const &start)
+{
+    // Instructions are never executed by the profiler. Time and allocations since start
+    // are bookkeeping, and are hidden from all later samples.
+    profile_sample delta = get_sample() - start;
+    overhead.allocations += delta.allocations;
+    overhead.time += delta.time;
+}
+
+void gorc::cog::profiler::enter(profile_sample const &start,
+                                profile_entry &entry,
+                                std::string const &frame_name)
+{
+    ++entry.active_frames;
+
+    std::string path = frames.empty() ? frame_name
+                                      : (*frames.back().path + ";" + frame_name);
+    auto it = folded_stacks.emplace(std::move(path), 0.0).first;
+
+    active_frame frame;
+    frame.entry = &entry;
+    frame.folded_stack = &it->second;
+    frame.path = &it->first;
+    frame.start = start;
+    frames.push_back(frame);
+
+    exclude_overhead(start);
+}
+
+void gorc::cog::profiler::count_message(std::string const &filename, message_type msg)
+{
+    profile_sample start = get_sample();
+    ++messages[std::make_tuple(filename, std::string(as_string(msg)))].calls;
+    exclude_overhead(start);
+}
+
+void gorc::cog::profiler::enter_message(std::string const &filename, message_type msg)
+{
+    profile_sample start = get_sample();
+    char const *message_name = as_string(msg);
+    enter(start,
+          messages[std::make_tuple(filename, std::string(message_name))],
+          filename + ":" + message_name);
+}
+
+void gorc::cog::profiler::enter_verb(verb const &v)
+{
+    profile_sample start = get_sample();
+
+    auto &entry = verbs[v.name];
+    ++entry.calls;
+    enter(start, entry, v.name);
+}
+
+void gorc::cog::profiler::leave()
+{
+    profile_sample end = get_sample();
+
+    active_frame frame = frames.back();
+    frames.pop_back();
+
+    profile_sample total = end - frame.start;
+    profile_sample self = total - frame.children;
+
+    if(--frame.entry->active_frames == 0) {
+        frame.entry->total += total;
+    }
+
+    frame.entry->self += self;
+    *frame.folded_stack += std::chrono::duration<double, std::micro>(self.time).count();
+
+    if(!frames.empty()) {
+        frames.back().children += total;
+    }
+
+    exclude_overhead(end);
+}
+
+void gorc::cog::profiler::json_serialize_object(json_output_stream &f) const
+{
+    json_serialize_members(f, [&] {
+            json_serialize_member(f, "messages", [&] {
+                    json_serialize_array(f, messages, [&](auto const &em) {
+                            json_serialize_members(f, [&] {
+                                    json_serialize_member(f, "script", [&] {
+                                            json_serialize(f, std::get<0>(em.first));
+                                        });
+                                    json_serialize_member(f, "message", [&] {
+                                            json_serialize(f, std::get<1>(em.first));
+                                        });
+                                    json_serialize_entry_members(f, em.second);
+                                });
+                        });
+                });
+
+            json_serialize_member(f, "verbs", [&] {
+                    json_serialize_array(f, verbs, [&](auto const &em) {
+                            json_serialize_members(f, [&] {
+                                    json_serialize_member(f, "verb", [&] {
+                                            json_serialize(f, em.first);
+                                        });
+                                    json_serialize_entry_members(f, em.second);
+                                });
+                        });
+                });
+        });
+}
+
+void gorc::cog::profiler::write_folded_stacks(output_stream &os) const
+{
+    // Flame graph tools expect one 'frame;frame;frame count' line per stack
+    for(auto const &em : folded_stacks) {
+        std::string line = em.first + " " + std::to_string(std::llround(em.second)) + "\n";
+        os.write(line.data(), line.size());
+    }
+}
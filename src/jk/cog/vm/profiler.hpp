@@ -0,0 +1,127 @@
+#pragma once
+
+#include "io/output_stream.hpp"
+#include "jk/cog/script/message_type.hpp"
+#include "jk/cog/script/verb.hpp"
+#include "text/json_output_stream.hpp"
+#include "utility/time.hpp"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace gorc {
+    namespace cog {
+
+        class profile_sample {
+        public:
+            uint64_t instructions = 0;
+            uint64_t allocations = 0;
+            time_delta time = 0.0s;
+
+            profile_sample &operator+=(profile_sample const &);
+            profile_sample &operator-=(profile_sample const &);
+        };
+
+        profile_sample operator-(profile_sample, profile_sample const &);
+
+        class profile_entry {
+        public:
+            uint64_t calls = 0;
+
+            // Total includes nested messages and verbs. Self excludes them.
+            profile_sample total;
+            profile_sample self;
+
+            // Recursive frames are only added to the total by the outermost frame
+            int active_frames = 0;
+        };
+
+        // Records instruction counts, wall time and allocation counts for cog messages and
+        // verb calls. Time and allocations spent in the profiler itself are excluded.
+        class profiler {
+        public:
+            using allocation_counter = size_t (*)();
+
+        private:
+            class active_frame {
+            public:
+                profile_entry *entry;
+                double *folded_stack;
+                std::string const *path;
+                profile_sample start;
+                profile_sample children;
+            };
+
+            allocation_counter get_allocation_count;
+            std::chrono::steady_clock::time_point epoch;
+
+            uint64_t instruction_count = 0;
+            profile_sample overhead;
+
+            std::map<std::tuple<std::string, std::string>, profile_entry> messages;
+            std::map<std::string, profile_entry> verbs;
+
+            // Self time in microseconds, keyed by semicolon-separated frame path
+            std::map<std::string, double> folded_stacks;
+
+            std::vector<active_frame> frames;
+
+            profile_sample get_sample() const;
+            void exclude_overhead(profile_sample const &start);
+
+            void enter(profile_sample const &start,
+                       profile_entry &entry,
+                       std::string const &frame_name);
+
+        public:
+            explicit profiler(allocation_counter get_allocation_count = nullptr);
+
+            inline void count_instruction()
+            {
+                ++instruction_count;
+            }
+
+            // Messages are counted when they are dispatched. Their handlers may be entered
+            // several times, e.g. after sleeping or calling another cog.
+            void count_message(std::string const &filename, message_type msg);
+            void enter_message(std::string const &filename, message_type msg);
+
+            void enter_verb(verb const &v);
+            void leave();
+
+            void json_serialize_object(json_output_stream &) const;
+            void write_folded_stacks(output_stream &) const;
+        };
+
+        // Profiles a verb call when a profiler is attached
+        class verb_profile_scope {
+        private:
+            profiler *prof;
+
+        public:
+            verb_profile_scope(profiler *prof, verb const &v);
+            ~verb_profile_scope();
+
+            verb_profile_scope(verb_profile_scope const &) = delete;
+            verb_profile_scope &operator=(verb_profile_scope const &) = delete;
+        };
+
+        inline verb_profile_scope::verb_profile_scope(profiler *prof, verb const &v)
+            : prof(prof)
+        {
+            if(prof) {
+                prof->enter_verb(v);
+            }
+        }
+
+        inline verb_profile_scope::~verb_profile_scope()
+        {
+            if(prof) {
+                prof->leave();
+            }
+        }
+    }
+}
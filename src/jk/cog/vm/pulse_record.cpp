@@ -1,15 +1,16 @@
 #include "pulse_record.hpp"
 
-gorc::cog::pulse_record::pulse_record(time_delta const &duration)
+gorc::cog::pulse_record::pulse_record(time_delta const &duration,
+                                      time_delta const &expiration_time)
     : duration(duration)
-    , remaining(duration)
+    , expiration_time(expiration_time)
 {
     return;
 }
 
 gorc::cog::pulse_record::pulse_record(deserialization_constructor_tag, binary_input_stream &bis)
     : duration(binary_deserialize<time_delta>(bis))
-    , remaining(binary_deserialize<time_delta>(bis))
+    , expiration_time(binary_deserialize<time_delta>(bis))
 {
     return;
 }
@@ -17,5 +18,5 @@ gorc::cog::pulse_record::pulse_record(deserialization_constructor_tag, binary_in
 void gorc::cog::pulse_record::binary_serialize_object(binary_output_stream &bos) const
 {
     binary_serialize(bos, duration);
-    binary_serialize(bos, remaining);
+    binary_serialize(bos, expiration_time);
 }
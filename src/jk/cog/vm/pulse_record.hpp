@@ -9,9 +9,9 @@ namespace gorc {
         class pulse_record {
         public:
             time_delta duration;
-            time_delta remaining;
+            time_delta expiration_time;
 
-            explicit pulse_record(time_delta const &duration);
+            pulse_record(time_delta const &duration, time_delta const &expiration_time);
 
             pulse_record(deserialization_constructor_tag, binary_input_stream &bis);
 
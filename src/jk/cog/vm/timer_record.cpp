@@ -1,10 +1,11 @@
 #include "timer_record.hpp"
 
 gorc::cog::timer_record::timer_record(time_delta const &duration,
+                                      time_delta const &expiration_time,
                                       value param0,
                                       value param1)
     : duration(duration)
-    , remaining(duration)
+    , expiration_time(expiration_time)
     , param0(param0)
     , param1(param1)
 {
@@ -13,7 +14,7 @@ gorc::cog::timer_record::timer_record(time_delta const &duration,
 
 gorc::cog::timer_record::timer_record(deserialization_constructor_tag, binary_input_stream &bis)
     : duration(binary_deserialize<time_delta>(bis))
-    , remaining(binary_deserialize<time_delta>(bis))
+    , expiration_time(binary_deserialize<time_delta>(bis))
     , param0(binary_deserialize<value>(bis))
     , param1(binary_deserialize<value>(bis))
 {
@@ -23,7 +24,7 @@ gorc::cog::timer_record::timer_record(deserialization_constructor_tag, binary_in
 void gorc::cog::timer_record::binary_serialize_object(binary_output_stream &bos) const
 {
     binary_serialize(bos, duration);
-    binary_serialize(bos, remaining);
+    binary_serialize(bos, expiration_time);
     binary_serialize(bos, param0);
     binary_serialize(bos, param1);
 }
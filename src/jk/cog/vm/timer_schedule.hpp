@@ -0,0 +1,66 @@
+#pragma once
+
+#include "utility/maybe.hpp"
+#include "utility/time.hpp"
+#include <functional>
+#include <set>
+#include <tuple>
+
+namespace gorc {
+    namespace cog {
+
+        // Orders keyed records by absolute expiration time. Expired records are released in
+        // key order, as if an ordered container of records were scanned for expired entries.
+        template <typename KeyT, typename CompT = std::less<KeyT>>
+        class timer_schedule {
+        private:
+            class expiration_comp {
+            private:
+                CompT key_comp;
+
+            public:
+                bool operator()(std::tuple<time_delta, KeyT> const &left,
+                                std::tuple<time_delta, KeyT> const &right) const
+                {
+                    if(std::get<0>(left) != std::get<0>(right)) {
+                        return std::get<0>(left) < std::get<0>(right);
+                    }
+
+                    return key_comp(std::get<1>(left), std::get<1>(right));
+                }
+            };
+
+            std::set<std::tuple<time_delta, KeyT>, expiration_comp> pending;
+            std::set<KeyT, CompT> expired;
+
+        public:
+            void insert(time_delta expiration_time, KeyT const &key)
+            {
+                pending.emplace(expiration_time, key);
+            }
+
+            void erase(time_delta expiration_time, KeyT const &key)
+            {
+                pending.erase(std::make_tuple(expiration_time, key));
+                expired.erase(key);
+            }
+
+            // Returns the smallest key with an expiration time at or before current_time.
+            maybe<KeyT> pop_expired(time_delta current_time)
+            {
+                while(!pending.empty() && std::get<0>(*pending.begin()) <= current_time) {
+                    expired.insert(std::get<1>(*pending.begin()));
+                    pending.erase(pending.begin());
+                }
+
+                if(expired.empty()) {
+                    return nothing;
+                }
+
+                KeyT rv = *expired.begin();
+                expired.erase(expired.begin());
+                return rv;
+            }
+        };
+    }
+}
@@ -0,0 +1,56 @@
+#include "test/test.hpp"
+#include "jk/cog/vm/decoded_program.hpp"
+#include "io/binary_output_stream.hpp"
+
+using namespace gorc;
+using namespace gorc::cog;
+
+begin_suite(decoded_program_test);
+
+test_case(branch_targets_resolved)
+{
+    verb_table verbs;
+    script cog;
+
+    binary_output_stream bos(static_cast<memory_file::writer &>(cog.program));
+    binary_serialize(bos, opcode::push);
+    binary_serialize(bos, value(5));
+    binary_serialize(bos, opcode::bf);
+    size_t branch_target = cog.program.size() + sizeof(size_t) + sizeof(opcode);
+    binary_serialize(bos, branch_target);
+    binary_serialize(bos, opcode::ret);
+    binary_serialize(bos, opcode::jmp);
+    binary_serialize(bos, cog.program.size() + sizeof(size_t));
+
+    decoded_program prog(cog, verbs);
+
+    // Four instructions plus the sentinel return
+    assert_eq(prog.instructions.size(), size_t(5));
+    assert_true(prog.instructions[0].op == opcode::push);
+    assert_eq(static_cast<int>(prog.instructions[0].immediate), 5);
+    assert_eq(prog.instructions[1].address, size_t(3));
+    assert_eq(prog.instructions[3].address, size_t(4));
+    assert_true(prog.instructions[4].op == opcode::ret);
+
+    assert_eq(prog.get_index(branch_target), size_t(3));
+    assert_eq(prog.get_offset(3), branch_target);
+    assert_eq(prog.get_offset(4), cog.program.size());
+}
+
+test_case(invalid_offset)
+{
+    verb_table verbs;
+    script cog;
+
+    binary_output_stream bos(static_cast<memory_file::writer &>(cog.program));
+    binary_serialize(bos, opcode::push);
+    binary_serialize(bos, value(5));
+
+    decoded_program prog(cog, verbs);
+
+    assert_throws_logged(prog.get_index(1));
+    assert_log_message(log_level::error, "program offset 1 is not an instruction boundary");
+    assert_log_empty();
+}
+
+end_suite(decoded_program_test);
@@ -0,0 +1,60 @@
+#include "test/test.hpp"
+#include "jk/cog/vm/timer_schedule.hpp"
+
+using namespace gorc;
+using namespace gorc::cog;
+
+begin_suite(timer_schedule_test);
+
+test_case(expired_in_key_order)
+{
+    timer_schedule<int> ts;
+    ts.insert(0.75s, 1);
+    ts.insert(0.25s, 3);
+    ts.insert(0.5s, 2);
+    ts.insert(2.0s, 0);
+
+    assert_true(!ts.pop_expired(0.1s).has_value());
+
+    assert_eq(ts.pop_expired(1.0s).get_value(), 1);
+    assert_eq(ts.pop_expired(1.0s).get_value(), 2);
+    assert_eq(ts.pop_expired(1.0s).get_value(), 3);
+    assert_true(!ts.pop_expired(1.0s).has_value());
+
+    assert_eq(ts.pop_expired(2.0s).get_value(), 0);
+    assert_true(!ts.pop_expired(5.0s).has_value());
+}
+
+test_case(insert_while_draining)
+{
+    timer_schedule<int> ts;
+    ts.insert(0.5s, 2);
+    ts.insert(0.5s, 4);
+
+    assert_eq(ts.pop_expired(1.0s).get_value(), 2);
+
+    // Newly expired records are merged with records already found to be expired
+    ts.insert(1.0s, 3);
+    ts.insert(1.5s, 1);
+
+    assert_eq(ts.pop_expired(1.0s).get_value(), 3);
+    assert_eq(ts.pop_expired(1.0s).get_value(), 4);
+    assert_true(!ts.pop_expired(1.0s).has_value());
+}
+
+test_case(erase)
+{
+    timer_schedule<int> ts;
+    ts.insert(0.5s, 1);
+    ts.insert(0.5s, 2);
+    ts.insert(0.75s, 3);
+
+    assert_eq(ts.pop_expired(1.0s).get_value(), 1);
+
+    ts.erase(0.5s, 2);
+    ts.erase(0.75s, 3);
+
+    assert_true(!ts.pop_expired(1.0s).has_value());
+}
+
+end_suite(timer_schedule_test);
@@ -2,11 +2,114 @@
 #include "continuation.hpp"
 #include "executor.hpp"
 #include "instance.hpp"
-#include "io/binary_input_stream.hpp"
+#include "log/log.hpp"
 #include "opcode.hpp"
 #include "restart_exception.hpp"
 #include "suspend_exception.hpp"
 
+// Dispatch uses computed goto where the compiler supports it, so that every handler ends in
+// its own indirect branch. Other compilers fall back to a switch.
+#if defined(__GNUC__)
+#define VM_THREADED_DISPATCH 1
+#else
+#define VM_THREADED_DISPATCH 0
+#endif
+
+#define VM_COUNT_INSTRUCTION() if(Profiling) { prof->count_instruction(); }
+
+#if VM_THREADED_DISPATCH
+#define VM_DISPATCH() VM_COUNT_INSTRUCTION(); goto *dispatch_table[static_cast<uint8_t>(ip->op)]
+#define VM_OP(x) op_##x
+#define VM_BEGIN_DISPATCH() VM_DISPATCH();
+#define VM_END_DISPATCH()
+#else
+#define VM_DISPATCH() continue
+#define VM_OP(x) case opcode::x
+#define VM_BEGIN_DISPATCH() while(true) { VM_COUNT_INSTRUCTION(); switch(ip->op) { default: goto op_invalid;
+#define VM_END_DISPATCH() } }
+#endif
+
+#define VM_NEXT() ++ip; VM_DISPATCH()
+
+namespace {
+    // Reports the source location of the verb call in progress, if any. The location is only
+    // looked up when a verb writes a diagnostic.
+    class verb_call_location_provider : public gorc::diagnostic_location_provider {
+    public:
+        gorc::cog::decoded_program const *program = nullptr;
+        gorc::cog::instruction const *call = nullptr;
+
+        virtual gorc::maybe<gorc::diagnostic_context_location>
+            get_diagnostic_location() const override
+        {
+            if(!call) {
+                return gorc::nothing;
+            }
+
+            return program->get_call_location(
+                static_cast<size_t>(call - program->instructions.data()));
+        }
+    };
+
+    // Keeps a profiler frame open for the message handler on top of the call stack
+    class message_profile_scope {
+    private:
+        gorc::cog::profiler *prof;
+        bool active = false;
+
+    public:
+        explicit message_profile_scope(gorc::cog::profiler *prof)
+            : prof(prof)
+        {
+            return;
+        }
+
+        ~message_profile_scope()
+        {
+            leave();
+        }
+
+        void enter(gorc::cog::instance const &inst, gorc::cog::call_stack_frame const &frame)
+        {
+            if(prof) {
+                leave();
+                prof->enter_message(inst.cog->filename, frame.msg);
+                active = true;
+            }
+        }
+
+        void leave()
+        {
+            if(active) {
+                prof->leave();
+                active = false;
+            }
+        }
+    };
+}
+
+gorc::cog::decoded_program const& gorc::cog::virtual_machine::get_program(script const &cog,
+                                                                         verb_table const &verbs)
+{
+    auto it = programs.find(&cog);
+    if(it == programs.end()) {
+        it = programs.emplace(&cog, std::make_unique<decoded_program>(cog, verbs)).first;
+    }
+
+    return *it->second;
+}
+
+void gorc::cog::virtual_machine::set_profiler(profiler *p)
+{
+    prof = p;
+}
+
+gorc::cog::profiler *gorc::cog::virtual_machine::get_profiler() const
+{
+    return prof;
+}
+
+template <bool Profiling>
 gorc::cog::value gorc::cog::virtual_machine::internal_execute(heap &globals,
                                                               verb_table &verbs,
                                                               executor &exec,
@@ -23,337 +126,450 @@ gorc::cog::value gorc::cog::virtual_machine::internal_execute(heap &globals,
     services.add_or_replace(cc);
 
     instance *current_instance = &exec.get_instance(cc.frame().instance_id);
-    memory_file::reader sr(current_instance->cog->program);
-    sr.set_position(cc.frame().program_counter);
+    decoded_program const *program = &get_program(*current_instance->cog, verbs);
+    instruction const *ip =
+        &program->instructions[program->get_index(cc.frame().program_counter)];
+
+    verb_call_location_provider call_location;
+    deferred_diagnostic_context dc(call_location);
+
+    message_profile_scope mps(Profiling ? prof : nullptr);
+    mps.enter(*current_instance, cc.frame());
+
+#if VM_THREADED_DISPATCH
+    // Must match the declaration order of cog::opcode
+    static void *const dispatch_table[] = {
+        &&op_invalid,
+        &&op_push,
+        &&op_dup,
+        &&op_load,
+        &&op_loadi,
+        &&op_loadg,
+        &&op_loadgi,
+        &&op_stor,
+        &&op_stori,
+        &&op_storg,
+        &&op_storgi,
+        &&op_jmp,
+        &&op_jal,
+        &&op_bt,
+        &&op_bf,
+        &&op_call,
+        &&op_callv,
+        &&op_ret,
+        &&op_neg,
+        &&op_lnot,
+        &&op_add,
+        &&op_sub,
+        &&op_mul,
+        &&op_div,
+        &&op_mod,
+        &&op_bor,
+        &&op_band,
+        &&op_bxor,
+        &&op_lor,
+        &&op_land,
+        &&op_eq,
+        &&op_ne,
+        &&op_gt,
+        &&op_ge,
+        &&op_lt,
+        &&op_le,
+        &&op_incr,
+        &&op_decr,
+        &&op_incrg,
+        &&op_decrg,
+        &&op_bteq,
+        &&op_btne,
+        &&op_btgt,
+        &&op_btge,
+        &&op_btlt,
+        &&op_btle,
+        &&op_bfeq,
+        &&op_bfne,
+        &&op_bfgt,
+        &&op_bfge,
+        &&op_bflt,
+        &&op_bfle
+    };
+
+    static_assert(sizeof(dispatch_table) / sizeof(dispatch_table[0]) ==
+                      static_cast<size_t>(opcode::bfle) + 1,
+                  "dispatch table does not match opcode list");
+#endif
+
+    VM_BEGIN_DISPATCH()
+
+    VM_OP(push):
+        cc.data_stack.push_back(ip->immediate);
+        VM_NEXT();
+
+    VM_OP(dup): {
+        cog::value v(cc.data_stack.back());
+        cc.data_stack.push_back(v);
+    }
+    VM_NEXT();
 
-    binary_input_stream bsr(sr);
+    VM_OP(load):
+        cc.data_stack.push_back(current_instance->memory[ip->address]);
+        VM_NEXT();
 
-    while(true) {
-        opcode op = binary_deserialize<opcode>(bsr);
-        switch(op) {
-        case opcode::push: {
-            cog::value v(deserialization_constructor, bsr);
-            cc.data_stack.push_back(v);
-        } break;
-
-        case opcode::dup: {
-            cog::value v(cc.data_stack.back());
-            cc.data_stack.push_back(v);
-        } break;
-
-        case opcode::load: {
-            size_t addr = binary_deserialize<size_t>(bsr);
-            cc.data_stack.push_back(current_instance->memory[addr]);
-        } break;
-
-        case opcode::loadi: {
-            int addr = static_cast<int>(binary_deserialize<size_t>(bsr));
-            int idx = static_cast<int>(cc.data_stack.back());
-            cc.data_stack.pop_back();
-
-            cc.data_stack.push_back(current_instance->memory[static_cast<size_t>(addr + idx)]);
-        } break;
-
-        case opcode::loadg: {
-            size_t addr = binary_deserialize<size_t>(bsr);
-            cc.data_stack.push_back(globals[addr]);
-        } break;
-
-        case opcode::loadgi: {
-            int addr = static_cast<int>(binary_deserialize<size_t>(bsr));
-            int idx = static_cast<int>(cc.data_stack.back());
-            cc.data_stack.pop_back();
-
-            cc.data_stack.push_back(globals[static_cast<size_t>(addr + idx)]);
-        } break;
-
-        case opcode::stor: {
-            size_t addr = binary_deserialize<size_t>(bsr);
-            current_instance->memory[addr] = cc.data_stack.back();
-            cc.data_stack.pop_back();
-        } break;
-
-        case opcode::stori: {
-            int addr = static_cast<int>(binary_deserialize<size_t>(bsr));
-            int idx = static_cast<int>(cc.data_stack.back());
-            cc.data_stack.pop_back();
-
-            current_instance->memory[static_cast<size_t>(addr + idx)] = cc.data_stack.back();
-            cc.data_stack.pop_back();
-        } break;
-
-        case opcode::storg: {
-            size_t addr = binary_deserialize<size_t>(bsr);
-            globals[addr] = cc.data_stack.back();
-            cc.data_stack.pop_back();
-        } break;
-
-        case opcode::storgi: {
-            int addr = static_cast<int>(binary_deserialize<size_t>(bsr));
-            int idx = static_cast<int>(cc.data_stack.back());
-            cc.data_stack.pop_back();
-
-            globals[static_cast<size_t>(addr + idx)] = cc.data_stack.back();
-            cc.data_stack.pop_back();
-        } break;
-
-        case opcode::jmp: {
-            size_t addr = binary_deserialize<size_t>(bsr);
-            sr.set_position(addr);
-        } break;
-
-        case opcode::jal: {
-            size_t addr = binary_deserialize<size_t>(bsr);
-
-            // Store current offset in current continuation
-            cc.call_stack.back().program_counter = sr.position();
-
-            // Create new stack frame
-            cc.call_stack.push_back(call_stack_frame(cc.frame().instance_id,
-                                                     addr,
-                                                     cc.frame().sender,
-                                                     cc.frame().sender_id,
-                                                     cc.frame().source,
-                                                     cc.frame().param0,
-                                                     cc.frame().param1,
-                                                     cc.frame().param2,
-                                                     cc.frame().param3));
-
-            // Jump
-            sr.set_position(addr);
-        } break;
-
-        case opcode::bt: {
-            size_t addr = binary_deserialize<size_t>(bsr);
-            cog::value v(cc.data_stack.back());
-            cc.data_stack.pop_back();
-
-            if(static_cast<bool>(v)) {
-                sr.set_position(addr);
-            }
-        } break;
+    VM_OP(loadi): {
+        int addr = static_cast<int>(ip->address);
+        int idx = static_cast<int>(cc.data_stack.back());
+        cc.data_stack.back() = current_instance->memory[static_cast<size_t>(addr + idx)];
+    }
+    VM_NEXT();
 
-        case opcode::bf: {
-            size_t addr = binary_deserialize<size_t>(bsr);
-            cog::value v(cc.data_stack.back());
-            cc.data_stack.pop_back();
+    VM_OP(loadg):
+        cc.data_stack.push_back(globals[ip->address]);
+        VM_NEXT();
 
-            if(!static_cast<bool>(v)) {
-                sr.set_position(addr);
-            }
-        } break;
-
-        case opcode::call: {
-            int vid = binary_deserialize<int>(bsr);
-
-            int first_line = binary_deserialize<int>(bsr);
-            int first_col = binary_deserialize<int>(bsr);
-            int last_line = binary_deserialize<int>(bsr);
-            int last_col = binary_deserialize<int>(bsr);
-            diagnostic_context dc(current_instance->cog->filename.c_str(),
-                                  first_line,
-                                  first_col,
-                                  last_line,
-                                  last_col);
-
-            // Store current offset in current continuation
-            cc.call_stack.back().program_counter = sr.position();
-
-            verbs.get_verb(verb_id(vid))
-                .invoke(cc.data_stack,
-                        services,
-                        /* expects value */ false);
-        } break;
-
-        case opcode::callv: {
-            int vid = binary_deserialize<int>(bsr);
-
-            int first_line = binary_deserialize<int>(bsr);
-            int first_col = binary_deserialize<int>(bsr);
-            int last_line = binary_deserialize<int>(bsr);
-            int last_col = binary_deserialize<int>(bsr);
-            diagnostic_context dc(current_instance->cog->filename.c_str(),
-                                  first_line,
-                                  first_col,
-                                  last_line,
-                                  last_col);
-
-            // Store current offset in current continuation
-            cc.call_stack.back().program_counter = sr.position();
-
-            cog::value rv = verbs.get_verb(verb_id(vid))
-                                .invoke(cc.data_stack,
-                                        services,
-                                        /* expects value */ true);
-            cc.data_stack.push_back(rv);
-        } break;
-
-        case opcode::ret: {
-            // Retire top stack frame.
-            value return_register = cc.frame().return_register;
-            bool save_return_register = cc.frame().save_return_register;
-            bool push_return_register = cc.frame().push_return_register;
-
-            cc.call_stack.pop_back();
-
-            if(cc.call_stack.empty()) {
-                return return_register;
-            }
+    VM_OP(loadgi): {
+        int addr = static_cast<int>(ip->address);
+        int idx = static_cast<int>(cc.data_stack.back());
+        cc.data_stack.back() = globals[static_cast<size_t>(addr + idx)];
+    }
+    VM_NEXT();
 
-            current_instance = &exec.get_instance(cc.call_stack.back().instance_id);
-            sr = memory_file::reader(current_instance->cog->program);
-            sr.set_position(cc.call_stack.back().program_counter);
+    VM_OP(stor):
+        current_instance->memory[ip->address] = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        VM_NEXT();
 
-            if(save_return_register) {
-                cc.frame().return_register = return_register;
-            }
+    VM_OP(stori): {
+        int addr = static_cast<int>(ip->address);
+        int idx = static_cast<int>(cc.data_stack.back());
+        cc.data_stack.pop_back();
 
-            if(push_return_register) {
-                cc.data_stack.push_back(return_register);
-            }
-        } break;
-
-        case opcode::neg: {
-            cog::value v = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(-v);
-        } break;
-
-        case opcode::lnot: {
-            cog::value v = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(!v);
-        } break;
-
-        case opcode::add: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x + y);
-        } break;
-
-        case opcode::sub: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x - y);
-        } break;
-
-        case opcode::mul: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x * y);
-        } break;
-
-        case opcode::div: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x / y);
-        } break;
-
-        case opcode::mod: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x % y);
-        } break;
-
-        case opcode::bor: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x | y);
-        } break;
-
-        case opcode::band: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x & y);
-        } break;
-
-        case opcode::bxor: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x ^ y);
-        } break;
-
-        case opcode::lor: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x || y);
-        } break;
-
-        case opcode::land: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x && y);
-        } break;
-
-        case opcode::eq: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x == y);
-        } break;
-
-        case opcode::ne: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x != y);
-        } break;
-
-        case opcode::gt: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x > y);
-        } break;
-
-        case opcode::ge: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x >= y);
-        } break;
-
-        case opcode::lt: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x < y);
-        } break;
-
-        case opcode::le: {
-            cog::value y = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cog::value x = cc.data_stack.back();
-            cc.data_stack.pop_back();
-            cc.data_stack.push_back(x <= y);
-        } break;
+        current_instance->memory[static_cast<size_t>(addr + idx)] = cc.data_stack.back();
+        cc.data_stack.pop_back();
+    }
+    VM_NEXT();
+
+    VM_OP(storg):
+        globals[ip->address] = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        VM_NEXT();
+
+    VM_OP(storgi): {
+        int addr = static_cast<int>(ip->address);
+        int idx = static_cast<int>(cc.data_stack.back());
+        cc.data_stack.pop_back();
+
+        globals[static_cast<size_t>(addr + idx)] = cc.data_stack.back();
+        cc.data_stack.pop_back();
+    }
+    VM_NEXT();
+
+    VM_OP(jmp):
+        ip = &program->instructions[ip->address];
+        VM_DISPATCH();
+
+    VM_OP(jal):
+        // Store current offset in current continuation
+        cc.call_stack.back().program_counter = ip->next_offset;
+
+        // Create new stack frame
+        cc.call_stack.push_back(call_stack_frame(cc.frame().instance_id,
+                                                 cc.frame().msg,
+                                                 program->get_offset(ip->address),
+                                                 cc.frame().sender,
+                                                 cc.frame().sender_id,
+                                                 cc.frame().source,
+                                                 cc.frame().param0,
+                                                 cc.frame().param1,
+                                                 cc.frame().param2,
+                                                 cc.frame().param3));
+
+        // Jump
+        ip = &program->instructions[ip->address];
+        VM_DISPATCH();
+
+    VM_OP(bt): {
+        bool v = static_cast<bool>(cc.data_stack.back());
+        cc.data_stack.pop_back();
+
+        if(v) {
+            ip = &program->instructions[ip->address];
+            VM_DISPATCH();
         }
     }
+    VM_NEXT();
+
+    VM_OP(bf): {
+        bool v = static_cast<bool>(cc.data_stack.back());
+        cc.data_stack.pop_back();
+
+        if(!v) {
+            ip = &program->instructions[ip->address];
+            VM_DISPATCH();
+        }
+    }
+    VM_NEXT();
+
+    VM_OP(call): {
+        call_location.program = program;
+        call_location.call = ip;
+
+        // Store current offset in current continuation
+        cc.call_stack.back().program_counter = ip->next_offset;
+
+        verb_profile_scope ps(Profiling ? prof : nullptr, *ip->target_verb);
+        ip->target_verb->invoke(cc.data_stack,
+                                services,
+                                /* expects value */ false);
+        call_location.call = nullptr;
+    }
+    VM_NEXT();
+
+    VM_OP(callv): {
+        call_location.program = program;
+        call_location.call = ip;
+
+        // Store current offset in current continuation
+        cc.call_stack.back().program_counter = ip->next_offset;
+
+        verb_profile_scope ps(Profiling ? prof : nullptr, *ip->target_verb);
+        cog::value rv = ip->target_verb->invoke(cc.data_stack,
+                                                services,
+                                                /* expects value */ true);
+        call_location.call = nullptr;
+        cc.data_stack.push_back(rv);
+    }
+    VM_NEXT();
+
+    VM_OP(ret): {
+        // Retire top stack frame.
+        value return_register = cc.frame().return_register;
+        bool save_return_register = cc.frame().save_return_register;
+        bool push_return_register = cc.frame().push_return_register;
+        cog_id returning_instance = cc.frame().instance_id;
+        message_type returning_msg = cc.frame().msg;
+
+        cc.call_stack.pop_back();
+
+        if(cc.call_stack.empty()) {
+            return return_register;
+        }
+
+        current_instance = &exec.get_instance(cc.call_stack.back().instance_id);
+        program = &get_program(*current_instance->cog, verbs);
+        ip = &program->instructions[program->get_index(cc.call_stack.back().program_counter)];
+
+        if(Profiling &&
+           (cc.frame().instance_id != returning_instance || cc.frame().msg != returning_msg)) {
+            mps.enter(*current_instance, cc.frame());
+        }
+
+        if(save_return_register) {
+            cc.frame().return_register = return_register;
+        }
+
+        if(push_return_register) {
+            cc.data_stack.push_back(return_register);
+        }
+    }
+    VM_DISPATCH();
+
+    VM_OP(neg): {
+        cog::value &v = cc.data_stack.back();
+        v = -v;
+    }
+    VM_NEXT();
+
+    VM_OP(lnot): {
+        cog::value &v = cc.data_stack.back();
+        v = !v;
+    }
+    VM_NEXT();
+
+    VM_OP(add): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x + y;
+    }
+    VM_NEXT();
+
+    VM_OP(sub): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x - y;
+    }
+    VM_NEXT();
+
+    VM_OP(mul): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x * y;
+    }
+    VM_NEXT();
+
+    VM_OP(div): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x / y;
+    }
+    VM_NEXT();
+
+    VM_OP(mod): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x % y;
+    }
+    VM_NEXT();
+
+    VM_OP(bor): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x | y;
+    }
+    VM_NEXT();
+
+    VM_OP(band): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x & y;
+    }
+    VM_NEXT();
+
+    VM_OP(bxor): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x ^ y;
+    }
+    VM_NEXT();
+
+    VM_OP(lor): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x || y;
+    }
+    VM_NEXT();
+
+    VM_OP(land): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x && y;
+    }
+    VM_NEXT();
+
+    VM_OP(eq): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x == y;
+    }
+    VM_NEXT();
+
+    VM_OP(ne): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x != y;
+    }
+    VM_NEXT();
+
+    VM_OP(gt): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x > y;
+    }
+    VM_NEXT();
+
+    VM_OP(ge): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x >= y;
+    }
+    VM_NEXT();
+
+    VM_OP(lt): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x < y;
+    }
+    VM_NEXT();
+
+    VM_OP(le): {
+        cog::value y = cc.data_stack.back();
+        cc.data_stack.pop_back();
+        cog::value &x = cc.data_stack.back();
+        x = x <= y;
+    }
+    VM_NEXT();
+
+    VM_OP(incr): {
+        cog::value &x = current_instance->memory[ip->address];
+        x = x + ip->immediate;
+    }
+    VM_NEXT();
+
+    VM_OP(decr): {
+        cog::value &x = current_instance->memory[ip->address];
+        x = x - ip->immediate;
+    }
+    VM_NEXT();
+
+    VM_OP(incrg): {
+        cog::value &x = globals[ip->address];
+        x = x + ip->immediate;
+    }
+    VM_NEXT();
+
+    VM_OP(decrg): {
+        cog::value &x = globals[ip->address];
+        x = x - ip->immediate;
+    }
+    VM_NEXT();
+
+// Fused comparison and conditional branch. Pops both operands, then branches if the result
+// of the comparison matches the expected truth value.
+#define VM_COMPARE_BRANCH(name, cmp, expected) \
+    VM_OP(name): { \
+        cog::value y = cc.data_stack.back(); \
+        cc.data_stack.pop_back(); \
+        cog::value x = cc.data_stack.back(); \
+        cc.data_stack.pop_back(); \
+        if(static_cast<bool>(x cmp y) == expected) { \
+            ip = &program->instructions[ip->address]; \
+            VM_DISPATCH(); \
+        } \
+    } \
+    VM_NEXT();
+
+    VM_COMPARE_BRANCH(bteq, ==, true)
+    VM_COMPARE_BRANCH(btne, !=, true)
+    VM_COMPARE_BRANCH(btgt, >, true)
+    VM_COMPARE_BRANCH(btge, >=, true)
+    VM_COMPARE_BRANCH(btlt, <, true)
+    VM_COMPARE_BRANCH(btle, <=, true)
+    VM_COMPARE_BRANCH(bfeq, ==, false)
+    VM_COMPARE_BRANCH(bfne, !=, false)
+    VM_COMPARE_BRANCH(bfgt, >, false)
+    VM_COMPARE_BRANCH(bfge, >=, false)
+    VM_COMPARE_BRANCH(bflt, <, false)
+    VM_COMPARE_BRANCH(bfle, <=, false)
+
+#undef VM_COMPARE_BRANCH
+
+    VM_END_DISPATCH()
+
+op_invalid:
+    LOG_FATAL(format("invalid opcode %d") % static_cast<int>(ip->op));
 }
 
 gorc::cog::value gorc::cog::virtual_machine::execute(heap &globals,
@@ -364,7 +580,11 @@ gorc::cog::value gorc::cog::virtual_machine::execute(heap &globals,
 {
     while(true) {
         try {
-            return internal_execute(globals, verbs, exec, services, cc);
+            if(prof) {
+                return internal_execute<true>(globals, verbs, exec, services, cc);
+            }
+
+            return internal_execute<false>(globals, verbs, exec, services, cc);
         }
         catch(restart_exception const &) {
             // Some engine component has changed the current continuation and
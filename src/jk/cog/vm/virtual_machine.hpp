@@ -1,8 +1,12 @@
 #pragma once
 
 #include "continuation.hpp"
+#include "decoded_program.hpp"
 #include "heap.hpp"
+#include "profiler.hpp"
 #include "jk/cog/script/verb_table.hpp"
+#include <memory>
+#include <unordered_map>
 
 namespace gorc {
     namespace cog {
@@ -11,6 +15,12 @@ namespace gorc {
 
         class virtual_machine {
         private:
+            std::unordered_map<script const *, std::unique_ptr<decoded_program>> programs;
+            profiler *prof = nullptr;
+
+            // Instantiated with and without profiling, so that an idle profiler costs nothing
+            // in the dispatch loop.
+            template <bool Profiling>
             value internal_execute(heap &globals,
                                    verb_table &,
                                    executor &,
@@ -18,6 +28,11 @@ namespace gorc {
                                    continuation &cc);
 
         public:
+            decoded_program const& get_program(script const &, verb_table const &);
+
+            void set_profiler(profiler *);
+            profiler *get_profiler() const;
+
             value execute(heap &globals,
                           verb_table &,
                           executor &,
@@ -1,8 +1,12 @@
 #include "content_manager.hpp"
 #include "loader_registry.hpp"
 #include "log/log.hpp"
+#include "io/memory_file.hpp"
 #include "vfs/virtual_file_system.hpp"
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
 
 namespace {
 
@@ -36,6 +40,12 @@ void gorc::content_manager::asset_data::binary_serialize_object(binary_output_st
     binary_serialize(bos, name);
 }
 
+gorc::content_manager::preloaded_asset::preloaded_asset(fourcc type)
+    : type(type)
+{
+    return;
+}
+
 gorc::asset_id gorc::content_manager::load_internal(fourcc type, std::string const &name)
 {
     std::string real_name = canonical_content_name(name);
@@ -58,6 +68,15 @@ void gorc::content_manager::finalize_internal(asset_id id)
     // will invalidate this reference.
     auto const &unsafe_ref = at_id(assets, id);
     if(!unsafe_ref.content) {
+        auto preloaded_it = preloaded_assets.find(unsafe_ref.name);
+        if(preloaded_it != preloaded_assets.end() &&
+           preloaded_it->second.type == unsafe_ref.type) {
+            preloaded_it->second.log.flush();
+            at_id(assets, id).content = std::move(preloaded_it->second.content);
+            preloaded_assets.erase(preloaded_it);
+            return;
+        }
+
         std::string safe_name = unsafe_ref.name;
         diagnostic_context dc(safe_name.c_str());
         auto const &loader = services.get<loader_registry>().get_loader(unsafe_ref.type);
@@ -87,6 +106,91 @@ void gorc::content_manager::finalize_internal(asset_id id)
     }
 }
 
+void gorc::content_manager::preload_internal(fourcc type, std::vector<std::string> const &names)
+{
+    auto const &loader = services.get<loader_registry>().get_loader(type);
+    if(!loader.is_thread_safe()) {
+        return;
+    }
+
+    // Read files on this thread. The virtual file system is not thread safe.
+    std::vector<std::tuple<std::string, std::unique_ptr<memory_file>>> jobs;
+    std::unordered_set<std::string> queued_names;
+    for(auto const &name : names) {
+        std::string real_name = canonical_content_name(name);
+        if(asset_map.find(real_name) != asset_map.end() ||
+           preloaded_assets.find(real_name) != preloaded_assets.end() ||
+           !queued_names.insert(real_name).second) {
+            continue;
+        }
+
+        // Missing files are reported when the asset is loaded
+        log_buffer discarded_log;
+        scoped_log_buffer slb(discarded_log);
+
+        try {
+            auto file = services.get<virtual_file_system>().find(real_name, loader.get_prefixes());
+            auto contents = std::make_unique<memory_file>();
+            std::get<1>(file)->copy_to(*contents);
+            jobs.emplace_back(real_name, std::move(contents));
+        }
+        catch(...) {
+            continue;
+        }
+    }
+
+    std::vector<preloaded_asset> results;
+    results.reserve(jobs.size());
+    for(size_t i = 0; i < jobs.size(); ++i) {
+        results.emplace_back(type);
+    }
+
+    std::atomic<size_t> next_job(0);
+
+    auto worker_thread = [&]() {
+        while(true) {
+            size_t i = next_job++;
+            if(i >= jobs.size()) {
+                return;
+            }
+
+            auto const &name = std::get<0>(jobs[i]);
+            auto &result = results[i];
+
+            scoped_log_buffer slb(result.log);
+
+            try {
+                diagnostic_context dc(name.c_str());
+                memory_file::reader contents(*std::get<1>(jobs[i]));
+                result.content = loader.deserialize(contents, *this, invalid_id, services, name);
+            }
+            catch(...) {
+                // Failed assets are loaded again on first use, which reports the error.
+                result.content.reset();
+            }
+        }
+    };
+
+    size_t num_threads = std::min(jobs.size(),
+                                  std::max(size_t(1),
+                                           size_t(std::thread::hardware_concurrency())));
+
+    std::vector<std::thread> thread_pool;
+    for(size_t i = 0; i < num_threads; ++i) {
+        thread_pool.emplace_back(worker_thread);
+    }
+
+    for(auto &thread : thread_pool) {
+        thread.join();
+    }
+
+    for(size_t i = 0; i < jobs.size(); ++i) {
+        if(results[i].content) {
+            preloaded_assets.emplace(std::get<0>(jobs[i]), std::move(results[i]));
+        }
+    }
+}
+
 gorc::asset const &gorc::content_manager::load_from_id(asset_id id)
 {
     finalize_internal(id);
@@ -6,6 +6,7 @@
 #include "io/binary_input_stream.hpp"
 #include "io/binary_output_stream.hpp"
 #include "log/diagnostic_context.hpp"
+#include "log/log_buffer.hpp"
 #include "utility/maybe.hpp"
 #include "utility/service_registry.hpp"
 #include <memory>
@@ -29,12 +30,23 @@ namespace gorc {
             void binary_serialize_object(binary_output_stream &) const;
         };
 
+        class preloaded_asset {
+        public:
+            fourcc type;
+            std::unique_ptr<asset> content;
+            log_buffer log;
+
+            explicit preloaded_asset(fourcc type);
+        };
+
         service_registry const &services;
         std::vector<asset_data> assets;
         std::unordered_map<std::string, asset_id> asset_map;
+        std::unordered_map<std::string, preloaded_asset> preloaded_assets;
 
         asset_id load_internal(fourcc type, std::string const &name);
         void finalize_internal(asset_id id);
+        void preload_internal(fourcc type, std::vector<std::string> const &names);
 
     public:
         explicit content_manager(service_registry const &services);
@@ -53,6 +65,15 @@ namespace gorc {
 
         asset const &load_from_id(asset_id id);
 
+        // Loads assets on worker threads, if their loader is thread safe. Each asset is
+        // published (and its diagnostics reported) when it is first loaded, so asset ids and
+        // log output do not depend on thread scheduling.
+        template <typename T>
+        void preload(std::vector<std::string> const &names)
+        {
+            preload_internal(T::type, names);
+        }
+
         template <typename T>
         asset_id load_id(std::string const &name)
         {
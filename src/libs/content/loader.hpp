@@ -22,5 +22,8 @@ namespace gorc {
 
         virtual std::vector<path> const &get_prefixes() const = 0;
         virtual maybe<char const *> get_default() const;
+
+        // Loaders that do not use the content manager or asset id may be run on worker threads.
+        virtual bool is_thread_safe() const;
     };
 }
@@ -101,6 +101,39 @@ namespace {
         }
     };
 
+    class mock_thread_safe_asset : public mock_asset {
+    public:
+        static fourcc const type;
+
+        using mock_asset::mock_asset;
+    };
+
+    fourcc const mock_thread_safe_asset::type = "TSMK"_4CC;
+
+    class mock_thread_safe_loader : public mock_loader {
+    public:
+        static fourcc const type;
+
+        virtual bool is_thread_safe() const override
+        {
+            return true;
+        }
+
+        virtual std::unique_ptr<asset> deserialize(input_stream &is,
+                                                   content_manager &,
+                                                   asset_id,
+                                                   service_registry const &,
+                                                   std::string const &name) const override
+        {
+            LOG_INFO(format("called mock_thread_safe_loader for %s") % name);
+            int value;
+            is.read(&value, sizeof(int));
+            return std::make_unique<mock_thread_safe_asset>(value);
+        }
+    };
+
+    fourcc const mock_thread_safe_loader::type = "TSMK"_4CC;
+
     MAKE_ID_TYPE(mock_asset);
 
     fourcc const mock_loader::type = "MOCK"_4CC;
@@ -123,6 +156,7 @@ public:
     content_manager_test_fixture()
     {
         loaders.emplace_loader<mock_loader>();
+        loaders.emplace_loader<mock_thread_safe_loader>();
         services.add(loaders);
         services.add<virtual_file_system>(vfs);
     }
@@ -242,4 +276,42 @@ test_case(get_asset)
     assert_eq(foo_ref, foo_ref2);
 }
 
+test_case(preload_publishes_on_load)
+{
+    content_manager content(services);
+
+    content.preload<mock_thread_safe_asset>({"foo", "bar", "dne", "FOO"});
+    assert_log_empty();
+
+    auto bar_ref = content.load<mock_thread_safe_asset>("bar");
+    assert_log_message(log_level::info, "bar: called mock_thread_safe_loader for bar");
+    assert_log_empty();
+    assert_eq(bar_ref->value, 10);
+    assert_eq(static_cast<int>(bar_ref.get_id()), 0);
+
+    auto foo_ref = content.load<mock_thread_safe_asset>("Foo");
+    assert_log_message(log_level::info, "foo: called mock_thread_safe_loader for foo");
+    assert_log_empty();
+    assert_eq(foo_ref->value, 5);
+    assert_eq(static_cast<int>(foo_ref.get_id()), 1);
+
+    auto dne_ref = content.load<mock_thread_safe_asset>("dne");
+    assert_log_message(log_level::error, "dne: failed to load asset dne, using default instead");
+    assert_log_message(log_level::info, "dflt: called mock_thread_safe_loader for dne");
+    assert_log_empty();
+    assert_eq(dne_ref->value, 23);
+}
+
+test_case(preload_ignores_unsafe_loaders)
+{
+    content_manager content(services);
+
+    content.preload<mock_asset>({"foo"});
+    assert_log_empty();
+
+    content.load<mock_asset>("foo");
+    assert_log_message(log_level::info, "foo: called mock_loader for asset 0");
+    assert_log_empty();
+}
+
 end_suite(content_manager_test);
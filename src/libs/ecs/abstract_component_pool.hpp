@@ -1,19 +1,89 @@
 #pragma once
 
+#include "component_pool_snapshot.hpp"
 #include "content/id.hpp"
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 namespace gorc {
 
+    template <typename IdT>
+    class component_pool_observer {
+    public:
+        virtual ~component_pool_observer()
+        {
+            return;
+        }
+
+        // Called when a component owned by the entity is emplaced, erased or moved
+        virtual void components_changed(IdT entity) = 0;
+
+        // Called when every component in the pool may have moved
+        virtual void components_moved() = 0;
+
+        // Called when every component in the pool has been replaced
+        virtual void components_replaced()
+        {
+            components_moved();
+        }
+    };
+
     template <typename IdT>
     class abstract_component_pool {
+    private:
+        std::vector<component_pool_observer<IdT>*> observers;
+
+    protected:
+        void notify_components_changed(IdT entity)
+        {
+            for(auto *observer : observers) {
+                observer->components_changed(entity);
+            }
+        }
+
+        void notify_components_moved()
+        {
+            for(auto *observer : observers) {
+                observer->components_moved();
+            }
+        }
+
+        void notify_components_replaced()
+        {
+            for(auto *observer : observers) {
+                observer->components_replaced();
+            }
+        }
+
     public:
         virtual ~abstract_component_pool()
         {
             return;
         }
 
+        void add_observer(component_pool_observer<IdT> *observer)
+        {
+            observers.push_back(observer);
+        }
+
+        void remove_observer(component_pool_observer<IdT> *observer)
+        {
+            auto it = std::find(observers.begin(), observers.end(), observer);
+            if(it != observers.end()) {
+                observers.erase(it);
+            }
+        }
+
         virtual void erase_equal_range(IdT entity) = 0;
         virtual void flush_erase_queue() = 0;
+
+        // Captures every component in the pool. Queued erasures are not captured.
+        virtual std::unique_ptr<component_pool_snapshot> take_snapshot() const = 0;
+
+        // Replaces the pool's components with those captured by a snapshot of this pool
+        // type, discarding queued erasures
+        virtual void restore_snapshot(component_pool_snapshot const &snapshot) = 0;
     };
 
 }
@@ -1,6 +1,32 @@
 #include "aspect.hpp"
+#include <algorithm>
+
+namespace {
+    bool intersects(std::vector<uint32_t> const &a, std::vector<uint32_t> const &b)
+    {
+        return std::any_of(a.begin(), a.end(), [&b](uint32_t uid) {
+                return std::find(b.begin(), b.end(), uid) != b.end();
+            });
+    }
+}
 
 gorc::aspect::~aspect()
 {
     return;
 }
+
+bool gorc::aspect::has_declared_access() const
+{
+    return declared_access;
+}
+
+bool gorc::aspect::conflicts_with(aspect const &other) const
+{
+    if(!declared_access || !other.declared_access) {
+        return true;
+    }
+
+    return intersects(write_components, other.write_components) ||
+           intersects(write_components, other.read_components) ||
+           intersects(read_components, other.write_components);
+}
@@ -1,13 +1,45 @@
 #pragma once
 
 #include "utility/time.hpp"
+#include "utility/uid.hpp"
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
 
 namespace gorc {
 
     class aspect {
+    private:
+        bool declared_access = false;
+        std::vector<uint32_t> read_components;
+        std::vector<uint32_t> write_components;
+
+    protected:
+        // Aspects declaring the component types they access may run concurrently with other
+        // aspects. Aspects without declarations run alone. Join views are not synchronized,
+        // so aspects which declare access must not iterate them.
+        template <typename ...CompT>
+        void declare_reads()
+        {
+            declared_access = true;
+            std::initializer_list<uint32_t> uids { uid_of<CompT>()... };
+            read_components.insert(read_components.end(), uids);
+        }
+
+        template <typename ...CompT>
+        void declare_writes()
+        {
+            declared_access = true;
+            std::initializer_list<uint32_t> uids { uid_of<CompT>()... };
+            write_components.insert(write_components.end(), uids);
+        }
+
     public:
         virtual ~aspect();
         virtual void update(time_delta) = 0;
+
+        bool has_declared_access() const;
+        bool conflicts_with(aspect const &other) const;
     };
 
 }
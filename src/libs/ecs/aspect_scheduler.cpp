@@ -0,0 +1,149 @@
+#include "aspect_scheduler.hpp"
+
+gorc::aspect_scheduler::task::task(aspect *target)
+    : target(target)
+{
+    return;
+}
+
+gorc::aspect_scheduler::stage::stage(bool exclusive)
+    : exclusive(exclusive)
+{
+    return;
+}
+
+gorc::aspect_scheduler::aspect_scheduler(size_t worker_count)
+    : workers(worker_count)
+{
+    return;
+}
+
+void gorc::aspect_scheduler::set_worker_count(size_t count)
+{
+    workers.set_worker_count(count);
+}
+
+void gorc::aspect_scheduler::plan(std::vector<std::unique_ptr<aspect>> const &aspects)
+{
+    stages.clear();
+
+    for(auto const &asp : aspects) {
+        bool exclusive = !asp->has_declared_access();
+        if(exclusive || stages.empty() || stages.back().exclusive) {
+            stages.emplace_back(exclusive);
+        }
+
+        auto &tasks = stages.back().tasks;
+        size_t index = tasks.size();
+        tasks.emplace_back(asp.get());
+
+        for(size_t i = 0; i < index; ++i) {
+            if(tasks[i].target->conflicts_with(*asp)) {
+                tasks[i].dependents.push_back(index);
+                ++tasks[index].dependency_count;
+            }
+        }
+    }
+
+    planned_aspect_count = aspects.size();
+}
+
+void gorc::aspect_scheduler::run_ready_tasks()
+{
+    std::unique_lock<std::mutex> lk(stage_lock);
+    while(unfinished_tasks > 0 && !stage_failed) {
+        if(ready_tasks.empty()) {
+            stage_changed.wait(lk);
+            continue;
+        }
+
+        size_t index = ready_tasks.front();
+        ready_tasks.pop_front();
+
+        task &t = current_stage->tasks[index];
+        time_delta dt = current_dt;
+
+        lk.unlock();
+
+        try {
+            deferred_event_scope des(t.events);
+            t.target->update(dt);
+        }
+        catch(...) {
+            // The worker pool rethrows the exception once every thread has stopped.
+            lk.lock();
+            stage_failed = true;
+            stage_changed.notify_all();
+            throw;
+        }
+
+        lk.lock();
+
+        for(size_t dependent : t.dependents) {
+            if(--pending_dependencies[dependent] == 0) {
+                ready_tasks.push_back(dependent);
+            }
+        }
+
+        --unfinished_tasks;
+        stage_changed.notify_all();
+    }
+}
+
+void gorc::aspect_scheduler::run_stage(stage &s, time_delta dt)
+{
+    {
+        std::lock_guard<std::mutex> lk(stage_lock);
+
+        current_stage = &s;
+        current_dt = dt;
+        stage_failed = false;
+
+        pending_dependencies.clear();
+        ready_tasks.clear();
+        for(size_t i = 0; i < s.tasks.size(); ++i) {
+            pending_dependencies.push_back(s.tasks[i].dependency_count);
+            if(s.tasks[i].dependency_count == 0) {
+                ready_tasks.push_back(i);
+            }
+        }
+
+        unfinished_tasks = s.tasks.size();
+    }
+
+    // Every thread takes ready tasks until the stage is complete
+    try {
+        workers.run(workers.thread_count(), [this](size_t, size_t) { run_ready_tasks(); });
+    }
+    catch(...) {
+        current_stage = nullptr;
+        for(auto &t : s.tasks) {
+            t.events.clear();
+        }
+
+        throw;
+    }
+
+    current_stage = nullptr;
+
+    for(auto &t : s.tasks) {
+        dispatch_deferred_events(t.events);
+    }
+}
+
+void gorc::aspect_scheduler::update(std::vector<std::unique_ptr<aspect>> const &aspects,
+                                    time_delta dt)
+{
+    if(aspects.size() != planned_aspect_count) {
+        plan(aspects);
+    }
+
+    for(auto &s : stages) {
+        if(s.exclusive) {
+            s.tasks.front().target->update(dt);
+        }
+        else {
+            run_stage(s, dt);
+        }
+    }
+}
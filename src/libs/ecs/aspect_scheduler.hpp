@@ -0,0 +1,74 @@
+#pragma once
+
+#include "aspect.hpp"
+#include "utility/event_bus.hpp"
+#include "utility/time.hpp"
+#include "utility/worker_pool.hpp"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gorc {
+
+    // Updates aspects in declaration order, running aspects with non-conflicting component
+    // access concurrently. Aspects without declared access run alone on the calling thread.
+    //
+    // Consecutive aspects with declared access form a stage. Within a stage, an aspect
+    // depends on every earlier aspect it conflicts with. Events fired by aspects in a stage
+    // are queued per aspect and dispatched in declaration order when the stage completes, so
+    // the result does not depend on the number of worker threads.
+    class aspect_scheduler {
+    private:
+        class task {
+        public:
+            aspect *target;
+            std::vector<size_t> dependents;
+            size_t dependency_count = 0;
+            deferred_event_queue events;
+
+            explicit task(aspect *target);
+        };
+
+        class stage {
+        public:
+            bool exclusive;
+            std::vector<task> tasks;
+
+            explicit stage(bool exclusive);
+        };
+
+        std::vector<stage> stages;
+        size_t planned_aspect_count = 0;
+
+        worker_pool workers;
+
+        // State of the running stage
+        std::mutex stage_lock;
+        std::condition_variable stage_changed;
+        stage *current_stage = nullptr;
+        time_delta current_dt;
+        std::vector<size_t> pending_dependencies;
+        std::deque<size_t> ready_tasks;
+        size_t unfinished_tasks = 0;
+        bool stage_failed = false;
+
+        void plan(std::vector<std::unique_ptr<aspect>> const &aspects);
+
+        void run_ready_tasks();
+        void run_stage(stage &s, time_delta dt);
+
+    public:
+        explicit aspect_scheduler(size_t worker_count = 0);
+
+        aspect_scheduler(aspect_scheduler const &) = delete;
+        aspect_scheduler& operator=(aspect_scheduler const &) = delete;
+
+        // The calling thread also runs tasks. Zero workers runs every aspect serially.
+        void set_worker_count(size_t count);
+
+        void update(std::vector<std::unique_ptr<aspect>> const &aspects, time_delta dt);
+    };
+
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "abstract_component_pool.hpp"
+#include "component_storage.hpp"
+#include "generational_entity_generator.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace gorc {
+
+    // Component types declaring
+    //     using component_changes = tracked_component_changes;
+    // record the version at which each entity's components last changed. Emplacing and
+    // erasing a component records a change. Writes through component references must be
+    // recorded by the writer.
+    class untracked_component_changes { };
+    class tracked_component_changes { };
+
+    template <typename CompT, typename = void>
+    struct component_changes_of {
+        using type = untracked_component_changes;
+    };
+
+    template <typename CompT>
+    struct component_changes_of<CompT,
+                                typename detail::void_if_valid<
+                                    typename CompT::component_changes>::type> {
+        using type = typename CompT::component_changes;
+    };
+
+    // Records which entities' components of one type changed, in version order. Each
+    // recorded change advances the version.
+    //
+    // The log observes a single pool, which is only written by one aspect at a time.
+    template <typename IdT>
+    class component_change_log : public component_pool_observer<IdT> {
+    private:
+        using ChangeT = std::pair<uint64_t, IdT>;
+
+        static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+        uint64_t current_version = 0;
+
+        // Every change made after this version is reported, because the pool was replaced
+        uint64_t replaced_version = 0;
+
+        // Ascending by version. A change is superseded by the entity's next change, and its
+        // entity is then cleared. Superseded changes are dropped when the log is compacted.
+        std::vector<ChangeT> changes;
+        size_t live_changes = 0;
+
+        // Index of the latest change of each entity slot. Once a slot is reused, the last
+        // change of its previous entity is still reported, because that entity's components
+        // were erased.
+        std::vector<size_t> latest;
+
+        static bool is_superseded(ChangeT const &change)
+        {
+            return static_cast<int32_t>(change.second) < 0;
+        }
+
+        void compact()
+        {
+            size_t kept = 0;
+            for(size_t i = 0; i < changes.size(); ++i) {
+                if(is_superseded(changes[i])) {
+                    continue;
+                }
+
+                size_t &slot_latest = latest[entity_slot(changes[i].second)];
+                if(slot_latest == i) {
+                    slot_latest = kept;
+                }
+
+                changes[kept++] = changes[i];
+            }
+
+            changes.resize(kept);
+        }
+
+    public:
+        uint64_t version() const
+        {
+            return current_version;
+        }
+
+        void mark_changed(IdT entity)
+        {
+            if(static_cast<int32_t>(entity) < 0) {
+                return;
+            }
+
+            size_t slot = entity_slot(entity);
+            if(slot >= latest.size()) {
+                latest.resize(slot + 1, npos);
+            }
+
+            size_t &slot_latest = latest[slot];
+            if(slot_latest != npos && changes[slot_latest].second == entity) {
+                changes[slot_latest].second = IdT();
+                --live_changes;
+            }
+
+            slot_latest = changes.size();
+            changes.emplace_back(++current_version, entity);
+            ++live_changes;
+
+            if(changes.size() > 64 && changes.size() > 2 * live_changes) {
+                compact();
+            }
+        }
+
+        // True when every component must be treated as changed since the version
+        bool replaced_since(uint64_t version) const
+        {
+            return replaced_version > version;
+        }
+
+        // Calls fn(entity) once for each entity whose components changed after the version,
+        // including entities whose components were erased before their slot was reused
+        template <typename FnT>
+        void for_each_changed_since(uint64_t version, FnT fn) const
+        {
+            auto first = std::upper_bound(changes.begin(),
+                                          changes.end(),
+                                          ChangeT(version, IdT()),
+                                          [](ChangeT const &a, ChangeT const &b) {
+                                              return a.first < b.first;
+                                          });
+
+            for(auto it = first; it != changes.end(); ++it) {
+                if(!is_superseded(*it)) {
+                    fn(it->second);
+                }
+            }
+        }
+
+        virtual void components_changed(IdT entity) override
+        {
+            mark_changed(entity);
+        }
+
+        virtual void components_moved() override
+        {
+            return;
+        }
+
+        virtual void components_replaced() override
+        {
+            replaced_version = ++current_version;
+        }
+    };
+
+    template <typename IdT>
+    constexpr size_t component_change_log<IdT>::npos;
+
+}
@@ -3,8 +3,13 @@
 #include "pool.hpp"
 #include "utility/range.hpp"
 #include "abstract_component_pool.hpp"
+#include "log/log.hpp"
+#include <algorithm>
+#include <memory>
+#include <typeinfo>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace gorc {
 
@@ -21,7 +26,17 @@ namespace gorc {
     private:
         PoolT components;
         IndexT index;
-        std::unordered_map<CompT*, const_iterator> erase_queue;
+        std::vector<const_iterator> erase_queue;
+
+        void clear()
+        {
+            for(auto const &em : index) {
+                components.erase(*em.second);
+            }
+
+            index.clear();
+            erase_queue.clear();
+        }
 
     public:
         auto begin()
@@ -39,19 +54,20 @@ namespace gorc {
         {
             auto &em = components.emplace(std::forward<ArgT>(args)...);
             index.emplace(parent, &em);
+            this->notify_components_changed(parent);
             return em;
         }
 
         auto erase(const_iterator it)
         {
-            erase_queue.emplace(it->second, it);
+            erase_queue.push_back(it);
             return ++it;
         }
 
         auto erase(const_iterator begin, const_iterator end)
         {
             for(auto it = begin; it != end; ++it) {
-                erase_queue.emplace(it->second, it);
+                erase_queue.push_back(it);
             }
 
             return end;
@@ -79,6 +95,13 @@ namespace gorc {
             return make_range(index.equal_range(id));
         }
 
+        // Returns one of the entity's components, or nullptr
+        CompT* find_first(IdT id) const
+        {
+            auto it = index.find(id);
+            return (it == index.end()) ? nullptr : it->second;
+        }
+
         virtual void erase_equal_range(IdT id) override
         {
             erase(equal_range(id));
@@ -102,16 +125,68 @@ namespace gorc {
 
         virtual void flush_erase_queue() override
         {
+            if(erase_queue.empty()) {
+                return;
+            }
+
+            // Components may be queued more than once
+            auto by_component = [](const_iterator const &a, const_iterator const &b) {
+                return a->second < b->second;
+            };
+
+            auto same_component = [](const_iterator const &a, const_iterator const &b) {
+                return a->second == b->second;
+            };
+
+            std::sort(erase_queue.begin(), erase_queue.end(), by_component);
+            erase_queue.erase(std::unique(erase_queue.begin(),
+                                          erase_queue.end(),
+                                          same_component),
+                              erase_queue.end());
+
+            bool log_erasures = is_log_level_enabled(log_level::debug);
             for(auto const &em : erase_queue) {
-                LOG_DEBUG(format("erasing component %s for entity %d") %
-                          typeid(CompT).name() %
-                          static_cast<int>(em.second->first));
-                components.erase(*em.second->second);
-                index.erase(em.second);
+                if(log_erasures) {
+                    LOG_DEBUG(format("erasing component %s for entity %d") %
+                              typeid(CompT).name() %
+                              static_cast<int>(em->first));
+                }
+
+                this->notify_components_changed(em->first);
+                components.erase(*em->second);
+                index.erase(em);
             }
 
             erase_queue.clear();
         }
+
+        virtual std::unique_ptr<component_pool_snapshot> take_snapshot() const override
+        {
+            auto snapshot = std::make_unique<typed_component_pool_snapshot<IdT, CompT>>();
+
+            snapshot->entities.reserve(index.size());
+            for(auto const &em : index) {
+                snapshot->append(em.first, *em.second);
+            }
+
+            return snapshot;
+        }
+
+        virtual void restore_snapshot(component_pool_snapshot const &snapshot) override
+        {
+            auto const &typed_snapshot =
+                static_cast<typed_component_pool_snapshot<IdT, CompT> const &>(snapshot);
+
+            clear();
+
+            index.reserve(typed_snapshot.entities.size());
+            typed_snapshot.restore([this](IdT entity, auto &&comp) {
+                    auto &em = components.emplace(std::forward<decltype(comp)>(comp));
+                    index.emplace(entity, &em);
+                });
+
+            this->notify_components_replaced();
+        }
     };
 
 }
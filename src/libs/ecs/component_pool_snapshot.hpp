@@ -0,0 +1,172 @@
+#pragma once
+
+#include "io/binary_input_stream.hpp"
+#include "io/binary_output_stream.hpp"
+#include "io/memory_file.hpp"
+#include "utility/constructor_tag.hpp"
+#include "log/log.hpp"
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace gorc {
+
+    class component_pool_snapshot {
+    public:
+        virtual ~component_pool_snapshot()
+        {
+            return;
+        }
+    };
+
+    // Components are captured by the cheapest method their type supports. Trivially
+    // copyable components with an accessible copy constructor are copied in bulk. Other
+    // components are serialized when they implement binary_serialize_object and a
+    // deserialization constructor, and are copy constructed otherwise.
+    class bulk_copy_snapshot_method { };
+    class serialize_snapshot_method { };
+    class copy_snapshot_method { };
+    class unsupported_snapshot_method { };
+
+    namespace detail {
+        template <typename CompT, typename = void>
+        struct is_component_serializable : std::false_type { };
+
+        template <typename CompT>
+        struct is_component_serializable<
+            CompT,
+            decltype((void) std::declval<CompT const &>()
+                         .binary_serialize_object(std::declval<binary_output_stream&>()),
+                     (void) CompT(deserialization_constructor,
+                                  std::declval<binary_input_stream&>()))>
+            : std::true_type { };
+    }
+
+    template <typename CompT>
+    struct component_snapshot_method_of {
+        using type = typename std::conditional<
+            std::is_trivially_copyable<CompT>::value &&
+                std::is_copy_constructible<CompT>::value,
+            bulk_copy_snapshot_method,
+            typename std::conditional<
+                detail::is_component_serializable<CompT>::value,
+                serialize_snapshot_method,
+                typename std::conditional<
+                    std::is_copy_constructible<CompT>::value,
+                    copy_snapshot_method,
+                    unsupported_snapshot_method>::type>::type>::type;
+    };
+
+    // Components of one type, listed in the pool's iteration order
+    template <typename IdT, typename CompT>
+    class typed_component_pool_snapshot : public component_pool_snapshot {
+    private:
+        using MethodT = typename component_snapshot_method_of<CompT>::type;
+
+        memory_file serialized;
+
+        // Components captured by copy. Trivially copyable ranges are copied whole.
+        std::vector<CompT> copies;
+
+        void append(bulk_copy_snapshot_method, CompT const *comps, size_t count)
+        {
+            copies.insert(copies.end(), comps, comps + count);
+        }
+
+        void append(serialize_snapshot_method, CompT const *comps, size_t count)
+        {
+            binary_output_stream bos(serialized);
+            for(size_t i = 0; i < count; ++i) {
+                binary_serialize(bos, comps[i]);
+            }
+        }
+
+        void append(copy_snapshot_method, CompT const *comps, size_t count)
+        {
+            copies.insert(copies.end(), comps, comps + count);
+        }
+
+        void append(unsupported_snapshot_method, CompT const *, size_t)
+        {
+            LOG_FATAL(format("component type %s cannot be captured by a snapshot") %
+                      typeid(CompT).name());
+        }
+
+        template <typename EmplaceFnT>
+        void restore(bulk_copy_snapshot_method, EmplaceFnT &fn) const
+        {
+            restore(copy_snapshot_method(), fn);
+        }
+
+        template <typename EmplaceFnT>
+        void restore(serialize_snapshot_method, EmplaceFnT &fn) const
+        {
+            memory_file::reader mr(serialized);
+            binary_input_stream bis(mr);
+            for(auto const &entity : entities) {
+                fn(entity, binary_deserialize<CompT>(bis));
+            }
+        }
+
+        template <typename EmplaceFnT>
+        void restore(copy_snapshot_method, EmplaceFnT &fn) const
+        {
+            for(size_t i = 0; i < entities.size(); ++i) {
+                fn(entities[i], copies[i]);
+            }
+        }
+
+        template <typename EmplaceFnT>
+        void restore(unsupported_snapshot_method, EmplaceFnT &) const
+        {
+            return;
+        }
+
+        void restore_components(bulk_copy_snapshot_method, std::vector<CompT> &comps) const
+        {
+            comps.insert(comps.end(), copies.begin(), copies.end());
+        }
+
+        template <typename OtherMethodT>
+        void restore_components(OtherMethodT method, std::vector<CompT> &comps) const
+        {
+            auto fn = [&comps](IdT, auto &&comp) {
+                comps.emplace_back(std::forward<decltype(comp)>(comp));
+            };
+
+            restore(method, fn);
+        }
+
+    public:
+        std::vector<IdT> entities;
+
+        // Captures a contiguous run of components. Their owners must already be listed.
+        void append(CompT const *comps, size_t count)
+        {
+            append(MethodT(), comps, count);
+        }
+
+        void append(IdT entity, CompT const &comp)
+        {
+            entities.push_back(entity);
+            append(MethodT(), &comp, 1);
+        }
+
+        // Calls fn(entity, comp) for each captured component
+        template <typename EmplaceFnT>
+        void restore(EmplaceFnT fn) const
+        {
+            restore(MethodT(), fn);
+        }
+
+        // Appends the captured components to comps, in capture order. Components copied in
+        // bulk are restored with a single copy.
+        void restore_components(std::vector<CompT> &comps) const
+        {
+            comps.reserve(comps.size() + entities.size());
+            restore_components(MethodT(), comps);
+        }
+    };
+
+}
@@ -1,23 +1,53 @@
 #pragma once
 
+#include "component_change_log.hpp"
 #include "component_pool.hpp"
+#include "component_storage.hpp"
+#include "dense_component_pool.hpp"
+#include "unique_component_pool.hpp"
 #include "utility/maybe.hpp"
 #include "utility/uid.hpp"
 #include "log/log.hpp"
 
+#include <initializer_list>
+#include <memory>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
 
 namespace gorc {
 
+    namespace detail {
+        template <typename IdT, typename CompT, typename StorageT>
+        struct component_pool_of;
+
+        template <typename IdT, typename CompT>
+        struct component_pool_of<IdT, CompT, paged_component_storage> {
+            using type = component_pool<IdT, CompT>;
+        };
+
+        template <typename IdT, typename CompT>
+        struct component_pool_of<IdT, CompT, dense_component_storage> {
+            using type = dense_component_pool<IdT, CompT>;
+        };
+
+        template <typename IdT, typename CompT>
+        struct component_pool_of<IdT, CompT, unique_component_storage> {
+            using type = unique_component_pool<IdT, CompT>;
+        };
+    }
+
     template <typename IdT>
     class component_relational_mapping {
     private:
         template <typename CompT>
-        using CompPoolT = component_pool<IdT, CompT>;
+        using CompPoolT = typename detail::component_pool_of<
+            IdT,
+            CompT,
+            typename component_storage_of<CompT>::type>::type;
 
         std::unordered_map<uint32_t, std::unique_ptr<abstract_component_pool<IdT>>> pools;
+        std::unordered_map<uint32_t, std::unique_ptr<component_change_log<IdT>>> change_logs;
 
         template <typename CompT>
         CompPoolT<CompT>& get_pool() const
@@ -31,7 +61,23 @@ namespace gorc {
             return *reinterpret_cast<CompPoolT<CompT>*>(it->second.get());
         }
 
+        template <typename CompT>
+        void register_change_log(untracked_component_changes)
+        {
+            return;
+        }
+
+        template <typename CompT>
+        void register_change_log(tracked_component_changes)
+        {
+            auto log = std::make_unique<component_change_log<IdT>>();
+            get_pool<CompT>().add_observer(log.get());
+            change_logs.emplace(uid_of<CompT>(), std::move(log));
+        }
+
     public:
+        using snapshot = std::unordered_map<uint32_t, std::unique_ptr<component_pool_snapshot>>;
+
         template <typename CompT>
         void register_component_type()
         {
@@ -40,6 +86,8 @@ namespace gorc {
                 LOG_FATAL(format("component type with uid %d is already registered") %
                           uid_of<CompT>());
             }
+
+            register_change_log<CompT>(typename component_changes_of<CompT>::type());
         }
 
         template <typename CompT, typename ...ArgT>
@@ -61,6 +109,30 @@ namespace gorc {
             return get_pool<CompT>().equal_range(entity);
         }
 
+        template <typename CompT>
+        CompT* find_first(IdT entity)
+        {
+            return get_pool<CompT>().find_first(entity);
+        }
+
+        template <typename CompT>
+        component_change_log<IdT>& change_log() const
+        {
+            auto it = change_logs.find(uid_of<CompT>());
+            if(it == change_logs.end()) {
+                LOG_FATAL(format("component type with uid %d does not track changes") %
+                          uid_of<CompT>());
+            }
+
+            return *it->second;
+        }
+
+        template <typename CompT>
+        CompPoolT<CompT> const& pool_of() const
+        {
+            return get_pool<CompT>();
+        }
+
         template <typename IteratorT, typename = decltype(*std::declval<IteratorT>())>
         auto erase(IteratorT it)
         {
@@ -81,6 +153,22 @@ namespace gorc {
             get_pool<CompT>().erase_if(pred);
         }
 
+        template <typename ...CompT>
+        void add_observer(component_pool_observer<IdT> *observer)
+        {
+            (void) std::initializer_list<int> {
+                (get_pool<CompT>().add_observer(observer), 0)...
+            };
+        }
+
+        template <typename ...CompT>
+        void remove_observer(component_pool_observer<IdT> *observer)
+        {
+            (void) std::initializer_list<int> {
+                (get_pool<CompT>().remove_observer(observer), 0)...
+            };
+        }
+
         void erase_equal_range(IdT entity)
         {
             for(auto &pool : pools) {
@@ -94,6 +182,29 @@ namespace gorc {
                 pool.second->flush_erase_queue();
             }
         }
+
+        snapshot take_snapshot() const
+        {
+            snapshot rv;
+            for(auto const &pool : pools) {
+                rv.emplace(pool.first, pool.second->take_snapshot());
+            }
+
+            return rv;
+        }
+
+        void restore_snapshot(snapshot const &snap)
+        {
+            for(auto &pool : pools) {
+                auto it = snap.find(pool.first);
+                if(it == snap.end()) {
+                    LOG_FATAL(format("snapshot does not contain component type with uid %d") %
+                              pool.first);
+                }
+
+                pool.second->restore_snapshot(*it->second);
+            }
+        }
     };
 
 }
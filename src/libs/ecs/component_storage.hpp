@@ -0,0 +1,40 @@
+#pragma once
+
+namespace gorc {
+
+    // Components are kept in paged storage by default. Component addresses are stable until
+    // the component is erased.
+    class paged_component_storage { };
+
+    // Component types declaring
+    //     using component_storage = dense_component_storage;
+    // are kept in contiguous arrays, which are faster to iterate. Emplacing or erasing a
+    // component may move the other components of the same type.
+    class dense_component_storage { };
+
+    // Component types declaring
+    //     using component_storage = unique_component_storage;
+    // are owned at most once by each entity, and are found by entity without hashing.
+    // Component addresses are stable until the component is erased.
+    class unique_component_storage { };
+
+    namespace detail {
+        template <typename T>
+        struct void_if_valid {
+            using type = void;
+        };
+    }
+
+    template <typename CompT, typename = void>
+    struct component_storage_of {
+        using type = paged_component_storage;
+    };
+
+    template <typename CompT>
+    struct component_storage_of<CompT,
+                                typename detail::void_if_valid<
+                                    typename CompT::component_storage>::type> {
+        using type = typename CompT::component_storage;
+    };
+
+}
@@ -0,0 +1,420 @@
+#pragma once
+
+#include "abstract_component_pool.hpp"
+#include "generational_entity_generator.hpp"
+#include "utility/range.hpp"
+#include "log/log.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace gorc {
+
+    // Component pool storing components in a contiguous array. Entities are mapped to their
+    // components by a sparse set: each entity slot indexes the head of a chain of dense slots.
+    // Erased components are replaced by the last component when the erase queue is flushed.
+    template <typename IdT, typename CompT>
+    class dense_component_pool : public abstract_component_pool<IdT> {
+    private:
+        using EntryT = std::pair<IdT, CompT*>;
+
+        static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+        template <bool IsConst>
+        class basic_iterator {
+            friend class dense_component_pool;
+
+            template <bool>
+            friend class basic_iterator;
+
+        private:
+            using PoolT = typename std::conditional<IsConst,
+                                                    dense_component_pool const,
+                                                    dense_component_pool>::type;
+
+            PoolT *pool = nullptr;
+            size_t index = npos;
+
+            // Iterators returned by equal_range follow the entity's chain of slots
+            bool follow_entity = false;
+
+            basic_iterator(PoolT *pool, size_t index, bool follow_entity)
+                : pool(pool)
+                , index(index)
+                , follow_entity(follow_entity)
+            {
+                return;
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = EntryT;
+            using difference_type = std::ptrdiff_t;
+            using pointer = typename std::conditional<IsConst,
+                                                      EntryT const*,
+                                                      EntryT*>::type;
+            using reference = typename std::conditional<IsConst,
+                                                        EntryT const&,
+                                                        EntryT&>::type;
+
+            basic_iterator() = default;
+
+            template <bool OtherIsConst,
+                      typename = typename std::enable_if<IsConst && !OtherIsConst>::type>
+            basic_iterator(basic_iterator<OtherIsConst> const &it)
+                : pool(it.pool)
+                , index(it.index)
+                , follow_entity(it.follow_entity)
+            {
+                return;
+            }
+
+            reference operator*() const
+            {
+                return pool->entries[index];
+            }
+
+            pointer operator->() const
+            {
+                return &pool->entries[index];
+            }
+
+            basic_iterator& operator++()
+            {
+                index = follow_entity ? pool->next_in_entity[index] : index + 1;
+                return *this;
+            }
+
+            basic_iterator operator++(int)
+            {
+                basic_iterator rv = *this;
+                ++(*this);
+                return rv;
+            }
+
+            bool operator==(basic_iterator const &it) const
+            {
+                return index == it.index;
+            }
+
+            bool operator!=(basic_iterator const &it) const
+            {
+                return index != it.index;
+            }
+        };
+
+    public:
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+
+    private:
+        std::vector<CompT> components;
+
+        // Parallel to components
+        std::vector<EntryT> entries;
+        std::vector<size_t> next_in_entity;
+
+        // First slot owned by each entity, indexed by entity
+        std::vector<size_t> heads;
+
+        // Slots queued for erasure. May contain duplicates until flushed.
+        std::vector<size_t> erase_queue;
+
+        static size_t entity_index(IdT entity)
+        {
+            int32_t value = static_cast<int32_t>(entity);
+            if(value < 0) {
+                LOG_FATAL(format("entity %d cannot own components") % value);
+            }
+
+            return entity_slot(entity);
+        }
+
+        size_t& link_to(size_t slot)
+        {
+            size_t *link = &heads[entity_index(entries[slot].first)];
+            while(*link != slot) {
+                link = &next_in_entity[*link];
+            }
+
+            return *link;
+        }
+
+        // Entities sharing an entity slot never own components at the same time. Stale ids
+        // do not match the owner of the head slot.
+        size_t entity_head(IdT entity) const
+        {
+            size_t index = entity_index(entity);
+            if(index >= heads.size()) {
+                return npos;
+            }
+
+            size_t head = heads[index];
+            return (head != npos && entries[head].first == entity) ? head : npos;
+        }
+
+        // Slots are filled from the back, so that the last slot is never queued
+        void fill_erased_slots()
+        {
+            for(auto it = erase_queue.rbegin(); it != erase_queue.rend(); ++it) {
+                size_t slot = *it;
+                link_to(slot) = next_in_entity[slot];
+
+                size_t last = components.size() - 1;
+                if(slot != last) {
+                    this->notify_components_changed(entries[last].first);
+                    link_to(last) = slot;
+                    components[slot] = std::move(components[last]);
+                    entries[slot].first = entries[last].first;
+                    next_in_entity[slot] = next_in_entity[last];
+                }
+
+                components.pop_back();
+                entries.pop_back();
+                next_in_entity.pop_back();
+            }
+        }
+
+        void compact_erased_slots()
+        {
+            for(auto const &entry : entries) {
+                heads[entity_index(entry.first)] = npos;
+            }
+
+            size_t kept = 0;
+            auto next_erased = erase_queue.begin();
+            for(size_t i = 0; i < components.size(); ++i) {
+                if(next_erased != erase_queue.end() && *next_erased == i) {
+                    ++next_erased;
+                    continue;
+                }
+
+                if(kept != i) {
+                    components[kept] = std::move(components[i]);
+                    entries[kept].first = entries[i].first;
+                }
+
+                ++kept;
+            }
+
+            components.erase(components.begin() + kept, components.end());
+            entries.resize(kept);
+            next_in_entity.resize(kept);
+
+            link_entity_chains();
+        }
+
+        // Chains list the newest slot first, as after emplace. Every head must be empty.
+        void link_entity_chains()
+        {
+            for(size_t i = 0; i < entries.size(); ++i) {
+                link_entity_chain(i);
+            }
+        }
+
+        void link_entity_chain(size_t i)
+        {
+            size_t index = entity_index(entries[i].first);
+            if(index >= heads.size()) {
+                heads.resize(index + 1, npos);
+            }
+
+            next_in_entity[i] = heads[index];
+            heads[index] = i;
+        }
+
+    public:
+        iterator begin()
+        {
+            return iterator(this, 0, false);
+        }
+
+        iterator end()
+        {
+            return iterator(this, entries.size(), false);
+        }
+
+        const_iterator begin() const
+        {
+            return const_iterator(this, 0, false);
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(this, entries.size(), false);
+        }
+
+        template <typename ...ArgT>
+        CompT& emplace(IdT parent, ArgT &&...args)
+        {
+            size_t index = entity_index(parent);
+            if(index >= heads.size()) {
+                heads.resize(index + 1, npos);
+            }
+            else if(heads[index] != npos && entries[heads[index]].first != parent) {
+                LOG_FATAL(format("entity %d is stale") % static_cast<int>(parent));
+            }
+
+            CompT const *old_components = components.data();
+            components.emplace_back(std::forward<ArgT>(args)...);
+
+            size_t slot = components.size() - 1;
+            entries.emplace_back(parent, &components.back());
+            next_in_entity.push_back(heads[index]);
+            heads[index] = slot;
+
+            if(components.data() != old_components) {
+                for(size_t i = 0; i < entries.size(); ++i) {
+                    entries[i].second = &components[i];
+                }
+
+                this->notify_components_moved();
+            }
+            else {
+                this->notify_components_changed(parent);
+            }
+
+            return components.back();
+        }
+
+        const_iterator erase(const_iterator it)
+        {
+            erase_queue.push_back(it.index);
+            return ++it;
+        }
+
+        const_iterator erase(const_iterator begin, const_iterator end)
+        {
+            for(auto it = begin; it != end; ++it) {
+                erase_queue.push_back(it.index);
+            }
+
+            return end;
+        }
+
+        auto erase(range<const_iterator> const &rng)
+        {
+            return erase(rng.begin(), rng.end());
+        }
+
+        auto erase(range<iterator> const &rng)
+        {
+            return erase(rng.begin(), rng.end());
+        }
+
+        range<iterator> equal_range(IdT id)
+        {
+            return make_range(iterator(this, entity_head(id), true),
+                              iterator(this, npos, true));
+        }
+
+        range<const_iterator> equal_range(IdT id) const
+        {
+            return make_range(const_iterator(this, entity_head(id), true),
+                              const_iterator(this, npos, true));
+        }
+
+        // Returns the entity's newest component, or nullptr
+        CompT* find_first(IdT id) const
+        {
+            size_t head = entity_head(id);
+            return (head == npos) ? nullptr : entries[head].second;
+        }
+
+        virtual void erase_equal_range(IdT id) override
+        {
+            erase(equal_range(id));
+        }
+
+        template <typename PredT>
+        void erase_if(PredT pred)
+        {
+            for(size_t i = 0; i < entries.size(); ++i) {
+                if(pred(entries[i].first, components[i])) {
+                    erase_queue.push_back(i);
+                }
+            }
+
+            return;
+        }
+
+        virtual void flush_erase_queue() override
+        {
+            if(erase_queue.empty()) {
+                return;
+            }
+
+            std::sort(erase_queue.begin(), erase_queue.end());
+            erase_queue.erase(std::unique(erase_queue.begin(), erase_queue.end()),
+                              erase_queue.end());
+
+            bool log_erasures = is_log_level_enabled(log_level::debug);
+            for(size_t slot : erase_queue) {
+                if(log_erasures) {
+                    LOG_DEBUG(format("erasing component %s for entity %d") %
+                              typeid(CompT).name() %
+                              static_cast<int>(entries[slot].first));
+                }
+
+                this->notify_components_changed(entries[slot].first);
+            }
+
+            // Small batches fill each erased slot from the back of the arrays. Large batches
+            // are compacted in one pass, which keeps the remaining components in order.
+            if(erase_queue.size() * 8 < components.size()) {
+                fill_erased_slots();
+            }
+            else {
+                compact_erased_slots();
+                this->notify_components_moved();
+            }
+
+            erase_queue.clear();
+        }
+
+        virtual std::unique_ptr<component_pool_snapshot> take_snapshot() const override
+        {
+            auto snapshot = std::make_unique<typed_component_pool_snapshot<IdT, CompT>>();
+
+            snapshot->entities.reserve(entries.size());
+            for(auto const &entry : entries) {
+                snapshot->entities.push_back(entry.first);
+            }
+
+            snapshot->append(components.data(), components.size());
+            return snapshot;
+        }
+
+        virtual void restore_snapshot(component_pool_snapshot const &snapshot) override
+        {
+            auto const &typed_snapshot =
+                static_cast<typed_component_pool_snapshot<IdT, CompT> const &>(snapshot);
+
+            std::fill(heads.begin(), heads.end(), npos);
+            components.clear();
+            entries.clear();
+            erase_queue.clear();
+
+            typed_snapshot.restore_components(components);
+
+            entries.reserve(components.size());
+            next_in_entity.resize(components.size());
+            for(size_t i = 0; i < components.size(); ++i) {
+                entries.emplace_back(typed_snapshot.entities[i], &components[i]);
+                link_entity_chain(i);
+            }
+
+            this->notify_components_replaced();
+        }
+    };
+
+    template <typename IdT, typename CompT>
+    constexpr size_t dense_component_pool<IdT, CompT>::npos;
+
+}
@@ -1,10 +1,12 @@
 #pragma once
 
-#include "sequential_entity_generator.hpp"
+#include "generational_entity_generator.hpp"
 #include "component_relational_mapping.hpp"
 #include "component_registry.hpp"
 #include "aspect.hpp"
+#include "aspect_scheduler.hpp"
 #include "entity_destroyed.hpp"
+#include "join_view.hpp"
 #include "utility/event_bus.hpp"
 #include "utility/maybe.hpp"
 #include "utility/service_registry.hpp"
@@ -12,17 +14,32 @@
 
 #include <vector>
 #include <memory>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
 
 namespace gorc {
 
     template <typename IdT>
     class entity_component_system {
     private:
-        sequential_entity_generator<IdT> entities;
+        generational_entity_generator<IdT> entities;
         component_relational_mapping<IdT> components;
+        std::unordered_map<std::type_index,
+                           std::unique_ptr<component_pool_observer<IdT>>> join_views;
         std::vector<std::unique_ptr<aspect>> aspects;
+        aspect_scheduler scheduler;
 
     public:
+        // Entity and component state of the system at one point in time
+        class snapshot {
+            friend class entity_component_system;
+
+        private:
+            generational_entity_generator<IdT> entities;
+            typename component_relational_mapping<IdT>::snapshot components;
+        };
+
         event_bus &bus;
 
         explicit entity_component_system(service_registry const &services)
@@ -37,9 +54,18 @@ namespace gorc {
             return entities.emplace();
         }
 
+        // Returns false for erased entities, including ids whose slot has been reused
+        bool contains_entity(IdT entity) const
+        {
+            return entities.contains(entity);
+        }
+
         void erase_entity(IdT entity)
         {
-            LOG_DEBUG(format("erased entity %d") % static_cast<int>(entity));
+            if(is_log_level_enabled(log_level::debug)) {
+                LOG_DEBUG(format("erased entity %d") % static_cast<int>(entity));
+            }
+
             bus.fire_event(entity_destroyed<IdT>(entity));
             components.erase_equal_range(entity);
             entities.erase(entity);
@@ -66,8 +92,9 @@ namespace gorc {
         template <typename CompT, typename ...ArgT>
         auto& get_unique_component(IdT entity, ArgT &&...args)
         {
-            for(auto &comp : find_component<CompT>(entity)) {
-                return *comp.second;
+            CompT *comp = components.template find_first<CompT>(entity);
+            if(comp) {
+                return *comp;
             }
 
             return emplace_component<CompT>(entity, std::forward<ArgT>(args)...);
@@ -76,13 +103,22 @@ namespace gorc {
         template <typename CompT>
         maybe<CompT*> maybe_get_unique_component(IdT entity)
         {
-            for(auto &comp : find_component<CompT>(entity)) {
-                return comp.second;
+            CompT *comp = components.template find_first<CompT>(entity);
+            if(comp) {
+                return comp;
             }
 
             return nothing;
         }
 
+        // Returns a handle to the entity's component. The component type must use unique
+        // component storage.
+        template <typename CompT>
+        component_handle<IdT, CompT> get_component_handle(IdT entity) const
+        {
+            return component_handle<IdT, CompT>(components.template pool_of<CompT>(), entity);
+        }
+
         template <typename CompT>
         void erase_components(IdT entity)
         {
@@ -96,6 +132,91 @@ namespace gorc {
             components.template erase_if<CompT>(pred);
         }
 
+        // Version of the component type's change log. The component type must declare
+        // tracked_component_changes.
+        template <typename CompT>
+        uint64_t component_version() const
+        {
+            return components.template change_log<CompT>().version();
+        }
+
+        // Records a write through a reference to the entity's components
+        template <typename CompT>
+        void mark_component_changed(IdT entity)
+        {
+            components.template change_log<CompT>().mark_changed(entity);
+        }
+
+        // Calls fn(entity) once for each entity whose components of the type changed after
+        // the version, including entities whose components were erased. Returns false
+        // without calling fn when the components were replaced by a snapshot since then,
+        // and every component must be treated as changed.
+        template <typename CompT, typename FnT>
+        bool for_each_component_changed_since(uint64_t version, FnT fn) const
+        {
+            auto const &log = components.template change_log<CompT>();
+            if(log.replaced_since(version)) {
+                return false;
+            }
+
+            log.for_each_changed_since(version, fn);
+            return true;
+        }
+
+        // Notifies the observer when components of the types are emplaced, erased or
+        // replaced. The observer must be removed before it is destroyed.
+        template <typename ...CompT>
+        void add_component_observer(component_pool_observer<IdT> *observer)
+        {
+            components.template add_observer<CompT...>(observer);
+        }
+
+        template <typename ...CompT>
+        void remove_component_observer(component_pool_observer<IdT> *observer)
+        {
+            components.template remove_observer<CompT...>(observer);
+        }
+
+        // Returns the cached join of the component types, creating it on first use
+        template <typename ...CompT>
+        join_view<IdT, CompT...>& get_join_view()
+        {
+            using ViewT = join_view<IdT, CompT...>;
+
+            auto &view = join_views[std::type_index(typeid(ViewT))];
+            if(!view) {
+                view = std::make_unique<ViewT>(components);
+            }
+
+            return *static_cast<ViewT*>(view.get());
+        }
+
+        // Aspects with declared component access are run concurrently by this many worker
+        // threads. Defaults to zero, which runs every aspect on the calling thread.
+        void set_aspect_worker_count(size_t count)
+        {
+            scheduler.set_worker_count(count);
+        }
+
+        // Captures every entity and component. Erasures queued since the last update are not
+        // captured. Trivially copyable components are copied in bulk.
+        snapshot take_snapshot() const
+        {
+            snapshot rv;
+            rv.entities = entities;
+            rv.entities.clear_erase_queue();
+            rv.components = components.take_snapshot();
+            return rv;
+        }
+
+        // Returns every entity and component to the state captured by the snapshot. No
+        // events are fired. Pending erasures are discarded.
+        void restore_snapshot(snapshot const &snap)
+        {
+            entities = snap.entities;
+            components.restore_snapshot(snap.components);
+        }
+
         template <typename T, typename ...ArgT>
         void emplace_aspect(ArgT &&...args)
         {
@@ -104,9 +225,7 @@ namespace gorc {
 
         void update(time_delta dt)
         {
-            for(auto &aspect : aspects) {
-                aspect->update(dt);
-            }
+            scheduler.update(aspects, dt);
 
             components.flush_erase_queue();
             entities.flush_erase_queue();
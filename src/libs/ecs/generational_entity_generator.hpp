@@ -0,0 +1,142 @@
+#pragma once
+
+#include "entity_generator.hpp"
+#include "io/binary_input_stream.hpp"
+#include "io/binary_output_stream.hpp"
+#include "log/log.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <vector>
+
+namespace gorc {
+
+    // Entity ids store a slot index in the low bits and the generation of the slot in the
+    // high bits. The first entity in each slot has generation zero, so ids are sequential
+    // until slots are recycled, and slot indices can index flat arrays.
+    constexpr int entity_slot_bits = 20;
+    constexpr uint32_t entity_slot_mask = (1U << entity_slot_bits) - 1U;
+    constexpr uint32_t max_entity_generation = (1U << (31 - entity_slot_bits)) - 1U;
+
+    template <typename IdT>
+    size_t entity_slot(IdT entity)
+    {
+        return static_cast<uint32_t>(static_cast<int32_t>(entity)) & entity_slot_mask;
+    }
+
+    template <typename IdT>
+    uint32_t entity_generation(IdT entity)
+    {
+        return static_cast<uint32_t>(static_cast<int32_t>(entity)) >> entity_slot_bits;
+    }
+
+    // Recycles the slots of erased entities. Each reuse increments the slot's generation, so
+    // that stale ids held by other systems do not refer to the new entity. Slots whose
+    // generation is exhausted are retired.
+    template <typename IdT>
+    class generational_entity_generator : public entity_generator<IdT> {
+    private:
+        std::vector<uint32_t> generations;
+        std::vector<uint8_t> live;
+
+        // Freed slots are reused oldest first
+        std::deque<uint32_t> free_slots;
+
+        std::vector<IdT> erase_queue;
+
+        static IdT make_id(size_t slot, uint32_t generation)
+        {
+            return IdT(static_cast<int32_t>((generation << entity_slot_bits) |
+                                            static_cast<uint32_t>(slot)));
+        }
+
+    public:
+        generational_entity_generator() = default;
+
+        generational_entity_generator(deserialization_constructor_tag, binary_input_stream &bis)
+        {
+            binary_deserialize_range<uint32_t>(bis, std::back_inserter(generations));
+            binary_deserialize_range<uint8_t>(bis, std::back_inserter(live));
+            binary_deserialize_range<uint32_t>(bis, std::back_inserter(free_slots));
+
+            if(live.size() != generations.size()) {
+                LOG_FATAL("entity generator state is corrupt");
+            }
+        }
+
+        void binary_serialize_object(binary_output_stream &bos) const
+        {
+            binary_serialize_range(bos, generations);
+            binary_serialize_range(bos, live);
+            binary_serialize_range(bos, free_slots);
+        }
+
+        virtual IdT emplace() override
+        {
+            if(!free_slots.empty()) {
+                uint32_t slot = free_slots.front();
+                free_slots.pop_front();
+
+                live[slot] = true;
+                return make_id(slot, generations[slot]);
+            }
+
+            if(generations.size() > entity_slot_mask) {
+                LOG_FATAL("entity slots exhausted");
+            }
+
+            generations.push_back(0);
+            live.push_back(true);
+            return make_id(generations.size() - 1, 0);
+        }
+
+        // Returns false for stale ids, whose slot has been recycled or not yet reused
+        bool contains(IdT entity) const
+        {
+            if(static_cast<int32_t>(entity) < 0) {
+                return false;
+            }
+
+            size_t slot = entity_slot(entity);
+            return slot < generations.size() &&
+                   live[slot] &&
+                   generations[slot] == entity_generation(entity);
+        }
+
+        virtual void erase(IdT entity) override
+        {
+            erase_queue.push_back(entity);
+        }
+
+        // Forgets erasures queued since the last flush
+        void clear_erase_queue()
+        {
+            erase_queue.clear();
+        }
+
+        virtual void flush_erase_queue() override
+        {
+            std::sort(erase_queue.begin(), erase_queue.end());
+            erase_queue.erase(std::unique(erase_queue.begin(), erase_queue.end()),
+                              erase_queue.end());
+
+            for(auto entity : erase_queue) {
+                if(!contains(entity)) {
+                    continue;
+                }
+
+                size_t slot = entity_slot(entity);
+                live[slot] = false;
+
+                if(generations[slot] < max_entity_generation) {
+                    ++generations[slot];
+                    free_slots.push_back(static_cast<uint32_t>(slot));
+                }
+            }
+
+            erase_queue.clear();
+        }
+    };
+
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "abstract_component_pool.hpp"
+#include "component_relational_mapping.hpp"
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace gorc {
+
+    namespace detail {
+
+        template <typename IdT, typename ...CompT>
+        struct join_view_rows;
+
+        template <typename IdT>
+        struct join_view_rows<IdT> {
+            template <typename RowT, typename ...PtrT>
+            void emplace(component_relational_mapping<IdT> &,
+                         std::vector<RowT> &rows,
+                         IdT entity,
+                         PtrT *...comps) const
+            {
+                rows.emplace_back(entity, comps...);
+            }
+        };
+
+        template <typename IdT, typename HeadCompT, typename ...CompT>
+        struct join_view_rows<IdT, HeadCompT, CompT...> {
+            template <typename RowT, typename ...PtrT>
+            void emplace(component_relational_mapping<IdT> &crm,
+                         std::vector<RowT> &rows,
+                         IdT entity,
+                         PtrT *...comps) const
+            {
+                for(auto &comp : crm.template equal_range<HeadCompT>(entity)) {
+                    join_view_rows<IdT, CompT...>()
+                        .emplace(crm, rows, entity, comps..., comp.second);
+                }
+            }
+        };
+
+    }
+
+    // Inner join of several component types, cached as one row per combination of
+    // components owned by the same entity. Rows are sorted by entity. The view is told by
+    // the component pools which entities changed, and only those entities are joined again
+    // before the next iteration.
+    //
+    // Components must not be emplaced into a dense pool joined by the view while the view is
+    // being iterated. Views are not synchronized, and are only used by aspects which run
+    // alone.
+    template <typename IdT, typename ...CompT>
+    class join_view : public component_pool_observer<IdT> {
+    private:
+        using RowT = std::tuple<IdT, CompT*...>;
+
+        component_relational_mapping<IdT> &components;
+        std::vector<RowT> rows;
+        std::vector<RowT> changed_rows;
+
+        std::vector<IdT> changed_entities;
+        bool needs_rebuild = true;
+
+        static bool row_entity_less(RowT const &a, RowT const &b)
+        {
+            return std::get<0>(a) < std::get<0>(b);
+        }
+
+        void rebuild()
+        {
+            changed_entities.clear();
+            for(auto const &comp : components.template range<
+                    typename std::tuple_element<0, std::tuple<CompT...>>::type>()) {
+                changed_entities.push_back(IdT(comp.first));
+            }
+
+            rows.clear();
+            needs_rebuild = false;
+        }
+
+        void refresh()
+        {
+            if(needs_rebuild) {
+                rebuild();
+            }
+
+            if(changed_entities.empty()) {
+                return;
+            }
+
+            std::sort(changed_entities.begin(), changed_entities.end());
+            changed_entities.erase(std::unique(changed_entities.begin(),
+                                               changed_entities.end()),
+                                   changed_entities.end());
+
+            rows.erase(std::remove_if(rows.begin(),
+                                      rows.end(),
+                                      [this](RowT const &row) {
+                                          return std::binary_search(changed_entities.begin(),
+                                                                    changed_entities.end(),
+                                                                    std::get<0>(row));
+                                      }),
+                       rows.end());
+
+            changed_rows.clear();
+            for(auto const &entity : changed_entities) {
+                detail::join_view_rows<IdT, CompT...>()
+                    .emplace(components, changed_rows, entity);
+            }
+
+            changed_entities.clear();
+
+            size_t unchanged_count = rows.size();
+            rows.insert(rows.end(), changed_rows.begin(), changed_rows.end());
+            std::inplace_merge(rows.begin(),
+                               rows.begin() + unchanged_count,
+                               rows.end(),
+                               row_entity_less);
+        }
+
+        template <typename FnT, size_t ...I>
+        void apply(FnT &fn, RowT const &row, std::index_sequence<I...>)
+        {
+            fn(std::get<0>(row), *std::get<I + 1>(row)...);
+        }
+
+    public:
+        explicit join_view(component_relational_mapping<IdT> &components)
+            : components(components)
+        {
+            components.template add_observer<CompT...>(this);
+        }
+
+        virtual ~join_view()
+        {
+            components.template remove_observer<CompT...>(this);
+        }
+
+        join_view(join_view const &) = delete;
+        join_view& operator=(join_view const &) = delete;
+
+        virtual void components_changed(IdT entity) override
+        {
+            changed_entities.push_back(entity);
+        }
+
+        virtual void components_moved() override
+        {
+            needs_rebuild = true;
+        }
+
+        // Calls fn(entity, comp...) for each row
+        template <typename FnT>
+        void for_each(FnT fn)
+        {
+            refresh();
+            for(auto const &row : rows) {
+                apply(fn, row, std::index_sequence_for<CompT...>());
+            }
+        }
+
+        size_t size()
+        {
+            refresh();
+            return rows.size();
+        }
+    };
+
+}
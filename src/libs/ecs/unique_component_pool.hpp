@@ -0,0 +1,385 @@
+#pragma once
+
+#include "abstract_component_pool.hpp"
+#include "generational_entity_generator.hpp"
+#include "pool.hpp"
+#include "utility/range.hpp"
+#include "log/log.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace gorc {
+
+    // Component pool for component types owned at most once by each entity. Components are
+    // kept in paged storage, so their addresses are stable until they are erased. Entity
+    // slots index the owning entity's entry directly.
+    template <typename IdT, typename CompT, size_t page_size = 128>
+    class unique_component_pool : public abstract_component_pool<IdT> {
+    private:
+        using EntryT = std::pair<IdT, CompT*>;
+
+        static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+        template <bool IsConst>
+        class basic_iterator {
+            friend class unique_component_pool;
+
+            template <bool>
+            friend class basic_iterator;
+
+        private:
+            using PoolT = typename std::conditional<IsConst,
+                                                    unique_component_pool const,
+                                                    unique_component_pool>::type;
+
+            PoolT *pool = nullptr;
+            size_t index = npos;
+
+            basic_iterator(PoolT *pool, size_t index)
+                : pool(pool)
+                , index(index)
+            {
+                return;
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = EntryT;
+            using difference_type = std::ptrdiff_t;
+            using pointer = typename std::conditional<IsConst,
+                                                      EntryT const*,
+                                                      EntryT*>::type;
+            using reference = typename std::conditional<IsConst,
+                                                        EntryT const&,
+                                                        EntryT&>::type;
+
+            basic_iterator() = default;
+
+            template <bool OtherIsConst,
+                      typename = typename std::enable_if<IsConst && !OtherIsConst>::type>
+            basic_iterator(basic_iterator<OtherIsConst> const &it)
+                : pool(it.pool)
+                , index(it.index)
+            {
+                return;
+            }
+
+            reference operator*() const
+            {
+                return pool->entries[index];
+            }
+
+            pointer operator->() const
+            {
+                return &pool->entries[index];
+            }
+
+            basic_iterator& operator++()
+            {
+                ++index;
+                return *this;
+            }
+
+            basic_iterator operator++(int)
+            {
+                basic_iterator rv = *this;
+                ++(*this);
+                return rv;
+            }
+
+            bool operator==(basic_iterator const &it) const
+            {
+                return index == it.index;
+            }
+
+            bool operator!=(basic_iterator const &it) const
+            {
+                return index != it.index;
+            }
+        };
+
+    public:
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+
+    private:
+        pool<CompT, page_size> components;
+        std::vector<EntryT> entries;
+
+        // Entry owned by each entity slot
+        std::vector<size_t> slot_entries;
+
+        // Entries queued for erasure. May contain duplicates until flushed.
+        std::vector<size_t> erase_queue;
+
+        static size_t entity_index(IdT entity)
+        {
+            int32_t value = static_cast<int32_t>(entity);
+            if(value < 0) {
+                LOG_FATAL(format("entity %d cannot own components") % value);
+            }
+
+            return entity_slot(entity);
+        }
+
+        // Invalid and stale ids do not own components
+        size_t find_entry(IdT entity) const
+        {
+            if(static_cast<int32_t>(entity) < 0) {
+                return npos;
+            }
+
+            size_t index = entity_slot(entity);
+            if(index >= slot_entries.size()) {
+                return npos;
+            }
+
+            size_t entry = slot_entries[index];
+            return (entry != npos && entries[entry].first == entity) ? entry : npos;
+        }
+
+        range<iterator> entry_range(size_t entry)
+        {
+            if(entry == npos) {
+                return make_range(iterator(this, npos), iterator(this, npos));
+            }
+
+            return make_range(iterator(this, entry), iterator(this, entry + 1));
+        }
+
+        void clear()
+        {
+            for(auto const &entry : entries) {
+                components.erase(*entry.second);
+                slot_entries[entity_slot(entry.first)] = npos;
+            }
+
+            entries.clear();
+            erase_queue.clear();
+        }
+
+    public:
+        ~unique_component_pool()
+        {
+            clear();
+        }
+
+        iterator begin()
+        {
+            return iterator(this, 0);
+        }
+
+        iterator end()
+        {
+            return iterator(this, entries.size());
+        }
+
+        const_iterator begin() const
+        {
+            return const_iterator(this, 0);
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(this, entries.size());
+        }
+
+        template <typename ...ArgT>
+        CompT& emplace(IdT parent, ArgT &&...args)
+        {
+            size_t index = entity_index(parent);
+            if(index >= slot_entries.size()) {
+                slot_entries.resize(index + 1, npos);
+            }
+            else if(slot_entries[index] != npos) {
+                if(entries[slot_entries[index]].first != parent) {
+                    LOG_FATAL(format("entity %d is stale") % static_cast<int>(parent));
+                }
+
+                LOG_FATAL(format("entity %d already owns this component") %
+                          static_cast<int>(parent));
+            }
+
+            auto &em = components.emplace(std::forward<ArgT>(args)...);
+            slot_entries[index] = entries.size();
+            entries.emplace_back(parent, &em);
+
+            this->notify_components_changed(parent);
+            return em;
+        }
+
+        // Returns the entity's component, or nullptr
+        CompT* find_first(IdT entity) const
+        {
+            size_t entry = find_entry(entity);
+            return (entry == npos) ? nullptr : entries[entry].second;
+        }
+
+        const_iterator erase(const_iterator it)
+        {
+            erase_queue.push_back(it.index);
+            return ++it;
+        }
+
+        const_iterator erase(const_iterator begin, const_iterator end)
+        {
+            for(auto it = begin; it != end; ++it) {
+                erase_queue.push_back(it.index);
+            }
+
+            return end;
+        }
+
+        auto erase(range<const_iterator> const &rng)
+        {
+            return erase(rng.begin(), rng.end());
+        }
+
+        auto erase(range<iterator> const &rng)
+        {
+            return erase(rng.begin(), rng.end());
+        }
+
+        range<iterator> equal_range(IdT id)
+        {
+            return entry_range(find_entry(id));
+        }
+
+        range<const_iterator> equal_range(IdT id) const
+        {
+            auto rng = const_cast<unique_component_pool*>(this)->equal_range(id);
+            return make_range(const_iterator(rng.begin()), const_iterator(rng.end()));
+        }
+
+        virtual void erase_equal_range(IdT id) override
+        {
+            erase(equal_range(id));
+        }
+
+        template <typename PredT>
+        void erase_if(PredT pred)
+        {
+            for(size_t i = 0; i < entries.size(); ++i) {
+                if(pred(entries[i].first, *entries[i].second)) {
+                    erase_queue.push_back(i);
+                }
+            }
+
+            return;
+        }
+
+        virtual void flush_erase_queue() override
+        {
+            if(erase_queue.empty()) {
+                return;
+            }
+
+            std::sort(erase_queue.begin(), erase_queue.end());
+            erase_queue.erase(std::unique(erase_queue.begin(), erase_queue.end()),
+                              erase_queue.end());
+
+            bool log_erasures = is_log_level_enabled(log_level::debug);
+
+            // Entries are filled from the back, so that the last entry is never queued.
+            // Components do not move.
+            for(auto it = erase_queue.rbegin(); it != erase_queue.rend(); ++it) {
+                size_t entry = *it;
+                IdT entity = entries[entry].first;
+
+                if(log_erasures) {
+                    LOG_DEBUG(format("erasing component %s for entity %d") %
+                              typeid(CompT).name() %
+                              static_cast<int>(entity));
+                }
+
+                this->notify_components_changed(entity);
+                components.erase(*entries[entry].second);
+                slot_entries[entity_index(entity)] = npos;
+
+                size_t last = entries.size() - 1;
+                if(entry != last) {
+                    entries[entry] = entries[last];
+                    slot_entries[entity_index(entries[entry].first)] = entry;
+                }
+
+                entries.pop_back();
+            }
+
+            erase_queue.clear();
+        }
+
+        virtual std::unique_ptr<component_pool_snapshot> take_snapshot() const override
+        {
+            auto snapshot = std::make_unique<typed_component_pool_snapshot<IdT, CompT>>();
+
+            snapshot->entities.reserve(entries.size());
+            for(auto const &entry : entries) {
+                snapshot->append(entry.first, *entry.second);
+            }
+
+            return snapshot;
+        }
+
+        virtual void restore_snapshot(component_pool_snapshot const &snapshot) override
+        {
+            auto const &typed_snapshot =
+                static_cast<typed_component_pool_snapshot<IdT, CompT> const &>(snapshot);
+
+            clear();
+
+            entries.reserve(typed_snapshot.entities.size());
+            typed_snapshot.restore([this](IdT entity, auto &&comp) {
+                    size_t index = entity_index(entity);
+                    if(index >= slot_entries.size()) {
+                        slot_entries.resize(index + 1, npos);
+                    }
+
+                    auto &em = components.emplace(std::forward<decltype(comp)>(comp));
+                    slot_entries[index] = entries.size();
+                    entries.emplace_back(entity, &em);
+                });
+
+            this->notify_components_replaced();
+        }
+    };
+
+    template <typename IdT, typename CompT, size_t page_size>
+    constexpr size_t unique_component_pool<IdT, CompT, page_size>::npos;
+
+    // Refers to the unique component of an entity. The handle stays valid while the
+    // component exists, and resolves to nothing once it is erased or the entity id is stale.
+    template <typename IdT, typename CompT>
+    class component_handle {
+    private:
+        unique_component_pool<IdT, CompT> const *pool = nullptr;
+        IdT entity;
+
+    public:
+        component_handle() = default;
+
+        component_handle(unique_component_pool<IdT, CompT> const &pool, IdT entity)
+            : pool(&pool)
+            , entity(entity)
+        {
+            return;
+        }
+
+        IdT get_entity() const
+        {
+            return entity;
+        }
+
+        CompT* get() const
+        {
+            return pool ? pool->find_first(entity) : nullptr;
+        }
+    };
+
+}
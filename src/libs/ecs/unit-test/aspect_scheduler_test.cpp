@@ -0,0 +1,240 @@
+#include "ecs/aspect_scheduler.hpp"
+#include "test/test.hpp"
+#include "utility/uid.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gorc;
+
+namespace {
+
+    class mock_health_component {
+    public:
+        uid(10);
+    };
+
+    class mock_armor_component {
+    public:
+        uid(20);
+    };
+
+    class mock_event {
+    public:
+        std::string name;
+
+        explicit mock_event(std::string const &name)
+            : name(name)
+        {
+            return;
+        }
+    };
+
+    class recording_aspect : public aspect {
+    public:
+        std::string name;
+        event_bus &bus;
+
+        recording_aspect(std::string const &name, event_bus &bus)
+            : name(name)
+            , bus(bus)
+        {
+            return;
+        }
+
+        virtual void update(time_delta) override
+        {
+            bus.fire_event(mock_event(name));
+        }
+    };
+
+    class reader_aspect : public recording_aspect {
+    public:
+        reader_aspect(std::string const &name, event_bus &bus)
+            : recording_aspect(name, bus)
+        {
+            declare_reads<mock_health_component>();
+        }
+    };
+
+    class writer_aspect : public recording_aspect {
+    public:
+        writer_aspect(std::string const &name, event_bus &bus)
+            : recording_aspect(name, bus)
+        {
+            declare_reads<mock_armor_component>();
+            declare_writes<mock_health_component>();
+        }
+    };
+
+    // Waits for the other aspect of the pair to start, which only happens when both run
+    // concurrently.
+    class rendezvous_aspect : public aspect {
+    public:
+        std::atomic<int> &arrived;
+        bool &met;
+
+        rendezvous_aspect(std::atomic<int> &arrived, bool &met)
+            : arrived(arrived)
+            , met(met)
+        {
+            declare_reads<mock_health_component>();
+        }
+
+        virtual void update(time_delta) override
+        {
+            ++arrived;
+
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while(arrived < 2 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+
+            met = (arrived >= 2);
+        }
+    };
+
+    class throwing_aspect : public recording_aspect {
+    public:
+        throwing_aspect(std::string const &name, event_bus &bus)
+            : recording_aspect(name, bus)
+        {
+            declare_reads<mock_health_component>();
+        }
+
+        virtual void update(time_delta dt) override
+        {
+            recording_aspect::update(dt);
+            throw std::runtime_error(name);
+        }
+    };
+
+    // Records the number of events dispatched before it runs
+    class checking_aspect : public aspect {
+    public:
+        std::vector<std::string> &events;
+        size_t seen = 0;
+
+        explicit checking_aspect(std::vector<std::string> &events)
+            : events(events)
+        {
+            return;
+        }
+
+        virtual void update(time_delta) override
+        {
+            seen = events.size();
+        }
+    };
+
+    class aspect_scheduler_fixture : public test::fixture {
+    public:
+        event_bus bus;
+        std::vector<std::string> events;
+        maybe<scoped_delegate> delegate;
+
+        aspect_scheduler_fixture()
+        {
+            delegate = bus.add_handler<mock_event>([this](mock_event const &e) {
+                    events.push_back(e.name);
+                });
+        }
+    };
+
+}
+
+begin_suite_fixture(aspect_scheduler_test, aspect_scheduler_fixture);
+
+test_case(conflicts)
+{
+    reader_aspect reader1("r1", bus);
+    reader_aspect reader2("r2", bus);
+    writer_aspect writer("w", bus);
+    recording_aspect undeclared("u", bus);
+
+    assert_true(!reader1.conflicts_with(reader2));
+    assert_true(reader1.conflicts_with(writer));
+    assert_true(writer.conflicts_with(reader2));
+    assert_true(writer.conflicts_with(writer));
+    assert_true(undeclared.conflicts_with(reader1));
+    assert_true(reader1.conflicts_with(undeclared));
+}
+
+test_case(events_in_declaration_order)
+{
+    std::vector<std::unique_ptr<aspect>> aspects;
+    aspects.push_back(std::make_unique<reader_aspect>("r1", bus));
+    aspects.push_back(std::make_unique<writer_aspect>("w", bus));
+    aspects.push_back(std::make_unique<reader_aspect>("r2", bus));
+    aspects.push_back(std::make_unique<recording_aspect>("u", bus));
+    aspects.push_back(std::make_unique<reader_aspect>("r3", bus));
+    aspects.push_back(std::make_unique<reader_aspect>("r4", bus));
+
+    std::vector<std::string> expected { "r1", "w", "r2", "u", "r3", "r4" };
+
+    for(size_t workers : { 0, 1, 4 }) {
+        aspect_scheduler scheduler(workers);
+
+        for(int i = 0; i < 20; ++i) {
+            events.clear();
+            scheduler.update(aspects, time_delta(0.0));
+            assert_range_eq(events, expected);
+        }
+    }
+}
+
+test_case(readers_run_concurrently)
+{
+    std::atomic<int> arrived(0);
+    bool met1 = false;
+    bool met2 = false;
+
+    std::vector<std::unique_ptr<aspect>> aspects;
+    aspects.push_back(std::make_unique<rendezvous_aspect>(arrived, met1));
+    aspects.push_back(std::make_unique<rendezvous_aspect>(arrived, met2));
+
+    aspect_scheduler scheduler(1);
+    scheduler.update(aspects, time_delta(0.0));
+
+    assert_true(met1);
+    assert_true(met2);
+}
+
+test_case(undeclared_aspect_sees_earlier_events)
+{
+    std::vector<std::unique_ptr<aspect>> aspects;
+    aspects.push_back(std::make_unique<reader_aspect>("r1", bus));
+    aspects.push_back(std::make_unique<reader_aspect>("r2", bus));
+    aspects.push_back(std::make_unique<checking_aspect>(events));
+
+    aspect_scheduler scheduler(2);
+    scheduler.update(aspects, time_delta(0.0));
+
+    assert_eq(static_cast<checking_aspect&>(*aspects.back()).seen, 2UL);
+}
+
+test_case(failed_stage_discards_events)
+{
+    std::vector<std::unique_ptr<aspect>> aspects;
+    aspects.push_back(std::make_unique<reader_aspect>("r1", bus));
+    aspects.push_back(std::make_unique<throwing_aspect>("t", bus));
+    aspects.push_back(std::make_unique<reader_aspect>("r2", bus));
+
+    for(size_t workers : { 0, 2 }) {
+        aspect_scheduler scheduler(workers);
+
+        for(int i = 0; i < 5; ++i) {
+            events.clear();
+            assert_throws(scheduler.update(aspects, time_delta(0.0)),
+                          std::runtime_error,
+                          "t");
+            assert_true(events.empty());
+        }
+    }
+}
+
+end_suite(aspect_scheduler_test);
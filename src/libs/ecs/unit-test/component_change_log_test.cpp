@@ -0,0 +1,92 @@
+#include "test/test.hpp"
+#include "ecs/component_change_log.hpp"
+#include "content/id.hpp"
+#include <vector>
+
+using namespace gorc;
+
+namespace {
+    std::vector<int> changed_since(component_change_log<thing_id> const &log, uint64_t version)
+    {
+        std::vector<int> rv;
+        log.for_each_changed_since(version, [&](thing_id entity) {
+                rv.push_back(static_cast<int>(entity));
+            });
+
+        return rv;
+    }
+}
+
+begin_suite(component_change_log_test);
+
+test_case(changes_in_order)
+{
+    component_change_log<thing_id> log;
+    assert_eq(log.version(), 0UL);
+
+    log.mark_changed(thing_id(5));
+    log.mark_changed(thing_id(2));
+    uint64_t v = log.version();
+    log.mark_changed(thing_id(9));
+    log.mark_changed(thing_id(5));
+
+    assert_eq(log.version(), 4UL);
+    assert_range_eq(changed_since(log, 0), std::vector<int>({ 2, 9, 5 }));
+    assert_range_eq(changed_since(log, v), std::vector<int>({ 9, 5 }));
+    assert_true(changed_since(log, log.version()).empty());
+}
+
+test_case(compaction)
+{
+    component_change_log<thing_id> log;
+
+    for(int i = 0; i < 1000; ++i) {
+        log.mark_changed(thing_id(i % 10));
+    }
+
+    uint64_t v = log.version();
+    log.mark_changed(thing_id(3));
+
+    assert_range_eq(changed_since(log, 0),
+                    std::vector<int>({ 0, 1, 2, 4, 5, 6, 7, 8, 9, 3 }));
+    assert_range_eq(changed_since(log, v), std::vector<int>({ 3 }));
+}
+
+test_case(recycled_entity)
+{
+    component_change_log<thing_id> log;
+    thing_id recycled(static_cast<int32_t>((1U << entity_slot_bits) | 3U));
+
+    log.mark_changed(thing_id(3));
+    log.mark_changed(thing_id(3));
+    uint64_t v = log.version();
+    log.mark_changed(recycled);
+
+    // The erasure of the slot's previous entity is still reported
+    assert_range_eq(changed_since(log, 0),
+                    std::vector<int>({ 3, static_cast<int>(recycled) }));
+    assert_range_eq(changed_since(log, v),
+                    std::vector<int>({ static_cast<int>(recycled) }));
+
+    for(int i = 0; i < 1000; ++i) {
+        log.mark_changed(recycled);
+    }
+
+    assert_range_eq(changed_since(log, 0),
+                    std::vector<int>({ 3, static_cast<int>(recycled) }));
+}
+
+test_case(replaced)
+{
+    component_change_log<thing_id> log;
+
+    log.mark_changed(thing_id(3));
+    uint64_t v = log.version();
+    assert_true(!log.replaced_since(v));
+
+    log.components_replaced();
+    assert_true(log.replaced_since(v));
+    assert_true(!log.replaced_since(log.version()));
+}
+
+end_suite(component_change_log_test);
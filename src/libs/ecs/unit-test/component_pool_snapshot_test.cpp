@@ -0,0 +1,226 @@
+#include "test/test.hpp"
+#include "ecs/component_pool.hpp"
+#include "ecs/dense_component_pool.hpp"
+#include "ecs/unique_component_pool.hpp"
+#include "content/id.hpp"
+#include <set>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+using namespace gorc;
+
+namespace {
+    class mock_component {
+    public:
+        int value = 0;
+
+        mock_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    class mock_serializable_component {
+    public:
+        std::string value;
+
+        mock_serializable_component(int value)
+            : value(std::to_string(value))
+        {
+            return;
+        }
+
+        mock_serializable_component(deserialization_constructor_tag, binary_input_stream &is)
+            : value(binary_deserialize<std::string>(is))
+        {
+            return;
+        }
+
+        void binary_serialize_object(binary_output_stream &os) const
+        {
+            binary_serialize(os, value);
+        }
+    };
+
+    class mock_copyable_component {
+    public:
+        std::string value;
+
+        mock_copyable_component(int value)
+            : value(std::to_string(value))
+        {
+            return;
+        }
+    };
+
+    class mock_unique_ptr_component {
+    public:
+        std::unique_ptr<int> value;
+    };
+
+    class mock_pinned_component {
+    public:
+        int value = 0;
+
+        mock_pinned_component() = default;
+        mock_pinned_component(mock_pinned_component const &) = delete;
+    };
+
+    template <typename RangeT>
+    std::set<std::tuple<int, std::string>> mock_comp_to_set(RangeT &&rng)
+    {
+        std::set<std::tuple<int, std::string>> rv;
+        for(auto const &em : rng) {
+            rv.emplace(static_cast<int>(em.first), std::to_string(em.second->value));
+        }
+
+        return rv;
+    }
+
+    template <typename RangeT>
+    std::set<std::tuple<int, std::string>> mock_string_comp_to_set(RangeT &&rng)
+    {
+        std::set<std::tuple<int, std::string>> rv;
+        for(auto const &em : rng) {
+            rv.emplace(static_cast<int>(em.first), em.second->value);
+        }
+
+        return rv;
+    }
+
+    template <typename PoolT>
+    void fill_pool(PoolT &p)
+    {
+        for(int i = 0; i < 200; ++i) {
+            p.emplace(thing_id(i), i);
+        }
+    }
+
+    template <typename PoolT>
+    void churn_pool(PoolT &p)
+    {
+        for(int i = 0; i < 200; i += 2) {
+            p.erase_equal_range(thing_id(i));
+        }
+
+        p.flush_erase_queue();
+
+        for(int i = 200; i < 250; ++i) {
+            p.emplace(thing_id(i), i);
+        }
+
+        // Queued erasures are discarded by restore
+        p.erase_equal_range(thing_id(1));
+    }
+}
+
+begin_suite(component_pool_snapshot_test);
+
+test_case(snapshot_method)
+{
+    assert_true((std::is_same<component_snapshot_method_of<mock_component>::type,
+                              bulk_copy_snapshot_method>::value));
+    assert_true((std::is_same<component_snapshot_method_of<mock_serializable_component>::type,
+                              serialize_snapshot_method>::value));
+    assert_true((std::is_same<component_snapshot_method_of<mock_copyable_component>::type,
+                              copy_snapshot_method>::value));
+    assert_true((std::is_same<component_snapshot_method_of<mock_unique_ptr_component>::type,
+                              unsupported_snapshot_method>::value));
+    assert_true((std::is_same<component_snapshot_method_of<mock_pinned_component>::type,
+                              unsupported_snapshot_method>::value));
+}
+
+test_case(paged_bulk_copy)
+{
+    component_pool<thing_id, mock_component> p;
+    fill_pool(p);
+    auto expected = mock_comp_to_set(p);
+
+    auto snapshot = p.take_snapshot();
+    churn_pool(p);
+    p.restore_snapshot(*snapshot);
+    p.flush_erase_queue();
+
+    assert_range_eq(mock_comp_to_set(p), expected);
+    assert_eq(p.find_first(thing_id(7))->value, 7);
+}
+
+test_case(dense_bulk_copy)
+{
+    dense_component_pool<thing_id, mock_component> p;
+    fill_pool(p);
+    p.emplace(thing_id(3), 1000);
+    auto expected = mock_comp_to_set(p);
+
+    auto snapshot = p.take_snapshot();
+    churn_pool(p);
+    p.restore_snapshot(*snapshot);
+    p.flush_erase_queue();
+
+    assert_range_eq(mock_comp_to_set(p), expected);
+    assert_eq(mock_comp_to_set(p.equal_range(thing_id(3))).size(), 2UL);
+    assert_true(p.equal_range(thing_id(220)).empty());
+}
+
+test_case(dense_copy)
+{
+    dense_component_pool<thing_id, mock_copyable_component> p;
+    fill_pool(p);
+    p.emplace(thing_id(3), 1000);
+    auto expected = mock_string_comp_to_set(p);
+
+    auto snapshot = p.take_snapshot();
+    churn_pool(p);
+    p.restore_snapshot(*snapshot);
+    p.flush_erase_queue();
+
+    assert_range_eq(mock_string_comp_to_set(p), expected);
+    assert_eq(mock_string_comp_to_set(p.equal_range(thing_id(3))).size(), 2UL);
+    assert_true(p.equal_range(thing_id(220)).empty());
+}
+
+test_case(unique_serialize)
+{
+    unique_component_pool<thing_id, mock_serializable_component> p;
+    fill_pool(p);
+    auto expected = mock_string_comp_to_set(p);
+
+    auto snapshot = p.take_snapshot();
+    churn_pool(p);
+    p.restore_snapshot(*snapshot);
+    p.flush_erase_queue();
+
+    assert_range_eq(mock_string_comp_to_set(p), expected);
+    assert_eq(p.find_first(thing_id(8))->value, std::string("8"));
+    assert_true(p.find_first(thing_id(220)) == nullptr);
+}
+
+test_case(paged_copy)
+{
+    component_pool<thing_id, mock_copyable_component> p;
+    fill_pool(p);
+    auto expected = mock_string_comp_to_set(p);
+
+    auto snapshot = p.take_snapshot();
+    churn_pool(p);
+    p.restore_snapshot(*snapshot);
+
+    assert_range_eq(mock_string_comp_to_set(p), expected);
+}
+
+test_case(unsupported)
+{
+    component_pool<thing_id, mock_unique_ptr_component> p;
+    p.emplace(thing_id(3));
+
+    std::string expected = str(format("component type %s cannot be captured by a snapshot") %
+                               typeid(mock_unique_ptr_component).name());
+
+    assert_throws_logged(p.take_snapshot());
+    assert_log_message(log_level::error, expected);
+    assert_log_empty();
+}
+
+end_suite(component_pool_snapshot_test);
@@ -134,4 +134,26 @@ test_case(erase_equal_range)
     assert_true(p.equal_range(thing_id(3)).empty());
 }
 
+test_case(erase_duplicate)
+{
+    component_pool<thing_id, mock_component> p;
+
+    for(int i = 0; i < 10; ++i) {
+        p.emplace(thing_id(i % 2), i);
+    }
+
+    p.erase_equal_range(thing_id(1));
+    p.erase_equal_range(thing_id(1));
+    p.erase_if([](thing_id, mock_component const &c) { return c.value > 5; });
+    p.flush_erase_queue();
+
+    std::set<int> values;
+    for(auto const &em : p) {
+        values.insert(em.second->value);
+    }
+
+    std::set<int> expected { 0, 2, 4 };
+    assert_range_eq(values, expected);
+}
+
 end_suite(component_pool_test);
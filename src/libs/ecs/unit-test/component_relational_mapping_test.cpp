@@ -31,6 +31,32 @@ namespace {
         }
     };
 
+    class mock_dense_component {
+    public:
+        uid(30);
+        using component_storage = dense_component_storage;
+        int value;
+
+        mock_dense_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    class mock_unique_component {
+    public:
+        uid(40);
+        using component_storage = unique_component_storage;
+        int value;
+
+        mock_unique_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
     template <typename RangeT>
     std::set<int> mock_comp_to_range(RangeT const &rng)
     {
@@ -50,6 +76,8 @@ namespace {
         {
             cr.register_component_type<mock_component>();
             cr.register_component_type<mock_other_component>();
+            cr.register_component_type<mock_dense_component>();
+            cr.register_component_type<mock_unique_component>();
         }
     };
 
@@ -157,6 +185,48 @@ test_case(erase_equal_range)
     assert_true(crm.equal_range<mock_other_component>(thing_id(1)).empty());
 }
 
+test_case(dense_storage)
+{
+    component_relational_mapping<thing_id> crm;
+    cr.register_component_types(crm);
+
+    for(int i = 0; i < 10; ++i) {
+        crm.emplace<mock_dense_component>(thing_id(i % 2), i);
+        crm.emplace<mock_component>(thing_id(i % 2), i);
+    }
+
+    auto rng = crm.equal_range<mock_dense_component>(thing_id(1));
+    crm.erase(rng.begin(), rng.end());
+    crm.erase_equal_range(thing_id(0));
+    crm.flush_erase_queue();
+
+    assert_true(crm.equal_range<mock_dense_component>(thing_id(0)).empty());
+    assert_true(crm.equal_range<mock_dense_component>(thing_id(1)).empty());
+    assert_range_eq(mock_comp_to_range(crm.equal_range<mock_component>(thing_id(1))),
+                    std::set<int>({ 1, 3, 5, 7, 9 }));
+}
+
+test_case(unique_storage)
+{
+    component_relational_mapping<thing_id> crm;
+    cr.register_component_types(crm);
+
+    for(int i = 0; i < 10; ++i) {
+        crm.emplace<mock_unique_component>(thing_id(i), i);
+        crm.emplace<mock_component>(thing_id(i % 2), i);
+    }
+
+    assert_eq(crm.find_first<mock_unique_component>(thing_id(4))->value, 4);
+    assert_true(crm.find_first<mock_unique_component>(thing_id(10)) == nullptr);
+
+    crm.erase_equal_range(thing_id(4));
+    crm.flush_erase_queue();
+
+    assert_true(crm.find_first<mock_unique_component>(thing_id(4)) == nullptr);
+    assert_range_eq(mock_comp_to_range(crm.range<mock_unique_component>()),
+                    std::set<int>({ 0, 1, 2, 3, 5, 6, 7, 8, 9 }));
+}
+
 test_case(register_duplicate)
 {
     component_relational_mapping<thing_id> crm;
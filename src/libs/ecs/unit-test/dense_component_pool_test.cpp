@@ -0,0 +1,263 @@
+#include "test/test.hpp"
+#include "ecs/dense_component_pool.hpp"
+#include "content/id.hpp"
+#include <set>
+#include <tuple>
+#include <vector>
+
+using namespace gorc;
+
+namespace {
+    class mock_component {
+    public:
+        int value = 0;
+
+        mock_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    template <typename RangeT>
+    std::set<std::tuple<int, int>> mock_comp_to_set(RangeT const &rng)
+    {
+        std::set<std::tuple<int, int>> rv;
+        for(auto const &em : rng) {
+            rv.emplace(static_cast<int>(em.first), em.second->value);
+        }
+
+        return rv;
+    }
+}
+
+begin_suite(dense_component_pool_test);
+
+test_case(simple_emplace_find)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    auto const &comp = p.emplace(thing_id(5), 2);
+    assert_eq(comp.value, 2);
+
+    std::set<int> value;
+    for(auto const &em : p.equal_range(thing_id(5))) {
+        value.insert(em.second->value);
+    }
+
+    std::set<int> expected { 2 };
+    assert_range_eq(value, expected);
+
+    assert_true(p.equal_range(thing_id(4)).empty());
+    assert_true(p.equal_range(thing_id(100)).empty());
+}
+
+test_case(iterate_all)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    std::set<std::tuple<int, int>> expected;
+    for(int i = 0; i < 300; ++i) {
+        p.emplace(thing_id(i % 7), i);
+        expected.emplace(i % 7, i);
+    }
+
+    assert_range_eq(mock_comp_to_set(p), expected);
+    assert_eq(mock_comp_to_set(p.equal_range(thing_id(3))).size(), 43UL);
+}
+
+test_case(erase_single)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    for(int i = 0; i < 10; ++i) {
+        p.emplace(thing_id(3), i);
+        p.emplace(thing_id(4), i + 10);
+    }
+
+    auto rng = p.equal_range(thing_id(3));
+    for(dense_component_pool<thing_id, mock_component>::const_iterator it = rng.begin();
+        it != rng.end(); ) {
+        if(it->second->value % 2) {
+            it = p.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    p.flush_erase_queue();
+
+    std::set<std::tuple<int, int>> expected3 {
+            std::make_tuple(3, 0),
+            std::make_tuple(3, 2),
+            std::make_tuple(3, 4),
+            std::make_tuple(3, 6),
+            std::make_tuple(3, 8)
+        };
+    assert_range_eq(mock_comp_to_set(p.equal_range(thing_id(3))), expected3);
+
+    std::set<std::tuple<int, int>> expected4;
+    for(int i = 0; i < 10; ++i) {
+        expected4.emplace(4, i + 10);
+    }
+
+    assert_range_eq(mock_comp_to_set(p.equal_range(thing_id(4))), expected4);
+
+    auto expected_all = expected3;
+    expected_all.insert(expected4.begin(), expected4.end());
+    assert_range_eq(mock_comp_to_set(p), expected_all);
+}
+
+test_case(erase_range)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    for(int i = 0; i < 10; ++i) {
+        p.emplace(thing_id(2), i);
+        p.emplace(thing_id(3), i);
+    }
+
+    p.erase(p.equal_range(thing_id(3)));
+    p.flush_erase_queue();
+
+    assert_true(p.equal_range(thing_id(3)).empty());
+    assert_eq(mock_comp_to_set(p.equal_range(thing_id(2))).size(), 10UL);
+}
+
+test_case(erase_const_range)
+{
+    dense_component_pool<thing_id, mock_component> p;
+    dense_component_pool<thing_id, mock_component> const &p2 = p;
+
+    for(int i = 0; i < 10; ++i) {
+        p.emplace(thing_id(3), i);
+    }
+
+    std::set<int> value1;
+    for(auto const &em : p2.equal_range(thing_id(3))) {
+        value1.insert(em.second->value);
+    }
+
+    std::set<int> expected1 { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    assert_range_eq(value1, expected1);
+
+    p.erase(p2.equal_range(thing_id(3)));
+    p.flush_erase_queue();
+
+    assert_true(p.equal_range(thing_id(3)).empty());
+}
+
+test_case(erase_twice)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    for(int i = 0; i < 5; ++i) {
+        p.emplace(thing_id(i), i);
+    }
+
+    p.erase_equal_range(thing_id(1));
+    p.erase_equal_range(thing_id(1));
+    p.erase_if([](thing_id, mock_component const &c) { return c.value >= 3; });
+    p.flush_erase_queue();
+
+    std::set<std::tuple<int, int>> expected {
+            std::make_tuple(0, 0),
+            std::make_tuple(2, 2)
+        };
+    assert_range_eq(mock_comp_to_set(p), expected);
+}
+
+test_case(erase_large_batch)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    for(int i = 0; i < 100; ++i) {
+        p.emplace(thing_id(i % 10), i);
+    }
+
+    p.erase_if([](thing_id, mock_component const &c) { return c.value % 3 != 0; });
+    p.erase_equal_range(thing_id(9));
+    p.flush_erase_queue();
+
+    std::vector<int> values;
+    std::set<std::tuple<int, int>> expected;
+    for(int i = 0; i < 100; ++i) {
+        if(i % 3 == 0 && i % 10 != 9) {
+            values.push_back(i);
+            expected.emplace(i % 10, i);
+        }
+    }
+
+    // Remaining components keep their order
+    std::vector<int> actual_values;
+    for(auto const &em : p) {
+        actual_values.push_back(em.second->value);
+    }
+
+    assert_range_eq(actual_values, values);
+
+    std::set<std::tuple<int, int>> actual;
+    for(int i = 0; i < 10; ++i) {
+        auto entity_set = mock_comp_to_set(p.equal_range(thing_id(i)));
+        actual.insert(entity_set.begin(), entity_set.end());
+    }
+
+    assert_range_eq(actual, expected);
+}
+
+test_case(emplace_after_erase)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    for(int i = 0; i < 10; ++i) {
+        p.emplace(thing_id(i), i);
+    }
+
+    p.erase_equal_range(thing_id(0));
+    p.flush_erase_queue();
+
+    p.emplace(thing_id(0), 20);
+    p.emplace(thing_id(9), 29);
+
+    std::set<std::tuple<int, int>> expected0 { std::make_tuple(0, 20) };
+    assert_range_eq(mock_comp_to_set(p.equal_range(thing_id(0))), expected0);
+
+    std::set<std::tuple<int, int>> expected9 {
+            std::make_tuple(9, 9),
+            std::make_tuple(9, 29)
+        };
+    assert_range_eq(mock_comp_to_set(p.equal_range(thing_id(9))), expected9);
+}
+
+test_case(stale_entity)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    thing_id recycled(static_cast<int32_t>((1U << entity_slot_bits) | 3U));
+
+    p.emplace(thing_id(3), 5);
+    assert_true(p.equal_range(recycled).empty());
+
+    p.erase_equal_range(thing_id(3));
+    p.flush_erase_queue();
+
+    p.emplace(recycled, 7);
+    assert_true(p.equal_range(thing_id(3)).empty());
+    assert_eq(mock_comp_to_set(p.equal_range(recycled)).size(), 1UL);
+
+    assert_throws_logged(p.emplace(thing_id(3), 8));
+    assert_log_message(log_level::error, "entity 3 is stale");
+    assert_log_empty();
+}
+
+test_case(invalid_entity)
+{
+    dense_component_pool<thing_id, mock_component> p;
+
+    assert_throws_logged(p.emplace(thing_id(), 5));
+    assert_log_message(log_level::error, "entity -1 cannot own components");
+    assert_log_empty();
+}
+
+end_suite(dense_component_pool_test);
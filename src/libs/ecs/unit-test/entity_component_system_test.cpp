@@ -4,6 +4,7 @@
 #include "test/test.hpp"
 #include <set>
 #include <tuple>
+#include <vector>
 
 using namespace gorc;
 
@@ -32,6 +33,33 @@ namespace {
         }
     };
 
+    class mock_inventory_component {
+    public:
+        uid(30);
+        using component_storage = unique_component_storage;
+        int value;
+
+        mock_inventory_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    class mock_position_component {
+    public:
+        uid(40);
+        using component_storage = dense_component_storage;
+        using component_changes = tracked_component_changes;
+        int value;
+
+        mock_position_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
     class mock_aspect : public aspect {
     public:
         mock_aspect(entity_component_system<thing_id>&, int value)
@@ -46,6 +74,27 @@ namespace {
         }
     };
 
+    class mock_observer : public component_pool_observer<thing_id> {
+    public:
+        std::vector<thing_id> changed;
+        int replaced = 0;
+
+        virtual void components_changed(thing_id entity) override
+        {
+            changed.push_back(entity);
+        }
+
+        virtual void components_moved() override
+        {
+            return;
+        }
+
+        virtual void components_replaced() override
+        {
+            ++replaced;
+        }
+    };
+
     class entity_component_system_fixture : public test::fixture {
     public:
         event_bus bus;
@@ -56,6 +105,8 @@ namespace {
         {
             cr.register_component_type<mock_health_component>();
             cr.register_component_type<mock_armor_component>();
+            cr.register_component_type<mock_inventory_component>();
+            cr.register_component_type<mock_position_component>();
             services.add(cr);
 
             services.add(bus);
@@ -134,4 +185,161 @@ test_case(destroy_entity)
     assert_true(ecs.all_components<mock_health_component>().empty());
 }
 
+test_case(recycle_entity)
+{
+    entity_component_system<thing_id> ecs(services);
+
+    auto tid = ecs.emplace_entity();
+    ecs.emplace_component<mock_health_component>(tid, 3);
+
+    ecs.erase_entity(tid);
+    assert_true(ecs.contains_entity(tid));
+
+    ecs.update(time_delta());
+    assert_true(!ecs.contains_entity(tid));
+
+    auto tid2 = ecs.emplace_entity();
+    assert_true(ecs.contains_entity(tid2));
+    assert_eq(entity_slot(tid2), entity_slot(tid));
+    assert_true(tid2 != tid);
+
+    ecs.emplace_component<mock_health_component>(tid2, 5);
+    assert_true(ecs.find_component<mock_health_component>(tid).empty());
+    assert_eq(ecs.find_component<mock_health_component>(tid2).begin()->second->value, 5);
+}
+
+test_case(unique_component)
+{
+    entity_component_system<thing_id> ecs(services);
+
+    auto tid = ecs.emplace_entity();
+    assert_true(!ecs.maybe_get_unique_component<mock_inventory_component>(tid).has_value());
+
+    auto h = ecs.get_component_handle<mock_inventory_component>(tid);
+    assert_true(h.get() == nullptr);
+
+    auto &inv = ecs.get_unique_component<mock_inventory_component>(tid, 5);
+    assert_eq(&ecs.get_unique_component<mock_inventory_component>(tid, 6), &inv);
+    assert_eq(h.get(), &inv);
+    assert_eq(h.get()->value, 5);
+
+    ecs.erase_entity(tid);
+    ecs.update(time_delta());
+    assert_true(h.get() == nullptr);
+}
+
+test_case(snapshot_restore)
+{
+    entity_component_system<thing_id> ecs(services);
+
+    auto tid1 = ecs.emplace_entity();
+    auto tid2 = ecs.emplace_entity();
+    ecs.emplace_component<mock_health_component>(tid1, 3);
+    ecs.emplace_component<mock_health_component>(tid2, 4);
+    ecs.emplace_component<mock_inventory_component>(tid2, 5);
+
+    auto snapshot = ecs.take_snapshot();
+
+    ecs.erase_entity(tid1);
+    ecs.update(time_delta());
+    auto tid3 = ecs.emplace_entity();
+    ecs.emplace_component<mock_armor_component>(tid3, 6);
+    ecs.get_unique_component<mock_inventory_component>(tid2, 0).value = 7;
+    ecs.erase_entity(tid2);
+
+    ecs.restore_snapshot(snapshot);
+    ecs.update(time_delta());
+
+    assert_true(ecs.contains_entity(tid1));
+    assert_true(ecs.contains_entity(tid2));
+    assert_true(!ecs.contains_entity(tid3));
+    assert_eq(ecs.find_component<mock_health_component>(tid1).begin()->second->value, 3);
+    assert_eq(ecs.find_component<mock_health_component>(tid2).begin()->second->value, 4);
+    assert_eq(ecs.get_unique_component<mock_inventory_component>(tid2, 0).value, 5);
+    assert_true(ecs.all_components<mock_armor_component>().empty());
+
+    auto tid4 = ecs.emplace_entity();
+    assert_true(tid4 != tid1);
+    assert_true(tid4 != tid2);
+}
+
+test_case(changed_components)
+{
+    entity_component_system<thing_id> ecs(services);
+
+    std::vector<thing_id> tids;
+    for(int i = 0; i < 4; ++i) {
+        tids.push_back(ecs.emplace_entity());
+        ecs.emplace_component<mock_position_component>(tids.back(), i);
+    }
+
+    uint64_t v = ecs.component_version<mock_position_component>();
+
+    ecs.mark_component_changed<mock_position_component>(tids[2]);
+    ecs.erase_entity(tids[0]);
+    ecs.update(time_delta());
+
+    std::set<thing_id> changed;
+    assert_true(ecs.for_each_component_changed_since<mock_position_component>(v,
+                    [&](thing_id entity) { changed.insert(entity); }));
+    assert_range_eq(changed, std::set<thing_id>({ tids[0], tids[2] }));
+
+    auto snapshot = ecs.take_snapshot();
+    v = ecs.component_version<mock_position_component>();
+    ecs.restore_snapshot(snapshot);
+    assert_true(!ecs.for_each_component_changed_since<mock_position_component>(v,
+                     [&](thing_id) { }));
+
+    assert_throws_logged(ecs.component_version<mock_health_component>());
+    assert_log_message(log_level::error, "component type with uid 10 does not track changes");
+    assert_log_empty();
+}
+
+test_case(changed_components_reused_slot)
+{
+    entity_component_system<thing_id> ecs(services);
+
+    auto tid = ecs.emplace_entity();
+    ecs.emplace_component<mock_position_component>(tid, 1);
+    uint64_t v = ecs.component_version<mock_position_component>();
+
+    ecs.erase_entity(tid);
+    ecs.update(time_delta());
+
+    auto tid2 = ecs.emplace_entity();
+    ecs.emplace_component<mock_position_component>(tid2, 2);
+    assert_true(tid2 != tid);
+    assert_eq(entity_slot(tid2), entity_slot(tid));
+
+    std::set<thing_id> changed;
+    assert_true(ecs.for_each_component_changed_since<mock_position_component>(v,
+                    [&](thing_id entity) { changed.insert(entity); }));
+    assert_range_eq(changed, std::set<thing_id>({ tid, tid2 }));
+}
+
+test_case(component_observer)
+{
+    entity_component_system<thing_id> ecs(services);
+    mock_observer observer;
+    ecs.add_component_observer<mock_inventory_component>(&observer);
+
+    auto tid = ecs.emplace_entity();
+    auto tid2 = ecs.emplace_entity();
+    ecs.emplace_component<mock_inventory_component>(tid, 1);
+    ecs.emplace_component<mock_health_component>(tid2, 2);
+    assert_range_eq(observer.changed, std::vector<thing_id>({ tid }));
+
+    auto snapshot = ecs.take_snapshot();
+    ecs.erase_entity(tid);
+    ecs.update(time_delta());
+    assert_range_eq(observer.changed, std::vector<thing_id>({ tid, tid }));
+
+    ecs.restore_snapshot(snapshot);
+    assert_eq(observer.replaced, 1);
+
+    ecs.remove_component_observer<mock_inventory_component>(&observer);
+    ecs.emplace_component<mock_inventory_component>(tid2, 3);
+    assert_eq(observer.changed.size(), size_t(2));
+}
+
 end_suite(entity_component_system_test);
@@ -0,0 +1,111 @@
+#include "test/test.hpp"
+#include "ecs/generational_entity_generator.hpp"
+#include "io/memory_file.hpp"
+
+using namespace gorc;
+
+begin_suite(generational_entity_generator_test);
+
+test_case(sequential_until_recycled)
+{
+    generational_entity_generator<thing_id> eg;
+    for(int i = 0; i < 10; ++i) {
+        assert_eq(static_cast<int>(eg.emplace()), i);
+    }
+
+    eg.erase(thing_id(5));
+    assert_eq(static_cast<int>(eg.emplace()), 10);
+}
+
+test_case(recycle_slot)
+{
+    generational_entity_generator<thing_id> eg;
+    for(int i = 0; i < 10; ++i) {
+        eg.emplace();
+    }
+
+    eg.erase(thing_id(5));
+    eg.erase(thing_id(5));
+    eg.flush_erase_queue();
+
+    auto recycled = eg.emplace();
+    assert_eq(entity_slot(recycled), 5UL);
+    assert_eq(entity_generation(recycled), 1U);
+    assert_eq(static_cast<int>(eg.emplace()), 10);
+}
+
+test_case(stale_handles)
+{
+    generational_entity_generator<thing_id> eg;
+    auto first = eg.emplace();
+    assert_true(eg.contains(first));
+
+    eg.erase(first);
+    assert_true(eg.contains(first));
+    eg.flush_erase_queue();
+    assert_true(!eg.contains(first));
+
+    auto second = eg.emplace();
+    assert_true(second != first);
+    assert_eq(entity_slot(second), entity_slot(first));
+    assert_true(eg.contains(second));
+    assert_true(!eg.contains(first));
+
+    // Erasing a stale handle does not erase the new entity
+    eg.erase(first);
+    eg.flush_erase_queue();
+    assert_true(eg.contains(second));
+
+    assert_true(!eg.contains(thing_id()));
+    assert_true(!eg.contains(thing_id(100)));
+}
+
+test_case(retire_exhausted_slot)
+{
+    generational_entity_generator<thing_id> eg;
+    for(uint32_t i = 0; i < max_entity_generation; ++i) {
+        auto entity = eg.emplace();
+        assert_eq(entity_slot(entity), 0UL);
+        eg.erase(entity);
+        eg.flush_erase_queue();
+    }
+
+    auto last = eg.emplace();
+    assert_eq(entity_generation(last), max_entity_generation);
+    eg.erase(last);
+    eg.flush_erase_queue();
+
+    assert_eq(entity_slot(eg.emplace()), 1UL);
+}
+
+test_case(serialize_round_trip)
+{
+    memory_file mf;
+
+    generational_entity_generator<thing_id> eg;
+    for(int i = 0; i < 4; ++i) {
+        eg.emplace();
+    }
+
+    eg.erase(thing_id(1));
+    eg.erase(thing_id(2));
+    eg.flush_erase_queue();
+
+    binary_output_stream bos(mf);
+    binary_serialize(bos, eg);
+
+    binary_input_stream bis(mf);
+    auto eg2 = binary_deserialize<generational_entity_generator<thing_id>>(bis);
+
+    assert_true(eg2.contains(thing_id(0)));
+    assert_true(!eg2.contains(thing_id(1)));
+    assert_true(eg2.contains(thing_id(3)));
+
+    auto recycled = eg2.emplace();
+    assert_eq(entity_slot(recycled), 1UL);
+    assert_eq(entity_generation(recycled), 1U);
+    assert_eq(entity_slot(eg2.emplace()), 2UL);
+    assert_eq(static_cast<int>(eg2.emplace()), 4);
+}
+
+end_suite(generational_entity_generator_test);
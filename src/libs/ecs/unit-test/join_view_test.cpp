@@ -0,0 +1,190 @@
+#include "ecs/join_view.hpp"
+#include "ecs/entity_component_system.hpp"
+#include "test/test.hpp"
+#include <set>
+#include <tuple>
+
+using namespace gorc;
+
+namespace {
+
+    class mock_health_component {
+    public:
+        uid(10);
+        int value;
+
+        mock_health_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    class mock_armor_component {
+    public:
+        uid(20);
+        using component_storage = dense_component_storage;
+        int value;
+
+        mock_armor_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    using mock_row = std::tuple<int, int, int>;
+
+    std::set<mock_row> view_to_set(join_view<thing_id,
+                                             mock_health_component,
+                                             mock_armor_component> &view)
+    {
+        std::set<mock_row> rv;
+        view.for_each([&rv](thing_id id,
+                            mock_health_component &health,
+                            mock_armor_component &armor) {
+                rv.emplace(static_cast<int>(id), health.value, armor.value);
+            });
+
+        return rv;
+    }
+
+    class join_view_fixture : public test::fixture {
+    public:
+        event_bus bus;
+        component_registry<thing_id> cr;
+        service_registry services;
+
+        join_view_fixture()
+        {
+            cr.register_component_type<mock_health_component>();
+            cr.register_component_type<mock_armor_component>();
+
+            services.add(cr);
+            services.add(bus);
+        }
+    };
+
+}
+
+begin_suite_fixture(join_view_test, join_view_fixture);
+
+test_case(initial_join)
+{
+    entity_component_system<thing_id> ecs(services);
+
+    auto thing0 = ecs.emplace_entity();
+    ecs.emplace_component<mock_health_component>(thing0, 5);
+    ecs.emplace_component<mock_armor_component>(thing0, 6);
+    ecs.emplace_component<mock_armor_component>(thing0, 7);
+
+    auto thing1 = ecs.emplace_entity();
+    ecs.emplace_component<mock_health_component>(thing1, 12);
+
+    auto &view = ecs.get_join_view<mock_health_component, mock_armor_component>();
+
+    std::set<mock_row> expected {
+            std::make_tuple(0, 5, 6),
+            std::make_tuple(0, 5, 7)
+        };
+    assert_range_eq(view_to_set(view), expected);
+}
+
+test_case(shared_view)
+{
+    entity_component_system<thing_id> ecs(services);
+
+    auto &view1 = ecs.get_join_view<mock_health_component, mock_armor_component>();
+    auto &view2 = ecs.get_join_view<mock_health_component, mock_armor_component>();
+    assert_eq(&view1, &view2);
+}
+
+test_case(incremental_emplace)
+{
+    entity_component_system<thing_id> ecs(services);
+    auto &view = ecs.get_join_view<mock_health_component, mock_armor_component>();
+
+    std::set<thing_id> things;
+    for(int i = 0; i < 4; ++i) {
+        auto thing = ecs.emplace_entity();
+        things.insert(thing);
+        ecs.emplace_component<mock_health_component>(thing, i);
+    }
+
+    assert_eq(view.size(), 0UL);
+
+    ecs.emplace_component<mock_armor_component>(thing_id(2), 20);
+    ecs.emplace_component<mock_armor_component>(thing_id(0), 0);
+
+    std::set<mock_row> expected1 {
+            std::make_tuple(0, 0, 0),
+            std::make_tuple(2, 2, 20)
+        };
+    assert_range_eq(view_to_set(view), expected1);
+
+    ecs.emplace_component<mock_health_component>(thing_id(2), 30);
+
+    std::set<mock_row> expected2 {
+            std::make_tuple(0, 0, 0),
+            std::make_tuple(2, 2, 20),
+            std::make_tuple(2, 30, 20)
+        };
+    assert_range_eq(view_to_set(view), expected2);
+}
+
+test_case(incremental_erase)
+{
+    entity_component_system<thing_id> ecs(services);
+    auto &view = ecs.get_join_view<mock_health_component, mock_armor_component>();
+
+    for(int i = 0; i < 10; ++i) {
+        auto thing = ecs.emplace_entity();
+        ecs.emplace_component<mock_health_component>(thing, i);
+        ecs.emplace_component<mock_armor_component>(thing, i * 10);
+    }
+
+    assert_eq(view.size(), 10UL);
+
+    ecs.erase_entity(thing_id(3));
+    ecs.erase_components<mock_armor_component>(thing_id(0));
+    ecs.erase_components<mock_health_component>(thing_id(9));
+
+    // Components are erased when the erase queues are flushed
+    assert_eq(view.size(), 10UL);
+    ecs.update(std::chrono::seconds(0));
+
+    std::set<mock_row> expected;
+    for(int i = 1; i < 9; ++i) {
+        if(i != 3) {
+            expected.emplace(i, i, i * 10);
+        }
+    }
+
+    assert_range_eq(view_to_set(view), expected);
+}
+
+test_case(rows_sorted_by_entity)
+{
+    entity_component_system<thing_id> ecs(services);
+    auto &view = ecs.get_join_view<mock_health_component, mock_armor_component>();
+
+    for(int i = 0; i < 10; ++i) {
+        auto thing = ecs.emplace_entity();
+        ecs.emplace_component<mock_health_component>(thing, i);
+    }
+
+    for(int i = 9; i >= 0; --i) {
+        ecs.emplace_component<mock_armor_component>(thing_id(i), i);
+        view.size();
+    }
+
+    std::vector<int> entities;
+    view.for_each([&entities](thing_id id, mock_health_component &, mock_armor_component &) {
+            entities.push_back(static_cast<int>(id));
+        });
+
+    std::vector<int> expected { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    assert_range_eq(entities, expected);
+}
+
+end_suite(join_view_test);
@@ -0,0 +1,161 @@
+#include "test/test.hpp"
+#include "ecs/unique_component_pool.hpp"
+#include "content/id.hpp"
+#include <set>
+#include <tuple>
+
+using namespace gorc;
+
+namespace {
+    class mock_component {
+    public:
+        int value = 0;
+
+        mock_component(int value)
+            : value(value)
+        {
+            return;
+        }
+    };
+
+    template <typename RangeT>
+    std::set<std::tuple<int, int>> mock_comp_to_set(RangeT const &rng)
+    {
+        std::set<std::tuple<int, int>> rv;
+        for(auto const &em : rng) {
+            rv.emplace(static_cast<int>(em.first), em.second->value);
+        }
+
+        return rv;
+    }
+}
+
+begin_suite(unique_component_pool_test);
+
+test_case(simple_emplace_find)
+{
+    unique_component_pool<thing_id, mock_component> p;
+
+    auto &comp = p.emplace(thing_id(5), 2);
+    assert_eq(comp.value, 2);
+    assert_eq(p.find_first(thing_id(5)), &comp);
+
+    std::set<std::tuple<int, int>> expected { std::make_tuple(5, 2) };
+    assert_range_eq(mock_comp_to_set(p.equal_range(thing_id(5))), expected);
+
+    assert_true(p.equal_range(thing_id(4)).empty());
+    assert_true(p.equal_range(thing_id(100)).empty());
+    assert_true(p.find_first(thing_id(4)) == nullptr);
+    assert_true(p.find_first(thing_id()) == nullptr);
+}
+
+test_case(iterate_all)
+{
+    unique_component_pool<thing_id, mock_component> p;
+
+    std::set<std::tuple<int, int>> expected;
+    for(int i = 0; i < 300; ++i) {
+        p.emplace(thing_id(i), i * 2);
+        expected.emplace(i, i * 2);
+    }
+
+    assert_range_eq(mock_comp_to_set(p), expected);
+}
+
+test_case(erase_keeps_addresses)
+{
+    unique_component_pool<thing_id, mock_component> p;
+
+    for(int i = 0; i < 300; ++i) {
+        p.emplace(thing_id(i), i);
+    }
+
+    mock_component *kept = p.find_first(thing_id(299));
+
+    std::set<std::tuple<int, int>> expected;
+    for(int i = 0; i < 300; ++i) {
+        if(i % 3 == 0) {
+            p.erase_equal_range(thing_id(i));
+            p.erase_equal_range(thing_id(i));
+        }
+        else {
+            expected.emplace(i, i);
+        }
+    }
+
+    assert_eq(mock_comp_to_set(p).size(), 300UL);
+    p.flush_erase_queue();
+
+    assert_range_eq(mock_comp_to_set(p), expected);
+    assert_eq(p.find_first(thing_id(299)), kept);
+    assert_true(p.find_first(thing_id(3)) == nullptr);
+    assert_eq(p.find_first(thing_id(4))->value, 4);
+}
+
+test_case(erase_if)
+{
+    unique_component_pool<thing_id, mock_component> p;
+
+    for(int i = 0; i < 10; ++i) {
+        p.emplace(thing_id(i), i);
+    }
+
+    p.erase_if([](thing_id, mock_component const &c) { return c.value >= 5; });
+    p.flush_erase_queue();
+
+    std::set<std::tuple<int, int>> expected;
+    for(int i = 0; i < 5; ++i) {
+        expected.emplace(i, i);
+    }
+
+    assert_range_eq(mock_comp_to_set(p), expected);
+}
+
+test_case(handle)
+{
+    unique_component_pool<thing_id, mock_component> p;
+
+    thing_id recycled(static_cast<int32_t>((1U << entity_slot_bits) | 3U));
+
+    auto &comp = p.emplace(thing_id(3), 5);
+    component_handle<thing_id, mock_component> h(p, thing_id(3));
+    component_handle<thing_id, mock_component> stale_h(p, recycled);
+
+    assert_eq(h.get(), &comp);
+    assert_true(stale_h.get() == nullptr);
+    component_handle<thing_id, mock_component> empty_h;
+    assert_true(empty_h.get() == nullptr);
+
+    p.erase_equal_range(thing_id(3));
+    p.flush_erase_queue();
+    assert_true(h.get() == nullptr);
+
+    p.emplace(recycled, 7);
+    assert_true(h.get() == nullptr);
+    assert_eq(stale_h.get()->value, 7);
+}
+
+test_case(duplicate_component)
+{
+    unique_component_pool<thing_id, mock_component> p;
+
+    p.emplace(thing_id(4), 5);
+
+    assert_throws_logged(p.emplace(thing_id(4), 6));
+    assert_log_message(log_level::error, "entity 4 already owns this component");
+    assert_log_empty();
+}
+
+test_case(stale_entity)
+{
+    unique_component_pool<thing_id, mock_component> p;
+
+    thing_id recycled(static_cast<int32_t>((1U << entity_slot_bits) | 3U));
+    p.emplace(recycled, 5);
+
+    assert_throws_logged(p.emplace(thing_id(3), 8));
+    assert_log_message(log_level::error, "entity 3 is stale");
+    assert_log_empty();
+}
+
+end_suite(unique_component_pool_test);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "model_face.hpp"
+#include "model_mesh_bvh.hpp"
 #include "math/vector.hpp"
 #include <memory>
 #include <vector>
@@ -23,6 +24,7 @@ public:
     std::vector<vector<2>> texture_vertices;
 
     std::vector<model_face> faces;
+    model_mesh_bvh bvh;
 
     std::vector<int> mesh_index_buffer;
 };
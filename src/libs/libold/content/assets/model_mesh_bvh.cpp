@@ -0,0 +1,98 @@
+#include "model_mesh_bvh.hpp"
+#include <algorithm>
+
+namespace {
+    // Depth is bounded by the traversal stack
+    int const max_depth = 30;
+    int const max_leaf_faces = 4;
+
+    gorc::box<3> merge_bounds(gorc::box<3> const &a, gorc::box<3> const &b) {
+        return gorc::make_box(
+            gorc::make_vector(std::min(gorc::get<0>(a.v0), gorc::get<0>(b.v0)),
+                              std::min(gorc::get<1>(a.v0), gorc::get<1>(b.v0)),
+                              std::min(gorc::get<2>(a.v0), gorc::get<2>(b.v0))),
+            gorc::make_vector(std::max(gorc::get<0>(a.v1), gorc::get<0>(b.v1)),
+                              std::max(gorc::get<1>(a.v1), gorc::get<1>(b.v1)),
+                              std::max(gorc::get<2>(a.v1), gorc::get<2>(b.v1))));
+    }
+}
+
+void gorc::content::assets::model_mesh_bvh::build(std::vector<vector<3>> const &vertices,
+                                                  std::vector<model_face> const &faces) {
+    nodes.clear();
+    face_order.clear();
+    face_bounds.clear();
+    face_centers.clear();
+
+    for(size_t i = 0; i < faces.size(); ++i) {
+        auto const &face = faces[i];
+        if(face.vertices.empty()) {
+            continue;
+        }
+
+        auto const &first_vertex = vertices[std::get<0>(face.vertices.front())];
+        auto bounds = make_box(first_vertex, first_vertex);
+        for(auto const &vx : face.vertices) {
+            auto const &v = vertices[std::get<0>(vx)];
+            bounds = merge_bounds(bounds, make_box(v, v));
+        }
+
+        face_order.push_back(static_cast<int>(i));
+        face_bounds.push_back(bounds);
+        face_centers.push_back((bounds.v0 + bounds.v1) * 0.5f);
+    }
+
+    if(!face_order.empty()) {
+        build_node(0, static_cast<int>(face_order.size()), 0);
+    }
+
+    face_bounds.clear();
+    face_bounds.shrink_to_fit();
+    face_centers.clear();
+    face_centers.shrink_to_fit();
+}
+
+void gorc::content::assets::model_mesh_bvh::build_node(int first, int count, int depth) {
+    int index = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+
+    auto bounds = face_bounds[face_order[first]];
+    auto center_bounds = make_box(face_centers[face_order[first]], face_centers[face_order[first]]);
+    for(int i = first + 1; i < first + count; ++i) {
+        int face = face_order[i];
+        bounds = merge_bounds(bounds, face_bounds[face]);
+        center_bounds = merge_bounds(center_bounds,
+                                     make_box(face_centers[face], face_centers[face]));
+    }
+
+    nodes[index].bounds = bounds;
+
+    if(count <= max_leaf_faces || depth >= max_depth) {
+        nodes[index].first = first;
+        nodes[index].count = count;
+        return;
+    }
+
+    // Split at the median face center along the longest axis.
+    auto extent = center_bounds.v1 - center_bounds.v0;
+    size_t axis = 0;
+    for(size_t i = 1; i < 3; ++i) {
+        if(extent.begin()[i] > extent.begin()[axis]) {
+            axis = i;
+        }
+    }
+
+    int half = count / 2;
+    std::nth_element(face_order.begin() + first,
+                     face_order.begin() + first + half,
+                     face_order.begin() + first + count,
+                     [&](int a, int b) {
+                         return face_centers[a].begin()[axis] < face_centers[b].begin()[axis];
+                     });
+
+    build_node(first, half, depth + 1);
+
+    int right = static_cast<int>(nodes.size());
+    build_node(first + half, count - half, depth + 1);
+    nodes[index].first = right;
+}
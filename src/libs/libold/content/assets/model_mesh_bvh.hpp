@@ -0,0 +1,71 @@
+#pragma once
+
+#include "model_face.hpp"
+#include "math/box.hpp"
+#include "math/vector.hpp"
+#include <array>
+#include <vector>
+
+namespace gorc {
+namespace content {
+namespace assets {
+
+// Bounding volume hierarchy over the faces of a model mesh, in mesh space.
+class model_mesh_bvh {
+public:
+    class node {
+    public:
+        box<3> bounds;
+
+        // Leaves list face_order[first, first + count). Interior nodes have no faces; their
+        // children are the following node and the node at first.
+        int first = 0;
+        int count = 0;
+    };
+
+    std::vector<node> nodes;
+    std::vector<int> face_order;
+
+    void build(std::vector<vector<3>> const &vertices, std::vector<model_face> const &faces);
+
+    // Calls fn(face) for each face in a leaf whose bounds satisfy overlaps(bounds).
+    template <typename OverlapP, typename FaceFn>
+    void visit(OverlapP overlaps, FaceFn fn) const {
+        if(nodes.empty()) {
+            return;
+        }
+
+        std::array<int, 64> open_nodes;
+        size_t open_count = 0;
+        open_nodes[open_count++] = 0;
+
+        while(open_count > 0) {
+            int index = open_nodes[--open_count];
+            auto const &current = nodes[index];
+
+            if(!overlaps(current.bounds)) {
+                continue;
+            }
+
+            if(current.count > 0) {
+                for(int i = current.first; i < current.first + current.count; ++i) {
+                    fn(face_order[i]);
+                }
+            }
+            else {
+                open_nodes[open_count++] = current.first;
+                open_nodes[open_count++] = index + 1;
+            }
+        }
+    }
+
+private:
+    std::vector<box<3>> face_bounds;
+    std::vector<vector<3>> face_centers;
+
+    void build_node(int first, int count, int depth);
+};
+
+}
+}
+}
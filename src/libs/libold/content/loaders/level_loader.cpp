@@ -2,6 +2,8 @@
 #include "level_loader.hpp"
 #include "libold/content/assets/level.hpp"
 #include "content/content_manager.hpp"
+#include "io/memory_file.hpp"
+#include "log/log_buffer.hpp"
 #include "libold/content/constants.hpp"
 #include "libold/content/master_colormap.hpp"
 #include "math/vector.hpp"
@@ -576,6 +578,41 @@ void ParseThingsSection(assets::level& lev, text::tokenizer& tok, content_manage
     }
 }
 
+std::vector<std::string> FindCogNames(text::tokenizer& tok) {
+    std::vector<std::string> names;
+
+    text::token t;
+    while(true) {
+        SkipToNextSection(tok);
+        tok.get_token(t);
+
+        if(t.type == text::token_type::end_of_file) {
+            break;
+        }
+        else if(t.type == text::token_type::identifier && boost::iequals(t.value, "cogs")) {
+            tok.assert_identifier("world");
+            tok.assert_identifier("Cogs");
+            tok.get_number<size_t>();
+
+            while(true) {
+                tok.get_token(t);
+                if(t.type == text::token_type::end_of_file ||
+                   (t.type == text::token_type::identifier && boost::iequals(t.value, "end"))) {
+                    break;
+                }
+
+                tok.assert_punctuator(":");
+                names.push_back(tok.get_space_delimited_string());
+                tok.skip_to_next_line();
+            }
+
+            break;
+        }
+    }
+
+    return names;
+}
+
 using LevelSectionParser = std::function<void(assets::level&, text::tokenizer&, content_manager&, service_registry const &)>;
 const std::unordered_map<std::string, LevelSectionParser> LevelSectionParserMap {
     {"jk", ParseJKSection},
@@ -672,3 +709,34 @@ std::unique_ptr<gorc::asset> gorc::content::loaders::level_loader::parse(text::t
 
     return std::unique_ptr<asset>(std::move(lev));
 }
+
+std::unique_ptr<gorc::asset> gorc::content::loaders::level_loader::deserialize(input_stream &file,
+                                                                               content_manager &manager,
+                                                                               asset_id id,
+                                                                               service_registry const &services,
+                                                                               std::string const &name) const {
+    memory_file contents;
+    file.copy_to(contents);
+
+    // Compile the level's scripts on worker threads before parsing. Problems with the level
+    // itself are reported by the full parse below.
+    std::vector<std::string> cog_names;
+    {
+        log_buffer discarded_log;
+        scoped_log_buffer slb(discarded_log);
+
+        try {
+            memory_file::reader scan_contents(contents);
+            text::tokenizer tok(scan_contents);
+            cog_names = FindCogNames(tok);
+        }
+        catch(...) {
+            cog_names.clear();
+        }
+    }
+
+    manager.preload<cog::script>(cog_names);
+
+    memory_file::reader parse_contents(contents);
+    return text_loader::deserialize(parse_contents, manager, id, services, name);
+}
@@ -13,6 +13,12 @@ public:
     virtual std::unique_ptr<asset> parse(text::tokenizer& t, content_manager& manager, service_registry const &) const override;
 
     virtual std::vector<path> const& get_prefixes() const override;
+
+    virtual std::unique_ptr<asset> deserialize(input_stream &,
+                                               content_manager &,
+                                               asset_id,
+                                               service_registry const &,
+                                               std::string const &name) const override;
 };
 
 }
@@ -240,6 +240,8 @@ void PostprocessModel(assets::model& model, content_manager& manager)
             if(mesh.texture_vertices.empty()) {
                 mesh.texture_vertices.push_back(make_vector(0.0f, 0.0f));
             }
+
+            mesh.bvh.build(mesh.vertices, mesh.faces);
         }
     }
 
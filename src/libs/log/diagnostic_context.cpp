@@ -28,3 +28,20 @@ gorc::diagnostic_context::~diagnostic_context()
 {
     get_local<log_frontend>()->release_diagnostic_context(diagnostic_context_handle);
 }
+
+gorc::diagnostic_location_provider::~diagnostic_location_provider()
+{
+    return;
+}
+
+gorc::deferred_diagnostic_context::deferred_diagnostic_context(
+    diagnostic_location_provider const &provider)
+{
+    diagnostic_context_handle =
+        get_local<log_frontend>()->push_deferred_diagnostic_context(provider);
+}
+
+gorc::deferred_diagnostic_context::~deferred_diagnostic_context()
+{
+    get_local<log_frontend>()->release_diagnostic_context(diagnostic_context_handle);
+}
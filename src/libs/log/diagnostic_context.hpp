@@ -1,6 +1,7 @@
 #pragma once
 
 #include "diagnostic_context_location.hpp"
+#include "utility/maybe.hpp"
 #include <cstddef>
 
 namespace gorc {
@@ -24,4 +25,29 @@ namespace gorc {
         diagnostic_context& operator=(diagnostic_context&&) = delete;
     };
 
+    // Supplies the location of a deferred diagnostic context. The location is only requested
+    // when a message is written.
+    class diagnostic_location_provider {
+    public:
+        virtual ~diagnostic_location_provider();
+
+        // Returns nothing when the context does not currently apply. Messages are then
+        // attributed to the enclosing context.
+        virtual maybe<diagnostic_context_location> get_diagnostic_location() const = 0;
+    };
+
+    class [[gnu::unused]] deferred_diagnostic_context {
+    private:
+        size_t diagnostic_context_handle = 0;
+
+    public:
+        explicit deferred_diagnostic_context(diagnostic_location_provider const &provider);
+        ~deferred_diagnostic_context();
+
+        deferred_diagnostic_context(deferred_diagnostic_context const &) = delete;
+        deferred_diagnostic_context(deferred_diagnostic_context&&) = delete;
+        deferred_diagnostic_context& operator=(deferred_diagnostic_context const &) = delete;
+        deferred_diagnostic_context& operator=(deferred_diagnostic_context&&) = delete;
+    };
+
 }
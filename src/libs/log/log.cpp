@@ -5,6 +5,11 @@ void gorc::erase_log_backends()
     get_global<log_midend>()->erase_log_backends();
 }
 
+bool gorc::is_log_level_enabled(log_level level)
+{
+    return get_local<log_frontend>()->is_log_level_enabled(level);
+}
+
 void gorc::write_log_message(char const *file,
                              int line,
                              log_level level,
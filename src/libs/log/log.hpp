@@ -23,6 +23,9 @@ namespace gorc {
 
     void erase_log_backends();
 
+    // Messages that are expensive to format may be skipped when nothing would receive them.
+    bool is_log_level_enabled(log_level level);
+
     void write_log_message(char const *file,
                            int line,
                            log_level level,
@@ -0,0 +1,33 @@
+#include "log_buffer.hpp"
+#include "log_frontend.hpp"
+#include "log_midend.hpp"
+
+bool gorc::log_buffer::empty() const
+{
+    return messages.empty();
+}
+
+void gorc::log_buffer::flush()
+{
+    auto midend = get_global<log_midend>();
+    for(auto const &msg : messages) {
+        midend->write_log_message(std::get<0>(msg),
+                                  std::get<1>(msg),
+                                  std::get<2>(msg),
+                                  std::get<3>(msg));
+    }
+
+    messages.clear();
+}
+
+gorc::scoped_log_buffer::scoped_log_buffer(log_buffer &buffer)
+{
+    auto frontend = get_local<log_frontend>();
+    previous_buffer = frontend->buffer;
+    frontend->buffer = &buffer;
+}
+
+gorc::scoped_log_buffer::~scoped_log_buffer()
+{
+    get_local<log_frontend>()->buffer = previous_buffer;
+}
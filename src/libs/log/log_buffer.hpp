@@ -0,0 +1,36 @@
+#pragma once
+
+#include "log_level.hpp"
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace gorc {
+
+    // Holds messages logged by a thread while a scoped_log_buffer is active. Buffered
+    // messages are sent to the log backends when the buffer is flushed.
+    class log_buffer {
+        friend class log_frontend;
+    private:
+        std::vector<std::tuple<std::string, int, log_level, std::string>> messages;
+
+    public:
+        bool empty() const;
+        void flush();
+    };
+
+    class [[gnu::unused]] scoped_log_buffer {
+    private:
+        log_buffer *previous_buffer;
+
+    public:
+        explicit scoped_log_buffer(log_buffer &);
+        ~scoped_log_buffer();
+
+        scoped_log_buffer(scoped_log_buffer const &) = delete;
+        scoped_log_buffer(scoped_log_buffer&&) = delete;
+        scoped_log_buffer& operator=(scoped_log_buffer const &) = delete;
+        scoped_log_buffer& operator=(scoped_log_buffer&&) = delete;
+    };
+
+}
@@ -23,16 +23,55 @@ gorc::log_frontend::log_frontend()
     return;
 }
 
+gorc::maybe<gorc::log_frontend::diagnostic_context_frame>
+    gorc::log_frontend::get_current_frame(size_t end) const
+{
+    for(size_t i = end; i > 0; --i) {
+        auto const &frame = diagnostic_context[i - 1];
+        if(!frame.provider) {
+            return frame;
+        }
+
+        auto loc = frame.provider->get_diagnostic_location();
+        if(!loc.has_value()) {
+            continue;
+        }
+
+        auto const &l = loc.get_value();
+        diagnostic_context_frame rv(
+            l.filename, l.first_line, l.first_col, l.last_line, l.last_col, i - 1);
+
+        // Resolved frames inherit a missing filename, as pushed frames do
+        if(!l.filename.has_value()) {
+            maybe_if(get_current_frame(i - 1), [&](diagnostic_context_frame const &below) {
+                rv.filename = below.filename;
+                rv.error_count_index = below.error_count_index;
+            });
+        }
+
+        return rv;
+    }
+
+    return nothing;
+}
+
+gorc::maybe<gorc::log_frontend::diagnostic_context_frame>
+    gorc::log_frontend::get_current_frame() const
+{
+    return get_current_frame(diagnostic_context.size());
+}
+
 void gorc::log_frontend::update_diagnostic_preamble()
 {
     diagnostic_preamble_dirty = false;
 
-    if(diagnostic_context.empty()) {
+    auto current_frame = get_current_frame();
+    if(!current_frame.has_value()) {
         computed_diagnostic_preamble.clear();
         return;
     }
 
-    auto const &context = diagnostic_context.back();
+    auto const &context = current_frame.get_value();
 
     std::stringstream ss;
     ss << gorc::maybe_if(context.filename, "<BUFFER>", [](char const *p) { return p; });
@@ -61,18 +100,39 @@ void gorc::log_frontend::write_log_message(std::string const &filename,
                                            log_level level,
                                            std::string const &message)
 {
-    if((level == log_level::error) &&
-       !diagnostic_context.empty()) {
-        ++diagnostic_context[diagnostic_context.back().error_count_index].internal_error_count;
+    if(level == log_level::error || level == log_level::warning) {
+        maybe_if(get_current_frame(), [&](diagnostic_context_frame const &frame) {
+            auto &counted_frame = diagnostic_context[frame.error_count_index];
+            if(level == log_level::error) {
+                ++counted_frame.internal_error_count;
+            }
+            else {
+                ++counted_frame.internal_warning_count;
+            }
+        });
     }
 
-    if(diagnostic_preamble_dirty) {
+    // Deferred frames may resolve differently for every message
+    if(diagnostic_preamble_dirty || deferred_frame_count > 0) {
         update_diagnostic_preamble();
     }
 
+    if(buffer) {
+        buffer->messages.emplace_back(filename,
+                                      line_number,
+                                      level,
+                                      computed_diagnostic_preamble + message);
+        return;
+    }
+
     midend->write_log_message(filename, line_number, level, computed_diagnostic_preamble + message);
 }
 
+bool gorc::log_frontend::is_log_level_enabled(log_level level) const
+{
+    return buffer || midend->is_log_level_enabled(level);
+}
+
 size_t gorc::log_frontend::push_diagnostic_context(maybe<char const *> filename,
                                                    int first_line,
                                                    int first_col,
@@ -82,10 +142,11 @@ size_t gorc::log_frontend::push_diagnostic_context(maybe<char const *> filename,
     size_t next_element = diagnostic_context.size();
 
     size_t error_count_index = next_element;
-    if(!filename.has_value() &&
-       !diagnostic_context.empty()) {
-        filename = diagnostic_context.back().filename;
-        error_count_index = diagnostic_context.back().error_count_index;
+    if(!filename.has_value()) {
+        maybe_if(get_current_frame(), [&](diagnostic_context_frame const &frame) {
+            filename = frame.filename;
+            error_count_index = frame.error_count_index;
+        });
     }
 
     diagnostic_context.emplace_back(filename,
@@ -99,6 +160,20 @@ size_t gorc::log_frontend::push_diagnostic_context(maybe<char const *> filename,
     return next_element;
 }
 
+size_t gorc::log_frontend::push_deferred_diagnostic_context(
+    diagnostic_location_provider const &provider)
+{
+    size_t next_element = diagnostic_context.size();
+
+    diagnostic_context.emplace_back(nothing, 0, 0, 0, 0, next_element);
+    diagnostic_context.back().provider = &provider;
+    ++deferred_frame_count;
+
+    diagnostic_preamble_dirty = true;
+
+    return next_element;
+}
+
 void gorc::log_frontend::release_diagnostic_context(size_t index)
 {
     if(index < diagnostic_context.size()) {
@@ -107,6 +182,10 @@ void gorc::log_frontend::release_diagnostic_context(size_t index)
 
     while(!diagnostic_context.empty() &&
           !diagnostic_context.back().referenced) {
+        if(diagnostic_context.back().provider) {
+            --deferred_frame_count;
+        }
+
         diagnostic_context.pop_back();
     }
 
@@ -115,21 +194,26 @@ void gorc::log_frontend::release_diagnostic_context(size_t index)
 
 int gorc::log_frontend::diagnostic_file_error_count() const
 {
-    if(!diagnostic_context.empty()) {
-        return diagnostic_context[diagnostic_context.back().error_count_index].internal_error_count;
-    }
+    auto current_frame = get_current_frame();
+    return maybe_if(current_frame, 0, [&](diagnostic_context_frame const &frame) {
+        return diagnostic_context[frame.error_count_index].internal_error_count;
+    });
+}
 
-    return 0;
+int gorc::log_frontend::diagnostic_file_warning_count() const
+{
+    auto current_frame = get_current_frame();
+    return maybe_if(current_frame, 0, [&](diagnostic_context_frame const &frame) {
+        return diagnostic_context[frame.error_count_index].internal_warning_count;
+    });
 }
 
 std::string gorc::log_frontend::diagnostic_file_name() const
 {
-    if(diagnostic_context.empty()) {
-        return "";
-    }
-
-    auto const &context = diagnostic_context.back();
-    return gorc::maybe_value(context.filename, "<BUFFER>");
+    auto current_frame = get_current_frame();
+    return maybe_if(current_frame, std::string(), [](diagnostic_context_frame const &frame) {
+        return std::string(gorc::maybe_value(frame.filename, "<BUFFER>"));
+    });
 }
 
 int gorc::diagnostic_file_error_count()
@@ -137,6 +221,11 @@ int gorc::diagnostic_file_error_count()
     return get_local<log_frontend>()->diagnostic_file_error_count();
 }
 
+int gorc::diagnostic_file_warning_count()
+{
+    return get_local<log_frontend>()->diagnostic_file_warning_count();
+}
+
 std::string gorc::diagnostic_file_name()
 {
     return get_local<log_frontend>()->diagnostic_file_name();
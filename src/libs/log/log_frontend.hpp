@@ -4,6 +4,7 @@
 #include "utility/local.hpp"
 #include "log_level.hpp"
 #include "diagnostic_context.hpp"
+#include "log_buffer.hpp"
 #include "utility/maybe.hpp"
 #include <memory>
 #include <stack>
@@ -13,6 +14,8 @@ namespace gorc {
     class log_frontend : public local {
         template <typename LocalT> friend class local_factory;
         friend class diagnostic_context;
+        friend class deferred_diagnostic_context;
+        friend class scoped_log_buffer;
     private:
         class diagnostic_context_frame {
         public:
@@ -23,8 +26,12 @@ namespace gorc {
             int last_line;
             int last_col;
             int internal_error_count = 0;
+            int internal_warning_count = 0;
             size_t error_count_index;
 
+            // Deferred frames take their location from the provider when it is needed
+            diagnostic_location_provider const *provider = nullptr;
+
             diagnostic_context_frame(maybe<char const *> filename,
                                      int first_line,
                                      int first_col,
@@ -35,19 +42,28 @@ namespace gorc {
 
         std::shared_ptr<log_midend> midend;
         std::vector<diagnostic_context_frame> diagnostic_context;
+        size_t deferred_frame_count = 0;
         bool diagnostic_preamble_dirty = false;
         std::string computed_diagnostic_preamble;
+        log_buffer *buffer = nullptr;
 
         log_frontend();
 
         void update_diagnostic_preamble();
 
+        // Returns the innermost applicable frame below index end, with deferred frames
+        // resolved.
+        maybe<diagnostic_context_frame> get_current_frame(size_t end) const;
+        maybe<diagnostic_context_frame> get_current_frame() const;
+
         size_t push_diagnostic_context(maybe<char const *> filename,
                                        int first_line,
                                        int first_col,
                                        int last_line,
                                        int last_col);
 
+        size_t push_deferred_diagnostic_context(diagnostic_location_provider const &provider);
+
         void release_diagnostic_context(size_t index);
 
     public:
@@ -56,10 +72,15 @@ namespace gorc {
                                log_level level,
                                std::string const &message);
 
+        // Returns false if messages at this level would be discarded
+        bool is_log_level_enabled(log_level level) const;
+
         int diagnostic_file_error_count() const;
+        int diagnostic_file_warning_count() const;
         std::string diagnostic_file_name() const;
     };
 
     int diagnostic_file_error_count();
+    int diagnostic_file_warning_count();
     std::string diagnostic_file_name();
 }
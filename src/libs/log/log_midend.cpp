@@ -18,6 +18,19 @@ void gorc::log_midend::erase_log_backends()
     log_backends.clear();
 }
 
+bool gorc::log_midend::is_log_level_enabled(log_level level)
+{
+    std::lock_guard<std::mutex> lock(log_backend_lock);
+
+    for(auto const &b : log_backends) {
+        if(std::get<0>(b) & level) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void gorc::log_midend::write_log_message(std::string const &filename,
                                          int line_number,
                                          log_level level,
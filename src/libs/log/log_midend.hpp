@@ -22,6 +22,8 @@ namespace gorc {
         void insert_log_backend(flag_set<log_level>, std::unique_ptr<log_backend>&&);
         void erase_log_backends();
 
+        bool is_log_level_enabled(log_level level);
+
         void write_log_message(std::string const &filename,
                                int line_number,
                                log_level level,
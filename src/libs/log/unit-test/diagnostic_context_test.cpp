@@ -4,6 +4,18 @@
 
 using namespace gorc;
 
+namespace {
+    class mock_location_provider : public gorc::diagnostic_location_provider {
+    public:
+        maybe<diagnostic_context_location> location;
+
+        virtual maybe<diagnostic_context_location> get_diagnostic_location() const override
+        {
+            return location;
+        }
+    };
+}
+
 begin_suite(diagnostic_context_test);
 
 test_case(filename_only)
@@ -179,6 +191,27 @@ test_case(error_count_includes_errors_only)
     assert_eq(gorc::diagnostic_file_error_count(), 1);
 }
 
+test_case(warning_count_includes_warnings_only)
+{
+    gorc::diagnostic_context dc(gorc::nothing);
+
+    LOG_TRACE("foo");
+    LOG_DEBUG("foo");
+    LOG_INFO("foo");
+    LOG_ERROR("foo");
+
+    assert_eq(gorc::diagnostic_file_warning_count(), 0);
+
+    LOG_WARNING("foo");
+
+    do {
+        gorc::diagnostic_context dd(gorc::nothing, 5, 10);
+        LOG_WARNING("bar");
+    } while(false);
+
+    assert_eq(gorc::diagnostic_file_warning_count(), 2);
+}
+
 test_case(error_count_excludes_child)
 {
     gorc::diagnostic_context dc("foo");
@@ -303,4 +336,61 @@ test_case(diagnostic_file_name_nested)
     assert_eq(gorc::diagnostic_file_name(), std::string("foobarbaz"));
 }
 
+test_case(deferred_context_resolved_when_written)
+{
+    mock_location_provider provider;
+
+    diagnostic_context dc("foo");
+    deferred_diagnostic_context ddc(provider);
+
+    LOG_ERROR("first message");
+
+    provider.location = diagnostic_context_location("bar", 5, 7);
+    LOG_ERROR("second message");
+
+    provider.location = nothing;
+    LOG_ERROR("third message");
+
+    assert_log_message(gorc::log_level::error, "foo: first message");
+    assert_log_message(gorc::log_level::error, "bar:5:7: second message");
+    assert_log_message(gorc::log_level::error, "foo: third message");
+    assert_log_empty();
+}
+
+test_case(deferred_context_inherits_filename)
+{
+    mock_location_provider provider;
+    provider.location = diagnostic_context_location(nothing, 5, 7);
+
+    diagnostic_context dc("foo");
+    deferred_diagnostic_context ddc(provider);
+
+    LOG_ERROR("some message");
+
+    assert_log_message(gorc::log_level::error, "foo:5:7: some message");
+    assert_log_empty();
+    assert_eq(gorc::diagnostic_file_error_count(), 1);
+}
+
+test_case(deferred_context_error_count_excludes_child)
+{
+    mock_location_provider provider;
+
+    diagnostic_context dc("foo");
+    deferred_diagnostic_context ddc(provider);
+
+    LOG_ERROR("foo");
+    assert_eq(gorc::diagnostic_file_error_count(), 1);
+
+    provider.location = diagnostic_context_location("bar", 5, 7);
+    assert_eq(gorc::diagnostic_file_error_count(), 0);
+    LOG_ERROR("bar");
+    assert_eq(gorc::diagnostic_file_error_count(), 1);
+    assert_eq(gorc::diagnostic_file_name(), std::string("bar"));
+
+    provider.location = nothing;
+    assert_eq(gorc::diagnostic_file_error_count(), 1);
+    assert_eq(gorc::diagnostic_file_name(), std::string("foo"));
+}
+
 end_suite(diagnostic_context_test);
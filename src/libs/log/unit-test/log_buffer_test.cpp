@@ -0,0 +1,65 @@
+#include "test/test.hpp"
+#include "log/log.hpp"
+#include "log/log_buffer.hpp"
+#include <thread>
+
+using namespace gorc;
+
+begin_suite(log_buffer_test);
+
+test_case(messages_held_until_flush)
+{
+    log_buffer buffer;
+
+    {
+        scoped_log_buffer slb(buffer);
+        char const *p("/usr/local/bin/foo.bar");
+        gorc::diagnostic_context dc(p, 5);
+
+        LOG_ERROR("buffered");
+    }
+
+    LOG_ERROR("unbuffered");
+
+    assert_true(!buffer.empty());
+    buffer.flush();
+    assert_true(buffer.empty());
+
+    assert_log_message(gorc::log_level::error, "unbuffered");
+    assert_log_message(gorc::log_level::error, "/usr/local/bin/foo.bar:5: buffered");
+    assert_log_empty();
+}
+
+test_case(buffered_messages_counted)
+{
+    log_buffer buffer;
+    scoped_log_buffer slb(buffer);
+    gorc::diagnostic_context dc(gorc::nothing);
+
+    LOG_ERROR("foo");
+    LOG_WARNING("bar");
+
+    assert_eq(gorc::diagnostic_file_error_count(), 1);
+    assert_eq(gorc::diagnostic_file_warning_count(), 1);
+}
+
+test_case(buffers_are_per_thread)
+{
+    log_buffer buffer;
+    scoped_log_buffer slb(buffer);
+
+    std::thread th([]() { LOG_ERROR("other thread"); });
+    th.join();
+
+    LOG_ERROR("this thread");
+
+    assert_log_message(gorc::log_level::error, "other thread");
+    assert_log_empty();
+
+    buffer.flush();
+
+    assert_log_message(gorc::log_level::error, "this thread");
+    assert_log_empty();
+}
+
+end_suite(log_buffer_test);
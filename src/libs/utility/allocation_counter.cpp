@@ -0,0 +1,34 @@
+#include "allocation_counter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<size_t> allocation_count(0);
+}
+
+size_t gorc::get_allocation_count()
+{
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+void *operator new(size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    void *rv = std::malloc(size ? size : 1);
+    if(!rv) {
+        throw std::bad_alloc();
+    }
+
+    return rv;
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+namespace gorc {
+
+    // Returns the number of heap allocations made by the program so far.
+    //
+    // Only available to programs linking allocation-counter, which replaces the global
+    // operator new with a counting version.
+    size_t get_allocation_count();
+
+}
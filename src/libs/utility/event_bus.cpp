@@ -1,4 +1,5 @@
 #include "event_bus.hpp"
+#include <atomic>
 
 gorc::abstract_delegate_container::~abstract_delegate_container()
 {
@@ -7,11 +8,11 @@ gorc::abstract_delegate_container::~abstract_delegate_container()
 
 gorc::scoped_delegate::scoped_delegate(abstract_delegate_container *observer,
                                        size_t id,
-                                       bool is_const)
+                                       event_handler_kind kind)
     : should_unregister(true)
     , observer(observer)
     , id(id)
-    , is_const(is_const)
+    , kind(kind)
 {
     return;
 }
@@ -20,7 +21,7 @@ void gorc::scoped_delegate::unregister()
 {
     if(should_unregister) {
         should_unregister = false;
-        observer->unregister(id, is_const);
+        observer->unregister(id, kind);
     }
 }
 
@@ -28,7 +29,7 @@ gorc::scoped_delegate::scoped_delegate(scoped_delegate &&other)
     : should_unregister(true)
     , observer(other.observer)
     , id(other.id)
-    , is_const(other.is_const)
+    , kind(other.kind)
 {
     other.should_unregister = false;
     return;
@@ -46,7 +47,60 @@ gorc::scoped_delegate& gorc::scoped_delegate::operator=(scoped_delegate &&other)
     should_unregister = other.should_unregister;
     observer = other.observer;
     id = other.id;
-    is_const = other.is_const;
+    kind = other.kind;
     other.should_unregister = false;
     return *this;
 }
+
+thread_local gorc::deferred_event_queue *gorc::detail::current_deferred_event_queue = nullptr;
+
+gorc::deferred_event_scope::deferred_event_scope(deferred_event_queue &queue)
+    : previous_queue(detail::current_deferred_event_queue)
+{
+    detail::current_deferred_event_queue = &queue;
+    return;
+}
+
+gorc::deferred_event_scope::~deferred_event_scope()
+{
+    detail::current_deferred_event_queue = previous_queue;
+    return;
+}
+
+void gorc::dispatch_deferred_events(deferred_event_queue &queue)
+{
+    for(size_t i = 0; i < queue.size(); ++i) {
+        queue[i]();
+    }
+
+    queue.clear();
+}
+
+size_t gorc::detail::next_event_type_index()
+{
+    static std::atomic<size_t> next_index(0);
+    return next_index++;
+}
+
+void gorc::event_bus::dispatch_queued_events()
+{
+    if(detail::current_deferred_event_queue) {
+        detail::current_deferred_event_queue->push_back([this] { dispatch_queued_events(); });
+        return;
+    }
+
+    if(dispatching_queued_events) {
+        // Events queued by the caller are dispatched by the outer call
+        return;
+    }
+
+    auto dispatching_guard = make_scoped_assignment(dispatching_queued_events, true);
+    while(!queued_event_types.empty()) {
+        std::swap(queued_event_types, dispatching_event_types);
+        for(size_t type : dispatching_event_types) {
+            handlers[type]->dispatch_queued_events();
+        }
+
+        dispatching_event_types.clear();
+    }
+}
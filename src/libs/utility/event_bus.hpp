@@ -1,22 +1,29 @@
 #pragma once
 
-#include <typeindex>
-#include <unordered_map>
-#include <functional>
+#include <deque>
 #include <vector>
 #include <memory>
 #include <type_traits>
+#include <typeinfo>
 #include <stdexcept>
-#include "maybe.hpp"
+#include "inline_function.hpp"
 #include "scoped_assignment.hpp"
+#include "span.hpp"
 #include "strcat.hpp"
 
 namespace gorc {
 
+    enum class event_handler_kind {
+        mutable_handler,
+        const_handler,
+        batch_handler
+    };
+
     class abstract_delegate_container {
     public:
         virtual ~abstract_delegate_container();
-        virtual void unregister(size_t id, bool is_const) = 0;
+        virtual void unregister(size_t id, event_handler_kind kind) = 0;
+        virtual void dispatch_queued_events() = 0;
     };
 
     class scoped_delegate {
@@ -24,12 +31,12 @@ namespace gorc {
         bool should_unregister;
         abstract_delegate_container *observer;
         size_t id;
-        bool is_const;
+        event_handler_kind kind;
 
         void unregister();
 
     public:
-        scoped_delegate(abstract_delegate_container *, size_t, bool);
+        scoped_delegate(abstract_delegate_container *, size_t, event_handler_kind);
         scoped_delegate(scoped_delegate const &) = delete;
         scoped_delegate(scoped_delegate &&);
         ~scoped_delegate();
@@ -38,81 +45,181 @@ namespace gorc {
         scoped_delegate& operator=(scoped_delegate&&);
     };
 
+    // Events fired while deferred are queued as calls which fire them later. Each call holds
+    // its event inline, so that deferring typical events does not allocate.
+    using deferred_event_queue = std::vector<inline_function<void(), 8 * sizeof(void*)>>;
+
+    namespace detail {
+        extern thread_local deferred_event_queue *current_deferred_event_queue;
+
+        size_t next_event_type_index();
+
+        // Event types are numbered densely on first use, and index the handler table
+        template <typename T>
+        size_t event_type_index()
+        {
+            static size_t const index = next_event_type_index();
+            return index;
+        }
+
+        // Handlers which accept a constant event are const handlers
+        template <typename FnT, typename T, typename = void>
+        struct is_const_event_handler : std::false_type { };
+
+        template <typename FnT, typename T>
+        struct is_const_event_handler<
+            FnT,
+            T,
+            decltype((void) std::declval<typename std::decay<FnT>::type &>()(
+                         std::declval<T const &>()))>
+            : std::true_type { };
+    }
+
+    // Queues the events fired on the calling thread, on any event bus, while the scope is
+    // active. The queued events are fired by dispatch_deferred_events.
+    class deferred_event_scope {
+    private:
+        deferred_event_queue *previous_queue;
+
+    public:
+        explicit deferred_event_scope(deferred_event_queue &queue);
+        ~deferred_event_scope();
+
+        deferred_event_scope(deferred_event_scope const &) = delete;
+        deferred_event_scope& operator=(deferred_event_scope const &) = delete;
+    };
+
+    void dispatch_deferred_events(deferred_event_queue &queue);
+
     class event_bus {
     private:
         template <typename T>
         class delegate_container : public abstract_delegate_container {
         private:
+            using HandlerT = inline_function<void(T&)>;
+            using ConstHandlerT = inline_function<void(T const &)>;
+            using BatchHandlerT = inline_function<void(span<T const>)>;
+
             bool caller_inside = false;
-            std::vector<maybe<std::function<void(T&)>>> handlers;
-            std::vector<maybe<std::function<void(T const &)>>> const_handlers;
+
+            // Deques keep handlers in place while handlers registered during dispatch are added
+            std::deque<HandlerT> handlers;
+            std::deque<ConstHandlerT> const_handlers;
+            std::deque<BatchHandlerT> batch_handlers;
+
+            std::vector<T> queued_events;
+            std::vector<T> dispatching_events;
 
             template <typename FnT, typename FnVecT>
-            scoped_delegate insert_internal(FnT fn, FnVecT &vec, bool is_const)
+            scoped_delegate insert_internal(FnT &&fn, FnVecT &vec, event_handler_kind kind)
             {
                 if(!caller_inside) {
                     // Use space-efficient, non-reentrant registration
                     for(size_t i = 0; i < vec.size(); ++i) {
                         auto &em = vec[i];
-                        if(!em.has_value()) {
-                            em = fn;
-                            return scoped_delegate(this, i, is_const);
+                        if(!em) {
+                            em = std::forward<FnT>(fn);
+                            return scoped_delegate(this, i, kind);
                         }
                     }
                 }
 
                 // Fall back to space-inefficient but reentrant registration
                 size_t next_id = vec.size();
-                vec.push_back(fn);
-                return scoped_delegate(this, next_id, is_const);
+                vec.emplace_back(std::forward<FnT>(fn));
+                return scoped_delegate(this, next_id, kind);
             }
 
-        public:
-            virtual void unregister(size_t id, bool is_const) override
+            template <typename FnVecT>
+            void unregister_internal(size_t id, FnVecT &vec)
             {
-                if(is_const) {
-                    if(id < const_handlers.size()) {
-                        const_handlers[id] = nothing;
-                    }
+                if(id < vec.size()) {
+                    vec[id].reset();
                 }
-                else {
-                    if(id < handlers.size()) {
-                        handlers[id] = nothing;
+            }
+
+            void dispatch_to_handlers(T &event)
+            {
+                // Dispatch to normal handlers
+                for(size_t i = 0; i < handlers.size(); ++i) {
+                    auto &handler = handlers[i];
+                    if(handler) {
+                        handler(event);
                     }
                 }
+
+                dispatch_to_const_handlers(event);
             }
 
-            scoped_delegate insert(std::function<void(T&)> fn)
+            void dispatch_to_const_handlers(T const &event)
             {
-                return insert_internal(fn, handlers, false);
+                for(size_t i = 0; i < const_handlers.size(); ++i) {
+                    auto &handler = const_handlers[i];
+                    if(handler) {
+                        handler(event);
+                    }
+                }
             }
 
-            scoped_delegate insert(std::function<void(T const &)> fn)
+            void dispatch_to_batch_handlers(span<T const> events)
             {
-                return insert_internal(fn, const_handlers, true);
+                for(size_t i = 0; i < batch_handlers.size(); ++i) {
+                    auto &handler = batch_handlers[i];
+                    if(handler) {
+                        handler(events);
+                    }
+                }
             }
 
-            void dispatch_event(T &event)
+        public:
+            virtual void unregister(size_t id, event_handler_kind kind) override
             {
-                auto caller_inside_guard = make_scoped_assignment(caller_inside, true);
+                switch(kind) {
+                case event_handler_kind::mutable_handler:
+                    unregister_internal(id, handlers);
+                    break;
 
-                // Dispatch to normal handlers
-                for(size_t i = 0; i < handlers.size(); ++i) {
-                    auto &handler = handlers[i];
-                    if(handler.has_value()) {
-                        handler.get_value()(event);
-                    }
-                }
+                case event_handler_kind::const_handler:
+                    unregister_internal(id, const_handlers);
+                    break;
 
-                // Dispatch to const handlers
-                for(size_t i = 0; i < const_handlers.size(); ++i) {
-                    auto &handler = const_handlers[i];
-                    if(handler.has_value()) {
-                        handler.get_value()(event);
-                    }
+                case event_handler_kind::batch_handler:
+                    unregister_internal(id, batch_handlers);
+                    break;
                 }
             }
 
+            template <typename FnT>
+            scoped_delegate insert(FnT &&fn, std::false_type /* is const */)
+            {
+                return insert_internal(std::forward<FnT>(fn),
+                                       handlers,
+                                       event_handler_kind::mutable_handler);
+            }
+
+            template <typename FnT>
+            scoped_delegate insert(FnT &&fn, std::true_type /* is const */)
+            {
+                return insert_internal(std::forward<FnT>(fn),
+                                       const_handlers,
+                                       event_handler_kind::const_handler);
+            }
+
+            template <typename FnT>
+            scoped_delegate insert_batch(FnT &&fn)
+            {
+                return insert_internal(std::forward<FnT>(fn),
+                                       batch_handlers,
+                                       event_handler_kind::batch_handler);
+            }
+
+            void dispatch_event(T &event)
+            {
+                auto caller_inside_guard = make_scoped_assignment(caller_inside, true);
+                dispatch_to_handlers(event);
+                dispatch_to_batch_handlers(span<T const>(&event, 1));
+            }
+
             void dispatch_event(T const &event)
             {
                 if(!handlers.empty()) {
@@ -122,53 +229,124 @@ namespace gorc {
                 }
 
                 auto caller_inside_guard = make_scoped_assignment(caller_inside, true);
+                dispatch_to_const_handlers(event);
+                dispatch_to_batch_handlers(span<T const>(&event, 1));
+            }
 
-                for(size_t i = 0; i < const_handlers.size(); ++i) {
-                    auto &handler = const_handlers[i];
-                    if(handler.has_value()) {
-                        handler.get_value()(event);
+            // Returns true when no other events were queued since the last dispatch
+            bool queue_event(T const &event)
+            {
+                queued_events.push_back(event);
+                return queued_events.size() == 1;
+            }
+
+            virtual void dispatch_queued_events() override
+            {
+                // Events queued by handlers are kept for the next dispatch
+                std::swap(queued_events, dispatching_events);
+
+                {
+                    auto caller_inside_guard = make_scoped_assignment(caller_inside, true);
+
+                    for(auto &event : dispatching_events) {
+                        dispatch_to_handlers(event);
                     }
+
+                    dispatch_to_batch_handlers(span<T const>(dispatching_events.data(),
+                                                             dispatching_events.size()));
                 }
+
+                // Keep the capacity for the next dispatch
+                dispatching_events.clear();
             }
         };
 
-        std::unordered_map<std::type_index, std::unique_ptr<abstract_delegate_container>> handlers;
+        std::vector<std::unique_ptr<abstract_delegate_container>> handlers;
+
+        // Types of queued events, in the order their first event was queued
+        std::vector<size_t> queued_event_types;
+        std::vector<size_t> dispatching_event_types;
+        bool dispatching_queued_events = false;
 
         template <typename T, typename RealT = typename std::decay<T>::type>
         delegate_container<RealT>& get_handler()
         {
-            auto it = handlers.find(typeid(RealT));
-            if(it == handlers.end()) {
-                it = handlers.emplace(typeid(RealT),
-                                      std::make_unique<delegate_container<RealT>>()).first;
+            size_t index = detail::event_type_index<RealT>();
+            if(index >= handlers.size()) {
+                handlers.resize(index + 1);
+            }
+
+            auto &container = handlers[index];
+            if(!container) {
+                container = std::make_unique<delegate_container<RealT>>();
             }
 
-            return *reinterpret_cast<delegate_container<RealT>*>(it->second.get());
+            return *static_cast<delegate_container<RealT>*>(container.get());
         }
 
     public:
         template <typename T>
         void fire_event(T &event)
         {
+            if(detail::current_deferred_event_queue) {
+                detail::current_deferred_event_queue->push_back([this, event]() mutable {
+                        fire_event(event);
+                    });
+                return;
+            }
+
             get_handler<T>().dispatch_event(event);
         }
 
         template <typename T>
         void fire_event(T const &event)
         {
+            if(detail::current_deferred_event_queue) {
+                detail::current_deferred_event_queue->push_back([this, event]() {
+                        fire_event(event);
+                    });
+                return;
+            }
+
             get_handler<T>().dispatch_event(event);
         }
 
+        // Stores a copy of the event until dispatch_queued_events is called. Handlers
+        // registered with add_batch_handler receive all queued events of a type at once.
         template <typename T>
-        scoped_delegate add_handler(std::function<void(T&)> handler)
+        void queue_event(T const &event)
+        {
+            if(detail::current_deferred_event_queue) {
+                detail::current_deferred_event_queue->push_back([this, event]() {
+                        queue_event(event);
+                    });
+                return;
+            }
+
+            using RealT = typename std::decay<T>::type;
+            if(get_handler<RealT>().queue_event(event)) {
+                queued_event_types.push_back(detail::event_type_index<RealT>());
+            }
+        }
+
+        // Dispatches queued events by type, in the order each type was first queued. Events
+        // queued by handlers are dispatched before returning.
+        void dispatch_queued_events();
+
+        // Handlers accepting T const & are called after handlers accepting T &, and may
+        // receive constant events
+        template <typename T, typename FnT>
+        scoped_delegate add_handler(FnT &&handler)
         {
-            return get_handler<T>().insert(handler);
+            return get_handler<T>().insert(std::forward<FnT>(handler),
+                                           detail::is_const_event_handler<FnT, T>());
         }
 
-        template <typename T>
-        scoped_delegate add_handler(std::function<void(T const &)> handler)
+        // Batch handlers accept span<T const>, and are called after the other handlers
+        template <typename T, typename FnT>
+        scoped_delegate add_batch_handler(FnT &&handler)
         {
-            return get_handler<T>().insert(handler);
+            return get_handler<T>().insert_batch(std::forward<FnT>(handler));
         }
     };
 
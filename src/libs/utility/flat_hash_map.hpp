@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace gorc {
+
+    // Open addressing hash map with linear probing. Elements are stored inline in a single
+    // slot array, so lookups do not chase pointers. Insertion and erasure invalidate all
+    // iterators and references.
+    template <typename KeyT,
+              typename ValueT,
+              typename HashT = std::hash<KeyT>,
+              typename EqualT = std::equal_to<KeyT>>
+    class flat_hash_map {
+    public:
+        using value_type = std::pair<KeyT, ValueT>;
+
+    private:
+        class slot {
+        public:
+            bool occupied = false;
+            value_type element;
+        };
+
+        std::vector<slot> slots;
+        size_t element_count = 0;
+        int capacity_bits = 0;
+
+        HashT hasher;
+        EqualT equal;
+
+        size_t get_home(KeyT const &key) const
+        {
+            // Fibonacci hashing spreads weak hashes (e.g. identity) over the whole table
+            uint64_t h = static_cast<uint64_t>(hasher(key)) * 11400714819323198485ULL;
+            return static_cast<size_t>(h >> (64 - capacity_bits));
+        }
+
+        size_t get_mask() const
+        {
+            return slots.size() - 1;
+        }
+
+        size_t find_slot(KeyT const &key) const
+        {
+            if(slots.empty()) {
+                return slots.size();
+            }
+
+            for(size_t i = get_home(key);; i = (i + 1) & get_mask()) {
+                auto const &s = slots[i];
+                if(!s.occupied) {
+                    return slots.size();
+                }
+                else if(equal(s.element.first, key)) {
+                    return i;
+                }
+            }
+        }
+
+        void rehash(int new_capacity_bits)
+        {
+            std::vector<slot> old_slots(size_t(1) << new_capacity_bits);
+            std::swap(slots, old_slots);
+            capacity_bits = new_capacity_bits;
+
+            for(auto &s : old_slots) {
+                if(s.occupied) {
+                    size_t i = get_home(s.element.first);
+                    while(slots[i].occupied) {
+                        i = (i + 1) & get_mask();
+                    }
+
+                    slots[i].occupied = true;
+                    slots[i].element = std::move(s.element);
+                }
+            }
+        }
+
+        template <typename SlotT, typename ElementT>
+        class basic_iterator {
+            friend class flat_hash_map;
+
+        private:
+            SlotT *it;
+            SlotT *end;
+
+            basic_iterator(SlotT *it, SlotT *end)
+                : it(it)
+                , end(end)
+            {
+                skip_empty();
+            }
+
+            void skip_empty()
+            {
+                while(it != end && !it->occupied) {
+                    ++it;
+                }
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = ElementT;
+            using difference_type = std::ptrdiff_t;
+            using pointer = ElementT *;
+            using reference = ElementT &;
+
+            reference operator*() const
+            {
+                return it->element;
+            }
+
+            pointer operator->() const
+            {
+                return &it->element;
+            }
+
+            basic_iterator &operator++()
+            {
+                ++it;
+                skip_empty();
+                return *this;
+            }
+
+            basic_iterator operator++(int)
+            {
+                basic_iterator rv = *this;
+                ++(*this);
+                return rv;
+            }
+
+            bool operator==(basic_iterator const &other) const
+            {
+                return it == other.it;
+            }
+
+            bool operator!=(basic_iterator const &other) const
+            {
+                return it != other.it;
+            }
+        };
+
+    public:
+        using iterator = basic_iterator<slot, value_type>;
+        using const_iterator = basic_iterator<slot const, value_type const>;
+
+        iterator begin()
+        {
+            return iterator(slots.data(), slots.data() + slots.size());
+        }
+
+        iterator end()
+        {
+            return iterator(slots.data() + slots.size(), slots.data() + slots.size());
+        }
+
+        const_iterator begin() const
+        {
+            return const_iterator(slots.data(), slots.data() + slots.size());
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(slots.data() + slots.size(), slots.data() + slots.size());
+        }
+
+        size_t size() const
+        {
+            return element_count;
+        }
+
+        bool empty() const
+        {
+            return element_count == 0;
+        }
+
+        void clear()
+        {
+            slots.clear();
+            element_count = 0;
+            capacity_bits = 0;
+        }
+
+        iterator find(KeyT const &key)
+        {
+            return iterator(slots.data() + find_slot(key), slots.data() + slots.size());
+        }
+
+        const_iterator find(KeyT const &key) const
+        {
+            return const_iterator(slots.data() + find_slot(key), slots.data() + slots.size());
+        }
+
+        ValueT &operator[](KeyT const &key)
+        {
+            size_t existing = find_slot(key);
+            if(existing != slots.size()) {
+                return slots[existing].element.second;
+            }
+
+            // Keep the load factor at or below one half
+            if((element_count + 1) * 2 > slots.size()) {
+                rehash(std::max(capacity_bits + 1, 3));
+            }
+
+            size_t i = get_home(key);
+            while(slots[i].occupied) {
+                i = (i + 1) & get_mask();
+            }
+
+            ++element_count;
+            slots[i].occupied = true;
+            slots[i].element = value_type(key, ValueT());
+            return slots[i].element.second;
+        }
+
+        size_t erase(KeyT const &key)
+        {
+            size_t i = find_slot(key);
+            if(i == slots.size()) {
+                return 0;
+            }
+
+            --element_count;
+            slots[i].occupied = false;
+            slots[i].element = value_type();
+
+            // Shift later elements of the probe sequence back into the hole
+            for(size_t j = (i + 1) & get_mask(); slots[j].occupied; j = (j + 1) & get_mask()) {
+                size_t home = get_home(slots[j].element.first);
+
+                bool home_in_range = (i <= j) ? (i < home && home <= j)
+                                              : (i < home || home <= j);
+                if(home_in_range) {
+                    continue;
+                }
+
+                slots[i].occupied = true;
+                slots[i].element = std::move(slots[j].element);
+                slots[j].occupied = false;
+                slots[j].element = value_type();
+                i = j;
+            }
+
+            return 1;
+        }
+    };
+}
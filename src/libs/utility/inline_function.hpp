@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace gorc {
+
+    template <typename SigT, size_t InlineSize = 3 * sizeof(void*)>
+    class inline_function;
+
+    // Move-only function wrapper. Callables no larger than InlineSize are stored inside the
+    // wrapper; larger callables are moved to the heap.
+    template <typename RetT, typename ...ArgT, size_t InlineSize>
+    class inline_function<RetT(ArgT...), InlineSize> {
+    private:
+        using StorageT = typename std::aligned_storage<InlineSize, alignof(void*)>::type;
+
+        class operations {
+        public:
+            RetT (*invoke)(void *, ArgT...);
+            void (*move)(void *dest, void *src);
+            void (*destroy)(void *);
+        };
+
+        template <typename FnT>
+        class inline_operations {
+        public:
+            static FnT& get(void *storage)
+            {
+                return *reinterpret_cast<FnT*>(storage);
+            }
+
+            static RetT invoke(void *storage, ArgT ...args)
+            {
+                return get(storage)(std::forward<ArgT>(args)...);
+            }
+
+            static void move(void *dest, void *src)
+            {
+                new(dest) FnT(std::move(get(src)));
+                get(src).~FnT();
+            }
+
+            static void destroy(void *storage)
+            {
+                get(storage).~FnT();
+            }
+        };
+
+        template <typename FnT>
+        class heap_operations {
+        public:
+            static FnT*& get(void *storage)
+            {
+                return *reinterpret_cast<FnT**>(storage);
+            }
+
+            static RetT invoke(void *storage, ArgT ...args)
+            {
+                return (*get(storage))(std::forward<ArgT>(args)...);
+            }
+
+            static void move(void *dest, void *src)
+            {
+                new(dest) FnT*(get(src));
+            }
+
+            static void destroy(void *storage)
+            {
+                delete get(storage);
+            }
+        };
+
+        template <typename FnT>
+        using fits_inline = std::integral_constant<
+            bool,
+            sizeof(FnT) <= sizeof(StorageT) &&
+                alignof(FnT) <= alignof(StorageT) &&
+                std::is_nothrow_move_constructible<FnT>::value>;
+
+        template <typename OpsT>
+        static operations const* make_operations()
+        {
+            static operations const ops { &OpsT::invoke, &OpsT::move, &OpsT::destroy };
+            return &ops;
+        }
+
+        mutable StorageT storage;
+        operations const *ops = nullptr;
+
+        template <typename FnT>
+        void emplace(FnT &&fn, std::true_type /* fits inline */)
+        {
+            using DecayFnT = typename std::decay<FnT>::type;
+            new(&storage) DecayFnT(std::forward<FnT>(fn));
+            ops = make_operations<inline_operations<DecayFnT>>();
+        }
+
+        template <typename FnT>
+        void emplace(FnT &&fn, std::false_type /* fits inline */)
+        {
+            using DecayFnT = typename std::decay<FnT>::type;
+            new(&storage) DecayFnT*(new DecayFnT(std::forward<FnT>(fn)));
+            ops = make_operations<heap_operations<DecayFnT>>();
+        }
+
+        void take(inline_function &&other)
+        {
+            if(other.ops) {
+                other.ops->move(&storage, &other.storage);
+                ops = other.ops;
+                other.ops = nullptr;
+            }
+        }
+
+    public:
+        inline_function() = default;
+
+        template <typename FnT,
+                  typename = typename std::enable_if<
+                      !std::is_same<typename std::decay<FnT>::type, inline_function>::value>::type>
+        inline_function(FnT &&fn)
+        {
+            emplace(std::forward<FnT>(fn), fits_inline<typename std::decay<FnT>::type>());
+        }
+
+        inline_function(inline_function &&other) noexcept
+        {
+            take(std::move(other));
+        }
+
+        inline_function(inline_function const &) = delete;
+
+        ~inline_function()
+        {
+            reset();
+        }
+
+        inline_function& operator=(inline_function &&other) noexcept
+        {
+            if(this != &other) {
+                reset();
+                take(std::move(other));
+            }
+
+            return *this;
+        }
+
+        inline_function& operator=(inline_function const &) = delete;
+
+        void reset()
+        {
+            if(ops) {
+                ops->destroy(&storage);
+                ops = nullptr;
+            }
+        }
+
+        explicit operator bool() const
+        {
+            return ops != nullptr;
+        }
+
+        RetT operator()(ArgT ...args) const
+        {
+            return ops->invoke(&storage, std::forward<ArgT>(args)...);
+        }
+    };
+
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace gorc {
+
+    // Sequence container with inline storage for the first N elements. Elements are moved to
+    // the heap only when the inline storage is exhausted.
+    template <typename T, size_t N>
+    class small_vector {
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using reference = T &;
+        using const_reference = T const &;
+        using iterator = T *;
+        using const_iterator = T const *;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    private:
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type inline_storage[N];
+        T *elements;
+        size_t element_count = 0;
+        size_t element_capacity = N;
+
+        T *get_inline_storage()
+        {
+            return reinterpret_cast<T *>(inline_storage);
+        }
+
+        bool is_inline() const
+        {
+            return elements == reinterpret_cast<T const *>(inline_storage);
+        }
+
+        void release_storage()
+        {
+            if(!is_inline()) {
+                ::operator delete(elements);
+            }
+
+            elements = get_inline_storage();
+            element_capacity = N;
+        }
+
+        // Moves the elements to new storage. The element at new_count - 1 is constructed
+        // from args before the old storage is released, so args may refer to an element.
+        template <typename... ArgT>
+        void reallocate_and_emplace(size_t new_capacity, ArgT &&... args)
+        {
+            T *new_elements = static_cast<T *>(::operator new(new_capacity * sizeof(T)));
+            new(new_elements + element_count) T(std::forward<ArgT>(args)...);
+
+            for(size_t i = 0; i < element_count; ++i) {
+                new(new_elements + i) T(std::move(elements[i]));
+                elements[i].~T();
+            }
+
+            release_storage();
+            elements = new_elements;
+            element_capacity = new_capacity;
+            ++element_count;
+        }
+
+        void take(small_vector &&other)
+        {
+            if(!other.is_inline()) {
+                elements = other.elements;
+                element_count = other.element_count;
+                element_capacity = other.element_capacity;
+
+                other.elements = other.get_inline_storage();
+                other.element_count = 0;
+                other.element_capacity = N;
+                return;
+            }
+
+            for(auto &em : other) {
+                emplace_back(std::move(em));
+            }
+
+            other.clear();
+        }
+
+    public:
+        small_vector()
+            : elements(get_inline_storage())
+        {
+            return;
+        }
+
+        small_vector(small_vector const &other)
+            : small_vector()
+        {
+            for(auto const &em : other) {
+                push_back(em);
+            }
+        }
+
+        // Moves do not allocate, so that containers of small vectors move them when growing
+        small_vector(small_vector &&other) noexcept(std::is_nothrow_move_constructible<T>::value)
+            : small_vector()
+        {
+            take(std::move(other));
+        }
+
+        ~small_vector()
+        {
+            clear();
+            release_storage();
+        }
+
+        small_vector &operator=(small_vector const &other)
+        {
+            if(this != &other) {
+                clear();
+                for(auto const &em : other) {
+                    push_back(em);
+                }
+            }
+
+            return *this;
+        }
+
+        small_vector &operator=(small_vector &&other)
+            noexcept(std::is_nothrow_move_constructible<T>::value)
+        {
+            if(this != &other) {
+                clear();
+                release_storage();
+                take(std::move(other));
+            }
+
+            return *this;
+        }
+
+        iterator begin()
+        {
+            return elements;
+        }
+
+        iterator end()
+        {
+            return elements + element_count;
+        }
+
+        const_iterator begin() const
+        {
+            return elements;
+        }
+
+        const_iterator end() const
+        {
+            return elements + element_count;
+        }
+
+        reverse_iterator rbegin()
+        {
+            return reverse_iterator(end());
+        }
+
+        reverse_iterator rend()
+        {
+            return reverse_iterator(begin());
+        }
+
+        const_reverse_iterator rbegin() const
+        {
+            return const_reverse_iterator(end());
+        }
+
+        const_reverse_iterator rend() const
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        size_t size() const
+        {
+            return element_count;
+        }
+
+        size_t capacity() const
+        {
+            return element_capacity;
+        }
+
+        bool empty() const
+        {
+            return element_count == 0;
+        }
+
+        T &operator[](size_t index)
+        {
+            return elements[index];
+        }
+
+        T const &operator[](size_t index) const
+        {
+            return elements[index];
+        }
+
+        T &front()
+        {
+            return elements[0];
+        }
+
+        T const &front() const
+        {
+            return elements[0];
+        }
+
+        T &back()
+        {
+            return elements[element_count - 1];
+        }
+
+        T const &back() const
+        {
+            return elements[element_count - 1];
+        }
+
+        template <typename... ArgT>
+        void emplace_back(ArgT &&... args)
+        {
+            if(element_count == element_capacity) {
+                reallocate_and_emplace(element_capacity * 2, std::forward<ArgT>(args)...);
+                return;
+            }
+
+            new(elements + element_count) T(std::forward<ArgT>(args)...);
+            ++element_count;
+        }
+
+        void push_back(T const &v)
+        {
+            emplace_back(v);
+        }
+
+        void push_back(T &&v)
+        {
+            emplace_back(std::move(v));
+        }
+
+        void pop_back()
+        {
+            --element_count;
+            elements[element_count].~T();
+        }
+
+        void clear()
+        {
+            while(element_count > 0) {
+                pop_back();
+            }
+        }
+    };
+}
@@ -1,5 +1,6 @@
 #include "test/test.hpp"
 #include "utility/event_bus.hpp"
+#include "utility/maybe.hpp"
 #include "log/log.hpp"
 
 using namespace gorc;
@@ -15,6 +16,17 @@ public:
     }
 };
 
+class mock_other_event {
+public:
+    int value;
+
+    mock_other_event(int value)
+        : value(value)
+    {
+        return;
+    }
+};
+
 begin_suite(event_bus_test);
 
 test_case(simple)
@@ -232,4 +244,121 @@ test_case(scoped_delegate_overwrite)
     assert_log_empty();
 }
 
+test_case(batch_handler_receives_fired_event)
+{
+    event_bus bus;
+
+    auto handler = bus.add_batch_handler<mock_event>([](span<mock_event const> events) {
+            for(auto const &e : events) {
+                LOG_INFO(format("batch handler: %d of %d") % e.value % events.size());
+            }
+        });
+
+    bus.fire_event(mock_event(5));
+
+    assert_log_message(log_level::info, "batch handler: 5 of 1");
+    assert_log_empty();
+}
+
+test_case(queued_events_dispatched_as_batch)
+{
+    event_bus bus;
+
+    auto batch_handler = bus.add_batch_handler<mock_event>([](span<mock_event const> events) {
+            for(auto const &e : events) {
+                LOG_INFO(format("batch handler: %d of %d") % e.value % events.size());
+            }
+        });
+
+    auto var_handler = bus.add_handler<mock_event>([](mock_event &e) {
+            LOG_INFO(format("var handler: %d") % e.value);
+            e.value *= 2;
+        });
+
+    bus.queue_event(mock_event(1));
+    bus.queue_event(mock_event(2));
+    bus.queue_event(mock_event(3));
+
+    assert_log_empty();
+
+    bus.dispatch_queued_events();
+
+    assert_log_message(log_level::info, "var handler: 1");
+    assert_log_message(log_level::info, "var handler: 2");
+    assert_log_message(log_level::info, "var handler: 3");
+    assert_log_message(log_level::info, "batch handler: 2 of 3");
+    assert_log_message(log_level::info, "batch handler: 4 of 3");
+    assert_log_message(log_level::info, "batch handler: 6 of 3");
+    assert_log_empty();
+
+    bus.dispatch_queued_events();
+    assert_log_empty();
+}
+
+test_case(queued_events_dispatched_in_type_order)
+{
+    event_bus bus;
+
+    auto handler = bus.add_handler<mock_event>([&](auto const &e) {
+            LOG_INFO(format("handler: %d") % e.value);
+            if(e.value == 1) {
+                bus.queue_event(mock_other_event(3));
+                bus.queue_event(mock_event(4));
+                bus.dispatch_queued_events();
+            }
+        });
+
+    auto other_handler = bus.add_handler<mock_other_event>([](auto const &e) {
+            LOG_INFO(format("other handler: %d") % e.value);
+        });
+
+    bus.queue_event(mock_other_event(2));
+    bus.queue_event(mock_event(1));
+    bus.queue_event(mock_other_event(5));
+
+    bus.dispatch_queued_events();
+
+    assert_log_message(log_level::info, "other handler: 2");
+    assert_log_message(log_level::info, "other handler: 5");
+    assert_log_message(log_level::info, "handler: 1");
+    assert_log_message(log_level::info, "other handler: 3");
+    assert_log_message(log_level::info, "handler: 4");
+    assert_log_empty();
+}
+
+test_case(deferred_events_fired_in_order)
+{
+    event_bus bus;
+
+    auto handler = bus.add_handler<mock_event>([](auto const &e) {
+            LOG_INFO(format("handler: %d") % e.value);
+        });
+
+    auto other_handler = bus.add_handler<mock_other_event>([](auto const &e) {
+            LOG_INFO(format("other handler: %d") % e.value);
+        });
+
+    deferred_event_queue queue;
+    {
+        deferred_event_scope scope(queue);
+        bus.fire_event(mock_event(1));
+        bus.queue_event(mock_other_event(2));
+        bus.fire_event(mock_other_event(3));
+    }
+
+    assert_log_empty();
+    assert_eq(queue.size(), size_t(3));
+
+    dispatch_deferred_events(queue);
+    assert_true(queue.empty());
+
+    assert_log_message(log_level::info, "handler: 1");
+    assert_log_message(log_level::info, "other handler: 3");
+    assert_log_empty();
+
+    bus.dispatch_queued_events();
+    assert_log_message(log_level::info, "other handler: 2");
+    assert_log_empty();
+}
+
 end_suite(event_bus_test);
@@ -0,0 +1,88 @@
+#include "test/test.hpp"
+#include "utility/flat_hash_map.hpp"
+#include <map>
+#include <random>
+
+using namespace gorc;
+
+namespace {
+
+    // Sends every key to the same probe sequence
+    struct constant_hash {
+        size_t operator()(int) const
+        {
+            return 0;
+        }
+    };
+}
+
+begin_suite(flat_hash_map_test);
+
+test_case(insert_find_erase)
+{
+    flat_hash_map<int, std::string> m;
+    assert_true(m.empty());
+    assert_true(m.find(5) == m.end());
+
+    m[5] = "five";
+    m[7] = "seven";
+    assert_eq(m.size(), size_t(2));
+    assert_eq(m.find(5)->second, std::string("five"));
+    assert_eq(m[7], std::string("seven"));
+
+    assert_eq(m.erase(5), size_t(1));
+    assert_eq(m.erase(5), size_t(0));
+    assert_true(m.find(5) == m.end());
+    assert_eq(m.size(), size_t(1));
+}
+
+test_case(erase_preserves_collisions)
+{
+    flat_hash_map<int, int, constant_hash> m;
+    for(int i = 0; i < 6; ++i) {
+        m[i] = i * 10;
+    }
+
+    m.erase(0);
+    m.erase(3);
+
+    assert_eq(m.size(), size_t(4));
+    assert_true(m.find(0) == m.end());
+    assert_true(m.find(3) == m.end());
+    assert_eq(m.find(1)->second, 10);
+    assert_eq(m.find(2)->second, 20);
+    assert_eq(m.find(4)->second, 40);
+    assert_eq(m.find(5)->second, 50);
+}
+
+test_case(matches_map)
+{
+    flat_hash_map<int, int> m;
+    std::map<int, int> expected;
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> key_dist(0, 200);
+
+    for(int i = 0; i < 5000; ++i) {
+        int key = key_dist(rng);
+        if(i % 3 == 0) {
+            assert_eq(m.erase(key), expected.erase(key));
+        }
+        else {
+            m[key] = i;
+            expected[key] = i;
+        }
+    }
+
+    assert_eq(m.size(), expected.size());
+
+    size_t visited = 0;
+    for(auto const &em : m) {
+        assert_eq(em.second, expected.at(em.first));
+        ++visited;
+    }
+
+    assert_eq(visited, expected.size());
+}
+
+end_suite(flat_hash_map_test);
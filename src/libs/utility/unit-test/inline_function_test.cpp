@@ -0,0 +1,108 @@
+#include "test/test.hpp"
+#include "utility/inline_function.hpp"
+#include <memory>
+
+using namespace gorc;
+
+namespace {
+
+    class counted_callable {
+    public:
+        int *live;
+
+        explicit counted_callable(int *live)
+            : live(live)
+        {
+            ++*live;
+        }
+
+        counted_callable(counted_callable const &other)
+            : live(other.live)
+        {
+            ++*live;
+        }
+
+        ~counted_callable()
+        {
+            --*live;
+        }
+
+        int operator()(int value) const
+        {
+            return value + 1;
+        }
+    };
+
+}
+
+begin_suite(inline_function_test);
+
+test_case(empty)
+{
+    inline_function<void()> fn;
+    assert_true(!fn);
+}
+
+test_case(inline_callable)
+{
+    int total = 0;
+    inline_function<void(int)> fn([&total](int value) { total += value; });
+    assert_true(static_cast<bool>(fn));
+
+    fn(5);
+    fn(7);
+    assert_eq(total, 12);
+}
+
+test_case(mutable_callable)
+{
+    inline_function<int()> fn([count = 0]() mutable { return ++count; });
+    assert_eq(fn(), 1);
+    assert_eq(fn(), 2);
+}
+
+test_case(heap_callable)
+{
+    char padding[64] = { 3 };
+    inline_function<int(int)> fn([padding](int value) { return value * padding[0]; });
+    assert_eq(fn(5), 15);
+
+    auto moved = std::move(fn);
+    assert_true(!fn);
+    assert_eq(moved(7), 21);
+}
+
+test_case(move_only_callable)
+{
+    auto value = std::make_unique<int>(9);
+    inline_function<int()> fn([value = std::move(value)] { return *value; });
+
+    inline_function<int()> other;
+    other = std::move(fn);
+    assert_true(!fn);
+    assert_eq(other(), 9);
+}
+
+test_case(destroys_callable)
+{
+    int live = 0;
+
+    {
+        inline_function<int(int)> fn { counted_callable(&live) };
+        assert_eq(live, 1);
+        assert_eq(fn(1), 2);
+
+        auto moved = std::move(fn);
+        assert_eq(live, 1);
+
+        moved.reset();
+        assert_eq(live, 0);
+
+        moved = counted_callable(&live);
+        assert_eq(live, 1);
+    }
+
+    assert_eq(live, 0);
+}
+
+end_suite(inline_function_test);
@@ -0,0 +1,105 @@
+#include "test/test.hpp"
+#include "utility/small_vector.hpp"
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace gorc;
+
+begin_suite(small_vector_test);
+
+test_case(inline_storage)
+{
+    small_vector<int, 4> v;
+    assert_true(v.empty());
+    assert_eq(v.capacity(), size_t(4));
+
+    for(int i = 0; i < 4; ++i) {
+        v.push_back(i);
+    }
+
+    assert_eq(v.size(), size_t(4));
+    assert_eq(v.capacity(), size_t(4));
+    assert_eq(v.front(), 0);
+    assert_eq(v.back(), 3);
+
+    v.pop_back();
+    assert_eq(v.back(), 2);
+    assert_eq(v.size(), size_t(3));
+}
+
+test_case(spills_to_heap)
+{
+    small_vector<std::string, 2> v;
+    v.push_back("a");
+    v.push_back("b");
+    v.push_back(v.front());
+
+    assert_eq(v.size(), size_t(3));
+    assert_true(v.capacity() >= size_t(3));
+    assert_eq(v[0], std::string("a"));
+    assert_eq(v[1], std::string("b"));
+    assert_eq(v[2], std::string("a"));
+
+    std::string joined(v.rbegin()->begin(), v.rbegin()->end());
+    for(auto it = v.rbegin() + 1; it != v.rend(); ++it) {
+        joined += *it;
+    }
+
+    assert_eq(joined, std::string("aba"));
+}
+
+test_case(copy_and_move)
+{
+    small_vector<std::unique_ptr<int>, 2> inline_v;
+    inline_v.push_back(std::make_unique<int>(5));
+
+    auto moved_inline = std::move(inline_v);
+    assert_true(inline_v.empty());
+    assert_eq(*moved_inline.back(), 5);
+
+    small_vector<std::unique_ptr<int>, 2> heap_v;
+    for(int i = 0; i < 3; ++i) {
+        heap_v.push_back(std::make_unique<int>(i));
+    }
+
+    small_vector<std::unique_ptr<int>, 2> moved_heap;
+    moved_heap = std::move(heap_v);
+    assert_true(heap_v.empty());
+    assert_eq(moved_heap.size(), size_t(3));
+    assert_eq(*moved_heap[2], 2);
+
+    small_vector<int, 2> original;
+    for(int i = 0; i < 5; ++i) {
+        original.push_back(i);
+    }
+
+    small_vector<int, 2> copy(original);
+    original.clear();
+    assert_eq(copy.size(), size_t(5));
+    assert_eq(copy[4], 4);
+}
+
+test_case(nothrow_move)
+{
+    assert_true((std::is_nothrow_move_constructible<small_vector<int, 4>>::value));
+    assert_true((std::is_nothrow_move_assignable<small_vector<std::string, 4>>::value));
+
+    std::vector<small_vector<std::string, 1>> vv;
+    vv.emplace_back();
+    vv.back().push_back("inline");
+    vv.emplace_back();
+    for(int i = 0; i < 3; ++i) {
+        vv.back().push_back("heap");
+    }
+
+    auto const *heap_data = vv.back().begin();
+
+    // Reallocation moves elements instead of copying them
+    vv.reserve(vv.capacity() + 1);
+    assert_true(vv[1].begin() == heap_data);
+    assert_eq(vv[0][0], std::string("inline"));
+}
+
+end_suite(small_vector_test);
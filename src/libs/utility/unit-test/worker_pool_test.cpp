@@ -0,0 +1,91 @@
+#include "test/test.hpp"
+#include "utility/worker_pool.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace gorc;
+
+begin_suite(worker_pool_test);
+
+test_case(serial_without_workers)
+{
+    worker_pool pool;
+    assert_eq(pool.thread_count(), size_t(1));
+
+    std::vector<size_t> jobs;
+    pool.run(4, [&](size_t job, size_t thread) {
+            assert_eq(thread, size_t(0));
+            jobs.push_back(job);
+        });
+
+    std::vector<size_t> expected { 0, 1, 2, 3 };
+    assert_range_eq(jobs, expected);
+}
+
+test_case(runs_every_job_once)
+{
+    worker_pool pool(3);
+    assert_eq(pool.thread_count(), size_t(4));
+
+    for(int batch = 0; batch < 20; ++batch) {
+        std::vector<std::atomic<int>> runs(100);
+        std::atomic<bool> bad_thread(false);
+
+        pool.run(runs.size(), [&](size_t job, size_t thread) {
+                if(thread >= pool.thread_count()) {
+                    bad_thread = true;
+                }
+
+                ++runs[job];
+            });
+
+        assert_true(!bad_thread);
+        for(auto const &run : runs) {
+            assert_eq(run.load(), 1);
+        }
+    }
+}
+
+test_case(empty_batch)
+{
+    worker_pool pool(2);
+
+    int runs = 0;
+    pool.run(0, [&](size_t, size_t) { ++runs; });
+    assert_eq(runs, 0);
+}
+
+test_case(rethrows_job_error)
+{
+    worker_pool pool(2);
+
+    std::atomic<int> runs(0);
+    assert_throws(pool.run(8, [&](size_t job, size_t) {
+                          ++runs;
+                          if(job == 5) {
+                              throw std::runtime_error("job failed");
+                          }
+                      }),
+                  std::runtime_error,
+                  "job failed");
+
+    assert_eq(runs.load(), 8);
+
+    runs = 0;
+    pool.run(8, [&](size_t, size_t) { ++runs; });
+    assert_eq(runs.load(), 8);
+}
+
+test_case(set_worker_count)
+{
+    worker_pool pool(1);
+    pool.set_worker_count(4);
+    assert_eq(pool.thread_count(), size_t(5));
+
+    std::atomic<int> runs(0);
+    pool.run(16, [&](size_t, size_t) { ++runs; });
+    assert_eq(runs.load(), 16);
+}
+
+end_suite(worker_pool_test);
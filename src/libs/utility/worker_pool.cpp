@@ -0,0 +1,124 @@
+#include "worker_pool.hpp"
+
+gorc::worker_pool::worker_pool(size_t worker_count)
+{
+    start_workers(worker_count);
+}
+
+gorc::worker_pool::~worker_pool()
+{
+    stop_workers();
+}
+
+void gorc::worker_pool::set_worker_count(size_t count)
+{
+    stop_workers();
+    start_workers(count);
+}
+
+size_t gorc::worker_pool::thread_count() const
+{
+    return workers.size() + 1;
+}
+
+void gorc::worker_pool::start_workers(size_t count)
+{
+    for(size_t i = 0; i < count; ++i) {
+        workers.emplace_back([this, i]() { worker_main(i + 1); });
+    }
+}
+
+void gorc::worker_pool::stop_workers()
+{
+    {
+        std::lock_guard<std::mutex> lk(state_lock);
+        stopping = true;
+    }
+
+    state_changed.notify_all();
+    for(auto &worker : workers) {
+        worker.join();
+    }
+
+    workers.clear();
+    stopping = false;
+}
+
+bool gorc::worker_pool::run_next_job(std::unique_lock<std::mutex> &lk, size_t thread)
+{
+    if(next_job >= job_count) {
+        return false;
+    }
+
+    size_t job = next_job++;
+    job_function const &fn = *current_job;
+
+    lk.unlock();
+
+    std::exception_ptr error;
+    try {
+        fn(job, thread);
+    }
+    catch(...) {
+        error = std::current_exception();
+    }
+
+    lk.lock();
+
+    if(error && !job_error) {
+        job_error = error;
+    }
+
+    if(++finished_jobs == job_count) {
+        state_changed.notify_all();
+    }
+
+    return true;
+}
+
+void gorc::worker_pool::run_jobs(size_t count, job_function const &job)
+{
+    if(count == 0) {
+        return;
+    }
+
+    std::exception_ptr error;
+
+    {
+        std::unique_lock<std::mutex> lk(state_lock);
+
+        current_job = &job;
+        job_count = count;
+        next_job = 0;
+        finished_jobs = 0;
+        job_error = nullptr;
+        state_changed.notify_all();
+
+        while(run_next_job(lk, 0)) {
+            continue;
+        }
+
+        while(finished_jobs < job_count) {
+            state_changed.wait(lk);
+        }
+
+        current_job = nullptr;
+        job_count = 0;
+        next_job = 0;
+        error = job_error;
+    }
+
+    if(error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void gorc::worker_pool::worker_main(size_t thread)
+{
+    std::unique_lock<std::mutex> lk(state_lock);
+    while(!stopping) {
+        if(!run_next_job(lk, thread)) {
+            state_changed.wait(lk);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "inline_function.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gorc {
+
+    // Runs batches of numbered jobs on a fixed set of worker threads. The calling thread
+    // also runs jobs, so a pool without workers runs every job serially, in order.
+    class worker_pool {
+    private:
+        using job_function = inline_function<void(size_t, size_t)>;
+
+        std::vector<std::thread> workers;
+
+        std::mutex state_lock;
+        std::condition_variable state_changed;
+        bool stopping = false;
+
+        // State of the running batch
+        job_function const *current_job = nullptr;
+        size_t job_count = 0;
+        size_t next_job = 0;
+        size_t finished_jobs = 0;
+        std::exception_ptr job_error;
+
+        bool run_next_job(std::unique_lock<std::mutex> &lk, size_t thread);
+        void run_jobs(size_t count, job_function const &job);
+        void worker_main(size_t thread);
+
+        void start_workers(size_t count);
+        void stop_workers();
+
+    public:
+        explicit worker_pool(size_t worker_count = 0);
+        ~worker_pool();
+
+        worker_pool(worker_pool const &) = delete;
+        worker_pool& operator=(worker_pool const &) = delete;
+
+        void set_worker_count(size_t count);
+
+        // Number of threads which run jobs, including the calling thread
+        size_t thread_count() const;
+
+        // Calls fn(job, thread) for each job in [0, count), and returns when all jobs have
+        // finished. thread is in [0, thread_count()), and is 0 for the calling thread. The
+        // first exception thrown by a job is rethrown.
+        template <typename FnT>
+        void run(size_t count, FnT fn)
+        {
+            run_jobs(count, job_function([&fn](size_t job, size_t thread) { fn(job, thread); }));
+        }
+    };
+
+}
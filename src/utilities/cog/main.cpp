@@ -1,9 +1,11 @@
 #include "program/program.hpp"
 #include "jk/cog/compiler/compiler.hpp"
+#include "jk/cog/compiler/script_cache.hpp"
 #include "jk/cog/compiler/script_loader.hpp"
 #include "io/native_file.hpp"
 #include "jk/cog/vm/executor.hpp"
 #include "jk/cog/vm/default_verbs.hpp"
+#include "utility/allocation_counter.hpp"
 #include "utility/zip.hpp"
 #include "utility/time.hpp"
 #include "scenario.hpp"
@@ -11,7 +13,7 @@
 #include "content/content_manager.hpp"
 #include "content/loader_registry.hpp"
 #include "value_mapping.hpp"
-#include "io/native_file.hpp"
+#include "text/json_output_stream.hpp"
 #include <vector>
 #include <unordered_map>
 #include <iostream>
@@ -75,8 +77,13 @@ namespace gorc {
         service_registry services;
 
         std::string scenario_file;
+        std::string cog_cache_directory;
+        std::string profile_report_file;
+        std::string profile_folded_file;
         cog::verb_table verbs;
 
+        std::unique_ptr<cog::profiler> profiler;
+
         std::unique_ptr<cog_scenario_state> state;
 
         std::unordered_map<std::string, std::unique_ptr<memory_file>> quicksaves;
@@ -86,6 +93,11 @@ namespace gorc {
         {
             opts.insert(make_value_option("scenario", scenario_file));
             opts.emplace_constraint<required_option>("scenario");
+
+            opts.insert(make_value_option("cog-cache", cog_cache_directory));
+
+            opts.insert(make_value_option("profile-report", profile_report_file));
+            opts.insert(make_value_option("profile-folded", profile_folded_file));
         }
 
         virtual int run() override
@@ -104,6 +116,14 @@ namespace gorc {
             cog::compiler compiler(verbs, constants);
             services.add(compiler);
 
+            std::unique_ptr<cog::script_cache> cog_cache;
+            if(!cog_cache_directory.empty()) {
+                cog_cache = std::make_unique<cog::script_cache>(cog_cache_directory,
+                                                                verbs,
+                                                                constants);
+                services.add(*cog_cache);
+            }
+
             native_file_system vfs;
             services.add<virtual_file_system>(vfs);
 
@@ -116,8 +136,13 @@ namespace gorc {
             cog_scenario_value_mapping val_map(scenario);
             services.add<cog::default_value_mapping>(val_map);
 
+            if(!profile_report_file.empty() || !profile_folded_file.empty()) {
+                profiler = std::make_unique<cog::profiler>(&get_allocation_count);
+            }
+
             // Construct instances:
             state = std::make_unique<cog_scenario_state>(scenario, services);
+            state->executor->set_profiler(profiler.get());
 
             // Execute startup messages:
             state->executor->send_to_all(cog::message_type::startup,
@@ -133,6 +158,17 @@ namespace gorc {
                 event->accept(*this);
             }
 
+            if(!profile_report_file.empty()) {
+                auto f = make_native_file(profile_report_file);
+                json_output_stream jos(*f);
+                json_serialize(jos, *profiler);
+            }
+
+            if(!profile_folded_file.empty()) {
+                auto f = make_native_file(profile_folded_file);
+                profiler->write_folded_stacks(*f);
+            }
+
             return EXIT_SUCCESS;
         }
 
@@ -172,6 +208,7 @@ namespace gorc {
             state = std::make_unique<cog_scenario_state>(deserialization_constructor,
                                                          mr,
                                                          services);
+            state->executor->set_profiler(profiler.get());
             std::cout << "LOAD: " << e.key << std::endl;
         }
 
@@ -0,0 +1,115 @@
+#include "program/program.hpp"
+#include "content/content_manager.hpp"
+#include "content/loader_registry.hpp"
+#include "jk/cog/compiler/compiler.hpp"
+#include "jk/cog/compiler/script_loader.hpp"
+#include "jk/cog/vm/decoded_program.hpp"
+#include "jk/cog/vm/default_verbs.hpp"
+#include "jk/cog/vm/executor.hpp"
+#include "utility/allocation_counter.hpp"
+#include "vfs/native_file_system.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace gorc {
+
+    // Measures the cost of running cog startup messages, with and without the peephole
+    // optimizer.
+    class cog_bench_program : public program {
+    private:
+        std::vector<std::string> cog_files;
+        int iterations = 0;
+
+        service_registry services;
+        cog::verb_table verbs;
+        cog::constant_table constants;
+
+    public:
+        virtual void create_options(options &opts) override
+        {
+            opts.insert_bare(make_bare_multi_value_option(std::back_inserter(cog_files)));
+            opts.insert(make_value_option("iterations", iterations, 1000));
+
+            opts.emplace_constraint<at_least_one_input>();
+            return;
+        }
+
+        virtual int run() override
+        {
+            cog::default_populate_constant_table(constants);
+
+            cog::default_populate_verb_table(verbs);
+            services.add(verbs);
+
+            loader_registry loaders;
+            loaders.emplace_loader<cog::script_loader>();
+            services.add(loaders);
+
+            native_file_system vfs;
+            services.add<virtual_file_system>(vfs);
+
+            bool success = true;
+            for(auto const &cog_file : cog_files) {
+                std::cout << cog_file << std::endl;
+
+                try {
+                    run_benchmark(cog_file, /* optimize */ false);
+                    run_benchmark(cog_file, /* optimize */ true);
+                }
+                catch(logged_runtime_error const &) {
+                    success = false;
+                }
+            }
+
+            return success ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        void run_benchmark(std::string const &cog_file, bool optimize)
+        {
+            service_registry bench_services(&services);
+
+            cog::compiler compiler(verbs, constants, optimize);
+            bench_services.add(compiler);
+
+            content_manager content(bench_services);
+            bench_services.add(content);
+
+            cog::executor exec(bench_services);
+            auto script = content.load<cog::script>(cog_file);
+            exec.create_instance(script);
+
+            // Decoded programs end with a sentinel return, which is not counted
+            cog::decoded_program decoded(*script, verbs);
+            size_t instruction_count = decoded.instructions.size() - 1;
+
+            size_t start_allocations = get_allocation_count();
+            auto start = std::chrono::steady_clock::now();
+            for(int i = 0; i < iterations; ++i) {
+                exec.send_to_all(cog::message_type::startup,
+                                 /* sender: nothing */ 0,
+                                 /* senderid: nothing */ cog::value(),
+                                 /* source: nothing */ 0,
+                                 /* param0 */ cog::value(),
+                                 /* param1 */ cog::value(),
+                                 /* param2 */ cog::value(),
+                                 /* param3 */ cog::value());
+            }
+
+            std::chrono::duration<double, std::micro> elapsed =
+                std::chrono::steady_clock::now() - start;
+            size_t allocations = get_allocation_count() - start_allocations;
+
+            std::cout << "    " << (optimize ? "optimized" : "unoptimized") << ": "
+                      << instruction_count << " instructions, "
+                      << (elapsed.count() / std::max(iterations, 1)) << " us/iteration, "
+                      << (static_cast<double>(allocations) / std::max(iterations, 1))
+                      << " allocations/iteration" << std::endl;
+        }
+    };
+
+}
+
+MAKE_MAIN(gorc::cog_bench_program)
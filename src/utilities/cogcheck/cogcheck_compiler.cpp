@@ -6,8 +6,9 @@ gorc::cogcheck_compiler::cogcheck_compiler(cog::verb_table &verbs,
                                            cog::constant_table &constants,
                                            bool dump_ast,
                                            bool parse_only,
-                                           bool disassemble)
-    : compiler(verbs, constants)
+                                           bool disassemble,
+                                           bool optimize)
+    : compiler(verbs, constants, optimize)
     , dump_ast(dump_ast)
     , parse_only(parse_only)
     , disassemble(disassemble)
@@ -15,7 +15,8 @@ namespace gorc {
                           cog::constant_table &constants,
                           bool dump_ast,
                           bool parse_only,
-                          bool disassemble);
+                          bool disassemble,
+                          bool optimize);
 
         virtual bool handle_parsed_ast(cog::ast::translation_unit &) override;
         virtual bool handle_analyzed_ast(cog::ast::translation_unit &, cog::script &) override;
@@ -163,6 +163,74 @@ void gorc::disassemble_code(cog::script &s, cog::verb_table &verbs)
         case cog::opcode::le:
             line << "le";
             break;
+        case cog::opcode::incr:
+            line << "incr ";
+            line << binary_deserialize<size_t>(r) << " ";
+            line << cog::value(deserialization_constructor, r).as_string();
+            break;
+        case cog::opcode::decr:
+            line << "decr ";
+            line << binary_deserialize<size_t>(r) << " ";
+            line << cog::value(deserialization_constructor, r).as_string();
+            break;
+        case cog::opcode::incrg:
+            line << "incrg ";
+            line << binary_deserialize<size_t>(r) << " ";
+            line << cog::value(deserialization_constructor, r).as_string();
+            break;
+        case cog::opcode::decrg:
+            line << "decrg ";
+            line << binary_deserialize<size_t>(r) << " ";
+            line << cog::value(deserialization_constructor, r).as_string();
+            break;
+        case cog::opcode::bteq:
+            line << "bteq ";
+            printed_address = lazy_add_default_addr(binary_deserialize<size_t>(r));
+            break;
+        case cog::opcode::btne:
+            line << "btne ";
+            printed_address = lazy_add_default_addr(binary_deserialize<size_t>(r));
+            break;
+        case cog::opcode::btgt:
+            line << "btgt ";
+            printed_address = lazy_add_default_addr(binary_deserialize<size_t>(r));
+            break;
+        case cog::opcode::btge:
+            line << "btge ";
+            printed_address = lazy_add_default_addr(binary_deserialize<size_t>(r));
+            break;
+        case cog::opcode::btlt:
+            line << "btlt ";
+            printed_address = lazy_add_default_addr(binary_deserialize<size_t>(r));
+            break;
+        case cog::opcode::btle:
+            line << "btle ";
+            printed_address = lazy_add_default_addr(binary_deserialize<size_t>(r));
+            break;
+        case cog::opcode::bfeq:
+            line << "bfeq ";
+            printed_address = lazy_add_default_addr(binary_deserialize<size_t>(r));
+            break;
+        case cog::opcode::bfne:
+            line << "bfne ";
+            printed_address = lazy_add_default_addr(binary_deserialize<size_t>(r));
+            break;
+        case cog::opcode::bfgt:
+            line << "bfgt ";
+            printed_address = lazy_add_default_addr(binary_deserialize<size_t>(r));
+            break;
+        case cog::opcode::bfge:
+            line << "bfge ";
+            printed_address = lazy_add_default_addr(binary_deserialize<size_t>(r));
+            break;
+        case cog::opcode::bflt:
+            line << "bflt ";
+            printed_address = lazy_add_default_addr(binary_deserialize<size_t>(r));
+            break;
+        case cog::opcode::bfle:
+            line << "bfle ";
+            printed_address = lazy_add_default_addr(binary_deserialize<size_t>(r));
+            break;
         }
 
         lines.emplace(line_addr, std::make_tuple(line.str(), printed_address));
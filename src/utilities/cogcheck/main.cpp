@@ -11,6 +11,7 @@ namespace gorc {
         bool dump_ast = false;
         bool parse_only = false;
         bool disassemble = false;
+        bool no_optimize = false;
 
         cog::verb_table verbs;
 
@@ -21,6 +22,7 @@ namespace gorc {
             opts.insert(make_switch_option("dump-ast", dump_ast));
             opts.insert(make_switch_option("parse-only", parse_only));
             opts.insert(make_switch_option("disassemble", disassemble));
+            opts.insert(make_switch_option("no-optimize", no_optimize));
 
             opts.emplace_constraint<at_least_one_input>();
             return;
@@ -37,7 +39,8 @@ namespace gorc {
                                        constants,
                                        dump_ast,
                                        parse_only,
-                                       disassemble);
+                                       disassemble,
+                                       !no_optimize);
 
             bool success = true;
             for(auto const &cog_file : cog_files) {
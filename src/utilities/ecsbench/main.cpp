@@ -0,0 +1,327 @@
+#include "program/program.hpp"
+#include "content/id.hpp"
+#include "ecs/component_registry.hpp"
+#include "ecs/entity_component_system.hpp"
+#include "io/native_file.hpp"
+#include "io/std_output_stream.hpp"
+#include "text/json_output_stream.hpp"
+#include "utility/event_bus.hpp"
+#include "utility/service_registry.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gorc {
+
+    namespace {
+
+        template <typename StorageT>
+        class bench_component {
+        public:
+            using component_storage = StorageT;
+
+            float value;
+
+            explicit bench_component(int value)
+                : value(static_cast<float>(value))
+            {
+                return;
+            }
+        };
+
+        class paged_position : public bench_component<paged_component_storage> {
+        public:
+            uid(1);
+            using bench_component::bench_component;
+        };
+
+        class dense_position : public bench_component<dense_component_storage> {
+        public:
+            uid(2);
+            using bench_component::bench_component;
+        };
+
+        class unique_position : public bench_component<unique_component_storage> {
+        public:
+            uid(3);
+            using bench_component::bench_component;
+        };
+
+        class velocity : public bench_component<paged_component_storage> {
+        public:
+            uid(4);
+            using bench_component::bench_component;
+        };
+
+        class health : public bench_component<paged_component_storage> {
+        public:
+            uid(5);
+            using bench_component::bench_component;
+        };
+
+        class armor : public bench_component<paged_component_storage> {
+        public:
+            uid(6);
+            using bench_component::bench_component;
+        };
+
+        using elapsed_time = std::chrono::duration<double, std::micro>;
+
+        template <typename FnT>
+        elapsed_time time_block(FnT fn)
+        {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            return std::chrono::steady_clock::now() - start;
+        }
+
+        // Keeps iteration results alive
+        volatile float sink = 0.0f;
+
+        class bench_result {
+        public:
+            std::string name;
+            std::string storage;
+            int entities;
+            int iterations;
+            double mean_us;
+            double min_us;
+
+            void json_serialize_object(json_output_stream &f) const
+            {
+                json_serialize_members(f, [&] {
+                        json_serialize_member(f, "name", [&] { json_serialize(f, name); });
+                        json_serialize_member(f, "storage", [&] { json_serialize(f, storage); });
+                        json_serialize_member(f, "entities", [&] { json_serialize(f, entities); });
+                        json_serialize_member(f, "iterations",
+                                              [&] { json_serialize(f, iterations); });
+                        json_serialize_member(f, "mean_us", [&] { json_serialize(f, mean_us); });
+                        json_serialize_member(f, "min_us", [&] { json_serialize(f, min_us); });
+                    });
+            }
+        };
+
+    }
+
+    // Measures entity component system operations at several entity counts. Results are
+    // written as JSON, so that runs on different commits can be compared.
+    class ecs_bench_program : public program {
+    private:
+        std::string output_file;
+        int iterations = 0;
+        int max_entities = 0;
+
+        service_registry services;
+        event_bus bus;
+        component_registry<thing_id> components;
+
+        std::vector<bench_result> results;
+
+        using ecs_type = entity_component_system<thing_id>;
+
+    public:
+        virtual void create_options(options &opts) override
+        {
+            opts.insert(make_value_option("output", output_file));
+            opts.insert(make_value_option("iterations", iterations, 10));
+            opts.insert(make_value_option("max-entities", max_entities, 100000));
+            return;
+        }
+
+        virtual int run() override
+        {
+            components.register_component_type<paged_position>();
+            components.register_component_type<dense_position>();
+            components.register_component_type<unique_position>();
+            components.register_component_type<velocity>();
+            components.register_component_type<health>();
+            components.register_component_type<armor>();
+
+            services.add(bus);
+            services.add(components);
+
+            for(int entities = 1000; entities <= max_entities; entities *= 10) {
+                run_benchmarks(entities);
+            }
+
+            if(output_file.empty()) {
+                std_output_stream os;
+                write_results(os);
+            }
+            else {
+                auto os = make_native_file(output_file);
+                write_results(*os);
+            }
+
+            return EXIT_SUCCESS;
+        }
+
+        void write_results(output_stream &os)
+        {
+            json_output_stream jos(os);
+            json_serialize_members(jos, [&] {
+                    json_serialize_member(jos, "benchmarks",
+                                          [&] { json_serialize_array(jos, results); });
+                });
+        }
+
+        template <typename FnT>
+        void measure(std::string const &name,
+                     std::string const &storage,
+                     int entities,
+                     FnT fn)
+        {
+            double total = 0.0;
+            double min = 0.0;
+            for(int i = 0; i < iterations; ++i) {
+                double elapsed = fn().count();
+                total += elapsed;
+                min = (i == 0) ? elapsed : std::min(min, elapsed);
+            }
+
+            results.push_back(bench_result { name,
+                                             storage,
+                                             entities,
+                                             iterations,
+                                             total / std::max(iterations, 1),
+                                             min });
+        }
+
+        void populate(ecs_type &ecs, int entities)
+        {
+            for(int i = 0; i < entities; ++i) {
+                auto tid = ecs.emplace_entity();
+                ecs.emplace_component<paged_position>(tid, i);
+                ecs.emplace_component<dense_position>(tid, i);
+                ecs.emplace_component<unique_position>(tid, i);
+                ecs.emplace_component<velocity>(tid, i);
+                ecs.emplace_component<health>(tid, i);
+                if(i % 2 == 0) {
+                    ecs.emplace_component<armor>(tid, i);
+                }
+            }
+        }
+
+        void run_benchmarks(int entities)
+        {
+            ecs_type ecs(services);
+            populate(ecs, entities);
+
+            run_storage_benchmarks<paged_position>(ecs, "paged", entities);
+            run_storage_benchmarks<dense_position>(ecs, "dense", entities);
+            run_storage_benchmarks<unique_position>(ecs, "unique", entities);
+
+            run_join_benchmarks(ecs, entities);
+            run_snapshot_benchmarks(ecs, entities);
+        }
+
+        template <typename CompT>
+        void run_storage_benchmarks(ecs_type &ecs, std::string const &storage, int entities)
+        {
+            measure("emplace_erase", storage, entities, [&] {
+                    ecs_type churn_ecs(services);
+                    return time_block([&] {
+                            std::vector<thing_id> ids;
+                            ids.reserve(entities);
+                            for(int i = 0; i < entities; ++i) {
+                                ids.push_back(churn_ecs.emplace_entity());
+                                churn_ecs.emplace_component<CompT>(ids.back(), i);
+                            }
+
+                            for(auto const &tid : ids) {
+                                churn_ecs.erase_entity(tid);
+                            }
+
+                            churn_ecs.update(time_delta(0.0));
+                        });
+                });
+
+            measure("iterate", storage, entities, [&] {
+                    return time_block([&] {
+                            float sum = 0.0f;
+                            for(auto const &comp : ecs.all_components<CompT>()) {
+                                sum += comp.second->value;
+                            }
+
+                            sink = sum;
+                        });
+                });
+
+            measure("equal_range", storage, entities, [&] {
+                    return time_block([&] {
+                            float sum = 0.0f;
+                            for(int i = 0; i < entities; ++i) {
+                                for(auto const &comp : ecs.find_component<CompT>(thing_id(i))) {
+                                    sum += comp.second->value;
+                                }
+                            }
+
+                            sink = sum;
+                        });
+                });
+
+            // Erases every other component, and restores them after timing the flush
+            measure("flush_erase_queue", storage, entities, [&] {
+                    for(int i = 0; i < entities; i += 2) {
+                        ecs.erase_components<CompT>(thing_id(i));
+                    }
+
+                    auto elapsed = time_block([&] { ecs.update(time_delta(0.0)); });
+
+                    for(int i = 0; i < entities; i += 2) {
+                        ecs.emplace_component<CompT>(thing_id(i), i);
+                    }
+
+                    return elapsed;
+                });
+        }
+
+        template <typename ...CompT>
+        void run_join_benchmark(ecs_type &ecs, std::string const &name, int entities)
+        {
+            auto &view = ecs.get_join_view<CompT...>();
+            view.size();
+
+            measure(name, "paged", entities, [&] {
+                    return time_block([&] {
+                            float sum = 0.0f;
+                            view.for_each([&](thing_id, CompT &...comps) {
+                                    float values[] = { comps.value... };
+                                    for(float value : values) {
+                                        sum += value;
+                                    }
+                                });
+
+                            sink = sum;
+                        });
+                });
+        }
+
+        void run_join_benchmarks(ecs_type &ecs, int entities)
+        {
+            run_join_benchmark<paged_position, velocity>(ecs, "inner_join_2", entities);
+            run_join_benchmark<paged_position, velocity, health>(ecs, "inner_join_3", entities);
+            run_join_benchmark<paged_position, velocity, health, armor>(ecs,
+                                                                         "inner_join_4",
+                                                                         entities);
+        }
+
+        void run_snapshot_benchmarks(ecs_type &ecs, int entities)
+        {
+            measure("take_snapshot", "mixed", entities, [&] {
+                    return time_block([&] { ecs.take_snapshot(); });
+                });
+
+            auto snapshot = ecs.take_snapshot();
+            measure("restore_snapshot", "mixed", entities, [&] {
+                    return time_block([&] { ecs.restore_snapshot(snapshot); });
+                });
+        }
+    };
+
+}
+
+MAKE_MAIN(gorc::ecs_bench_program)